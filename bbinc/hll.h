@@ -0,0 +1,57 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_HLL_H
+#define INCLUDED_HLL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* HyperLogLog distinct-value estimator.  Memory is 2^precision bytes;
+   standard error is about 1.04 / sqrt(2^precision). */
+struct hll;
+struct hll *hll_new(int precision);
+void hll_add(struct hll *h, uint64_t hash);
+uint64_t hll_count(const struct hll *h);
+void hll_merge(struct hll *dst, const struct hll *src);
+void hll_free(struct hll *h);
+
+/* Incremental 64-bit hash (FNV-1a with a final avalanche) so that every
+   prefix of a key can be hashed in one pass over its bytes. */
+#define HLL_HASH_INIT 0xcbf29ce484222325ULL
+
+static inline uint64_t hll_hash_update(uint64_t h, const void *buf,
+                                       size_t len)
+{
+    const uint8_t *p = buf;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static inline uint64_t hll_hash_final(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+#endif
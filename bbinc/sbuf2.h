@@ -152,6 +152,10 @@ int SBUF2_FUNC(sbuf2fread_timeout)(char *ptr, int size, int nitems, SBUF2 *sb,
                                    int *was_timeout);
 #define sbuf2fread_timeout SBUF2_FUNC(sbuf2fread_timeout)
 
+/* returns number of bytes that can be read without touching the socket */
+int SBUF2_FUNC(sbuf2pending)(SBUF2 *sb);
+#define sbuf2pending SBUF2_FUNC(sbuf2pending)
+
 /* return last line read*/
 char *SBUF2_FUNC(sbuf2dbgin)(SBUF2 *sb);
 #define sbuf2dbgin SBUF2_FUNC(sbuf2dbgin)
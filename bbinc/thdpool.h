@@ -72,6 +72,13 @@ typedef void (*thdpool_thdinit_fn)(struct thdpool *pool, void *thddata);
 typedef void (*thdpool_thddelt_fn)(struct thdpool *pool, void *thddata);
 typedef void (*thdpool_thddque_fn)(struct thdpool *pool, struct workitem *item,
                                    int timeout);
+/* Return a non-zero key describing work, or 0 if no thread suits it better
+ * than another.  Called before the pool lock is taken. */
+typedef unsigned (*thdpool_affinity_key_fn)(struct thdpool *pool, void *work);
+/* Return non-zero if the idle thread owning thddata is a good fit for work
+ * with this key.  Called with the pool lock held, so it must be cheap. */
+typedef int (*thdpool_affinity_fn)(struct thdpool *pool, unsigned key,
+                                   void *thddata);
 
 typedef void (*thdpool_foreach_fn)(struct thdpool *pool, struct workitem *item,
                                    void *user);
@@ -145,6 +152,9 @@ void thdpool_command_to_all(char *line, int lline, int st);
 void thdpool_set_dump_on_full(struct thdpool *pool, int onoff);
 /* TODO: maybe thdpool_set_event_callback, to call for various life cycle events? */
 void thdpool_set_queued_callback(struct thdpool *pool, void(*callback)(void*));
+void thdpool_set_affinity_fn(struct thdpool *pool,
+                             thdpool_affinity_key_fn affinity_key_fn,
+                             thdpool_affinity_fn affinity_fn);
 
 int thdpool_lock(struct thdpool *pool);
 int thdpool_unlock(struct thdpool *pool);
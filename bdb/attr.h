@@ -148,6 +148,12 @@ DEF_ATTR(
     ZLIBLEVEL, zlib_level, QUANTITY, 6,
     "If zlib compression is enabled, this determines the compression level.")
 DEF_ATTR(ZTRACE, ztrace, BOOLEAN, 0, NULL)
+DEF_ATTR(COMPR_DICT_SIZE, compr_dict_size, BYTES, 32768,
+         "Size of the dictionaries trained for lz4dict record compression "
+         "(at most 64KB).")
+DEF_ATTR(COMPR_DICT_SAMPLES, compr_dict_samples, QUANTITY, 2000,
+         "Number of records sampled from a table to train an lz4dict "
+         "dictionary.")
 DEF_ATTR(PANICLOGSNAP, paniclogsnap, BOOLEAN, 1, NULL)
 DEF_ATTR(UPDATEGENIDS, updategenids, BOOLEAN, 0, NULL)
 DEF_ATTR(ROUND_ROBIN_STRIPES, round_robin_stripes, BOOLEAN, 0,
@@ -249,6 +255,9 @@ DEF_ATTR(TEMPTABLE_MEM_THRESHOLD, temptable_mem_threshold, QUANTITY, 512,
 DEF_ATTR(TEMPTABLE_CACHESZ, temptable_cachesz, BYTES, 262144,
          "Cache size for temporary tables. Temp tables do not share the "
          "database's main buffer pool.")
+DEF_ATTR(TEMPARRAY_LAZY_SORT, temparray_lazy_sort, BOOLEAN, 1,
+         "Append out-of-order inserts to in-memory temp arrays and sort them "
+         "on first read, instead of keeping them sorted on every insert.")
 DEF_ATTR(PARTICIPANTID_BITS, participantid_bits, QUANTITY, 0,
          "Number of bits allocated for the participant stripe ID (remaining "
          "bits are used for the update ID).")
@@ -446,6 +455,12 @@ DEF_ATTR(AA_MIN_PERCENT, aa_min_percent, QUANTITY, 20,
          "Percent change above which we kick off analyze.")
 DEF_ATTR(AA_MIN_PERCENT_JITTER, aa_min_percent_jitter, QUANTITY, 300,
          "Additional jitter factor for determining percent change.")
+DEF_ATTR(AA_INCREMENTAL, aa_incremental, BOOLEAN, 0,
+         "Only re-analyze the indexes whose keys changed since the last "
+         "analyze.")
+DEF_ATTR(AA_INCREMENTAL_MIN_PERCENT, aa_incremental_min_percent, PERCENT, 10,
+         "With aa_incremental, an index is re-analyzed once its key changes "
+         "reach this percent of the table's counted operations.")
 DEF_ATTR(PLANNER_SHOW_SCANSTATS, planner_show_scanstats, BOOLEAN, 0, NULL)
 DEF_ATTR(PLANNER_WARN_ON_DISCREPANCY, planner_warn_on_discrepancy, BOOLEAN, 0,
          NULL)
@@ -526,6 +541,9 @@ DEF_ATTR(RCACHE_COUNT, rcache_count, QUANTITY, 257,
          "Number of entries in root page cache.")
 DEF_ATTR(RCACHE_PGSZ, rcache_pgsz, BYTES, 4096,
          "Size of pages in root page cache.")
+DEF_ATTR(RCACHE_LEVELS, rcache_levels, QUANTITY, 2,
+         "Number of B-tree levels, counting the root, kept in the root page "
+         "cache.")
 DEF_ATTR(DEADLK_PRIORITY_BUMP_ON_FSTBLK, deadlk_priority_bump_on_fstblk,
          QUANTITY, 5, NULL)
 DEF_ATTR(FSTBLK_MINQ, fstblk_minq, QUANTITY, 262144, NULL)
@@ -600,6 +618,9 @@ DEF_ATTR(ASOF_THREAD_POLL_INTERVAL_MS, asof_thread_poll_interval_ms, MSECS, 500,
 DEF_ATTR(ASOF_THREAD_DRAIN_LIMIT, asof_thread_drain_limit, QUANTITY, 0,
          "How many entries at maximum should the BEGIN TRANSACTION AS OF "
          "thread drain per run.")
+DEF_ATTR(ASOF_LOGREC_CACHE_BYTES, asof_logrec_cache_bytes, BYTES, 16777216,
+         "Size of the cache of undo log records replayed by snapshot and "
+         "BEGIN TRANSACTION AS OF cursors.  0 disables the cache.")
 DEF_ATTR(REP_VERIFY_MAX_TIME, rep_verify_max_time, SECS, 300,
          "Maximum amount of time we allow a replicant to roll back its logs in "
          "an attempt to sync up to the master.")
@@ -678,6 +699,13 @@ DEF_ATTR(TEST_IO_TIME, test_io_time, SECS, 10,
          "Check I/O in watchdog this often")
 DEF_ATTR(DELETE_OLD_FILE_DEBUG, delete_old_file_debug, BOOLEAN, 0,
          "Spew debug info about deleting old files.")
+DEF_ATTR(SQL_BATCH_SCAN, sql_batch_scan, BOOLEAN, 1,
+         "Hand out rows of sequential table scans in batches instead of "
+         "stepping the cursor one row at a time.")
+DEF_ATTR(SQL_BATCH_SCAN_ROWS, sql_batch_scan_rows, QUANTITY, 64,
+         "Maximum number of rows buffered per batch (see sql_batch_scan).")
+DEF_ATTR(SQL_BATCH_SCAN_THRESHOLD, sql_batch_scan_threshold, QUANTITY, 16,
+         "Start batching after this many nexts on a table cursor.")
 
 /*
   BDB_ATTR_REPTIMEOUT
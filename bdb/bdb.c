@@ -49,6 +49,10 @@
 
 extern void berkdb_dumptrans(DB_ENV *);
 extern int __db_panic(DB_ENV *dbenv, int err);
+extern int __memp_pgtrack_rotate(u_int64_t *epochp, u_int64_t *ackedp);
+extern int __memp_pgtrack_ack(u_int64_t epoch);
+extern int __memp_pgtrack_pages(const char *name, db_pgno_t **pgnosp,
+                                u_int32_t *npgnosp);
 
 pthread_key_t bdb_key;
 pthread_key_t lock_key;
@@ -948,6 +952,27 @@ int bdb_recovery_start_lsn(bdb_state_type *bdb_state, char *lsnout, int lsnlen)
     return 0;
 }
 
+int bdb_pgtrack_rotate(unsigned long long *epoch, unsigned long long *acked)
+{
+    u_int64_t e, a;
+    int rc;
+    if ((rc = __memp_pgtrack_rotate(&e, &a)) != 0)
+        return rc;
+    *epoch = e;
+    *acked = a;
+    return 0;
+}
+
+int bdb_pgtrack_ack(unsigned long long epoch)
+{
+    return __memp_pgtrack_ack(epoch);
+}
+
+int bdb_pgtrack_pages(const char *file, unsigned **pgnos, unsigned *npgnos)
+{
+    return __memp_pgtrack_pages(file, (db_pgno_t **)pgnos, npgnos);
+}
+
 int bdb_panic(bdb_state_type *bdb_state)
 {
     __db_panic(bdb_state->dbenv, EINVAL);
@@ -297,9 +297,13 @@ enum COMPRESS {
     BDB_COMPRESS_ZLIB = 1,
     BDB_COMPRESS_RLE8 = 2,
     BDB_COMPRESS_CRLE = 3,
-    BDB_COMPRESS_LZ4 = 4
+    BDB_COMPRESS_LZ4 = 4,
+    BDB_COMPRESS_LZ4DICT = 5 /* lz4 with a trained per-table dictionary */
 };
 
+/* dictionary versions are stored in 2 bytes of each compressed record */
+enum { BDB_COMPR_DICT_MAX_VERSION = 0xffff };
+
 enum OPENFLAGS { /* NOTE: For "uint32_t flags" arg to "bdb_open_*()". */
     BDB_OPEN_NONE = 0x0,
     BDB_OPEN_ADD_QDB_FILE = 0x1000000,
@@ -1160,6 +1164,48 @@ void bdb_set_queue_odh_options(bdb_state_type *bdb_state, int odh,
 void bdb_get_compr_flags(bdb_state_type *bdb_state, int *odh, int *compr,
                          int *blob_compr);
 
+/* Sample records from the table and store a new lz4dict dictionary version in
+ * llmeta.  The dictionary is not used until bdb_load_compr_dicts() is called
+ * after the transaction commits. */
+int bdb_train_compr_dict(bdb_state_type *bdb_state, tran_type *tran,
+                         int *version, int *bdberr);
+/* Sample records from "from" and park the dictionary as the table's pending
+ * one; "to" (the schema change's new handle) uses it right away.  Finalize
+ * makes it a version with bdb_commit_compr_dict_pending(). */
+int bdb_train_compr_dict_pending(bdb_state_type *from, bdb_state_type *to,
+                                 int *version, int *bdberr);
+/* Make every dictionary version stored in llmeta available to the handle.
+ * Records are only ever unpacked against dictionaries loaded here. */
+int bdb_load_compr_dicts(bdb_state_type *bdb_state, tran_type *tran);
+/* Also make the pending dictionary available (resumed schema change). */
+int bdb_load_compr_dict_pending(bdb_state_type *bdb_state, tran_type *tran);
+/* Compress a record with the current dictionary.  Returns the compressed
+ * size, or 0 if there is no dictionary or no gain. */
+int bdb_lz4dict_compress(bdb_state_type *bdb_state, const void *src, int len,
+                         void *dst);
+/* Current dictionary version and size, or 0 if none is loaded. */
+int bdb_get_compr_dict_info(bdb_state_type *bdb_state, int *len);
+void bdb_cleanup_compr_dicts(bdb_state_type *bdb_state);
+
+int bdb_get_compr_dict_versions(tran_type *tran, const char *table,
+                                int **versions, int *num);
+int bdb_get_compr_dict(tran_type *tran, const char *table, int version,
+                       void **dict, int *len);
+int bdb_add_compr_dict(tran_type *tran, const char *table, const void *dict,
+                       int len, int *version);
+int bdb_next_compr_dict_version(tran_type *tran, const char *table,
+                                int *version);
+int bdb_set_compr_dict_pending(tran_type *tran, const char *table, int version,
+                               const void *dict, int len);
+int bdb_get_compr_dict_pending(tran_type *tran, const char *table,
+                               int *version, void **dict, int *len);
+int bdb_del_compr_dict_pending(tran_type *tran, const char *table);
+int bdb_commit_compr_dict_pending(tran_type *tran, const char *table,
+                                  int *version);
+int bdb_del_compr_dicts(tran_type *tran, const char *table);
+int bdb_rename_compr_dicts(tran_type *tran, const char *oldname,
+                           const char *newname);
+
 /* delete a table from disk.  must already be closed but NOT freed */
 int bdb_del(bdb_state_type *bdb_state, tran_type *tran, int *bdberr);
 int bdb_del_temp(bdb_state_type *bdb_state, tran_type *tran, int *bdberr);
@@ -1705,6 +1751,17 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
                         sampler_t **samplerp, unsigned long long *outrecs,
                         unsigned long long *cmprecs, int *bdberr);
 
+/* Single pass over the index file: comp_pct of the leaf pages (at most
+   max_bytes) are reservoir-sampled into memory rather than a temptable, and
+   ndistinct[i] is a HyperLogLog estimate of the distinct values of the first
+   prefixlen[i] bytes over every key.  cmprecs is the exact live key count. */
+int bdb_summarize_table_streaming(bdb_state_type *bdb_state, int ixnum,
+                                  int comp_pct, size_t max_bytes, int nprefix,
+                                  const int *prefixlen, uint64_t *ndistinct,
+                                  sampler_t **samplerp,
+                                  unsigned long long *outrecs,
+                                  unsigned long long *cmprecs, int *bdberr);
+
 void bdb_bdblock_debug(void);
 int bdb_env_init_after_llmeta(bdb_state_type *bdb_state);
 
@@ -1982,6 +2039,13 @@ void bdb_set_key_compression(bdb_state_type *);
 void bdb_print_compression_flags(bdb_state_type *);
 
 int bdb_recovery_start_lsn(bdb_state_type *bdb_state, char *lsnout, int lsnlen);
+
+/* Changed-page tracking for incremental backups: start an epoch, list the
+ * pages of a file written since the acknowledged one (ENOENT if unknown),
+ * and acknowledge an epoch once its backup is complete. */
+int bdb_pgtrack_rotate(unsigned long long *epoch, unsigned long long *acked);
+int bdb_pgtrack_pages(const char *file, unsigned **pgnos, unsigned *npgnos);
+int bdb_pgtrack_ack(unsigned long long epoch);
 /* We carefully pretend above bdb level that we don't know what an LSN looks
  * like.
  * Maintain the charade just a bit longer +---------V. */
@@ -53,6 +53,31 @@ enum { BDB_SET, BDB_NEXT, BDB_PREV };
 struct bdb_cursor_impl_tag;
 typedef struct bdb_cursor_impl_tag bdb_cursor_impl_t;
 
+/**
+ * Row batch for sequential data scans.  The storage is owned by the caller
+ * and handed to the cursor with set_batch; once the cursor is positioned,
+ * "next" fills it with copies of the following rows of the current stripe
+ * and returns them one at a time, bypassing the merge logic.
+ *
+ */
+typedef struct bdb_cursor_batch_row {
+    unsigned long long genid;
+    void *data; /* points inside the batch arena */
+    int datalen;
+    uint8_t ver;
+} bdb_cursor_batch_row_t;
+
+typedef struct bdb_cursor_batch {
+    bdb_cursor_batch_row_t *rows;
+    int maxrows;
+    char *arena; /* row payloads */
+    int arenasz;
+
+    /* maintained by the cursor */
+    int nrows; /* rows buffered, 0 if none */
+    int next;  /* next row to return */
+} bdb_cursor_batch_t;
+
 typedef struct bdb_cursor_ifn {
     bdb_cursor_impl_t *impl;
 
@@ -127,6 +152,10 @@ typedef struct bdb_cursor_ifn {
     /* Count arg */
     void *countarg;
 
+    /* batched sequential scan */
+    void (*set_batch)(struct bdb_cursor_ifn *cur, bdb_cursor_batch_t *batch);
+    int (*batched)(struct bdb_cursor_ifn *cur);
+
 } bdb_cursor_ifn_t;
 
 /**
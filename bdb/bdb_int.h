@@ -639,6 +639,8 @@ struct bdb_cursor_impl_tag {
 
     struct pglogs_queue_cursor *queue_cursor;
 
+    bdb_cursor_batch_t *batch; /* caller supplied row batch, if any */
+
     uint8_t ver;
     uint8_t trak;    /* debug this cursor: set to 1 for verbose */
     uint8_t used_rl; /* set to 1 if rl position was consumed */
@@ -1044,6 +1046,7 @@ struct bdb_state_tag {
 
     pthread_mutex_t durable_lsn_lk;
     uint16_t *fld_hints;
+    struct compr_dict *compr_dicts; /* lz4dict dictionaries, newest first */
 
     int logical_live_sc;
     pthread_mutex_t sc_redo_lk;
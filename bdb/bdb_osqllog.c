@@ -3038,6 +3038,117 @@ int bdb_osql_set_null_blob_in_shadows(bdb_cursor_impl_t *cur,
     return rc;
 }
 
+/**
+ * Cache of undo log records replayed into shadows by snapshot/as-of cursors.
+ * Concurrent readers of the same hot pages replay the same lsns; this lets
+ * them share one log read.  Bounded by asof_logrec_cache_bytes, LRU evicted.
+ *
+ */
+struct logrec_cache_ent {
+    DB_LSN lsn;
+    u_int32_t size;
+    LINKC_T(struct logrec_cache_ent) lnk;
+    uint8_t data[1];
+};
+
+static hash_t *logrec_cache;
+static LISTC_T(struct logrec_cache_ent) logrec_lru;
+static size_t logrec_cache_bytes;
+static unsigned logrec_cache_gen;
+static pthread_mutex_t logrec_cache_lk = PTHREAD_MUTEX_INITIALIZER;
+
+static void logrec_cache_evict(struct logrec_cache_ent *ent)
+{
+    hash_del(logrec_cache, ent);
+    listc_rfl(&logrec_lru, ent);
+    logrec_cache_bytes -= ent->size;
+    free(ent);
+}
+
+/* copy a cached record into logdta; returns 0 on hit */
+static int logrec_cache_find(DB_LSN *lsn, DBT *logdta, unsigned *gen)
+{
+    struct logrec_cache_ent *ent;
+    void *data;
+
+    Pthread_mutex_lock(&logrec_cache_lk);
+    *gen = logrec_cache_gen;
+    if (logrec_cache == NULL ||
+        (ent = hash_find(logrec_cache, lsn)) == NULL) {
+        Pthread_mutex_unlock(&logrec_cache_lk);
+        return -1;
+    }
+    if ((data = realloc(logdta->data, ent->size)) == NULL) {
+        Pthread_mutex_unlock(&logrec_cache_lk);
+        return -1;
+    }
+    memcpy(data, ent->data, ent->size);
+    logdta->data = data;
+    logdta->size = ent->size;
+    listc_rfl(&logrec_lru, ent);
+    listc_abl(&logrec_lru, ent);
+    Pthread_mutex_unlock(&logrec_cache_lk);
+    return 0;
+}
+
+static void logrec_cache_add(bdb_state_type *bdb_state, DB_LSN *lsn,
+                             DBT *logdta, unsigned gen)
+{
+    size_t max = bdb_state->attr->asof_logrec_cache_bytes;
+    struct logrec_cache_ent *ent;
+
+    if (logdta->size > max / 16)
+        return;
+
+    Pthread_mutex_lock(&logrec_cache_lk);
+    /* a truncation since we read the log may have made this record stale */
+    if (gen != logrec_cache_gen)
+        goto done;
+    if (logrec_cache == NULL) {
+        logrec_cache = hash_init_o(offsetof(struct logrec_cache_ent, lsn),
+                                   sizeof(DB_LSN));
+        if (logrec_cache == NULL)
+            goto done;
+        listc_init(&logrec_lru, offsetof(struct logrec_cache_ent, lnk));
+    }
+    if (hash_find(logrec_cache, lsn))
+        goto done;
+    while (logrec_cache_bytes + logdta->size > max && logrec_lru.top)
+        logrec_cache_evict(logrec_lru.top);
+    ent = malloc(offsetof(struct logrec_cache_ent, data) + logdta->size);
+    if (ent == NULL)
+        goto done;
+    ent->lsn = *lsn;
+    ent->size = logdta->size;
+    memcpy(ent->data, logdta->data, logdta->size);
+    hash_add(logrec_cache, ent);
+    listc_abl(&logrec_lru, ent);
+    logrec_cache_bytes += ent->size;
+done:
+    Pthread_mutex_unlock(&logrec_cache_lk);
+}
+
+static int logrec_cache_truncate_int(void *obj, void *arg)
+{
+    struct logrec_cache_ent *ent = obj;
+    if (log_compare(&ent->lsn, (DB_LSN *)arg) >= 0)
+        logrec_cache_evict(ent);
+    return 0;
+}
+
+/**
+ * Drop cached log records at or past a truncation point
+ *
+ */
+void bdb_osql_logrec_cache_truncate(DB_LSN lsn)
+{
+    Pthread_mutex_lock(&logrec_cache_lk);
+    logrec_cache_gen++;
+    if (logrec_cache)
+        hash_for(logrec_cache, logrec_cache_truncate_int, &lsn);
+    Pthread_mutex_unlock(&logrec_cache_lk);
+}
+
 #ifdef NEWSI_STAT
 extern struct timeval log_read_time;
 extern struct timeval log_read_time2;
@@ -3058,6 +3169,8 @@ int bdb_osql_update_shadows_with_pglogs(bdb_cursor_impl_t *cur, DB_LSN lsn,
 
     void *free_ptr = NULL;
     int skip = 0;
+    int use_cache = bdb_state->attr->asof_logrec_cache_bytes > 0;
+    unsigned gen = 0;
 
     bdb_osql_log_rec_t *rec = NULL;
 
@@ -3096,11 +3209,15 @@ int bdb_osql_update_shadows_with_pglogs(bdb_cursor_impl_t *cur, DB_LSN lsn,
     }
 
     /* get log */
-    rc = logcur->get(logcur, &lsn, &logdta, DB_SET);
-    if (rc) {
-        logmsg(LOGMSG_ERROR, "%s:%d %s log_cur->get(%u:%u) rc %d\n", __FILE__,
-                __LINE__, __func__, lsn.file, lsn.offset, rc);
-        goto done;
+    if (!use_cache || logrec_cache_find(&lsn, &logdta, &gen) != 0) {
+        rc = logcur->get(logcur, &lsn, &logdta, DB_SET);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d %s log_cur->get(%u:%u) rc %d\n",
+                   __FILE__, __LINE__, __func__, lsn.file, lsn.offset, rc);
+            goto done;
+        }
+        if (use_cache)
+            logrec_cache_add(bdb_state, &lsn, &logdta, gen);
     }
     LOGCOPY_32(&rectype, logdta.data);
 #ifdef NEWSI_STAT
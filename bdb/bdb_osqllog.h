@@ -222,6 +222,12 @@ int bdb_osql_update_shadows_with_pglogs(bdb_cursor_impl_t *cur, DB_LSN lsn,
                                         struct bdb_osql_trn *trn, int *dirty,
                                         int trak, int *bdberr);
 
+/**
+ * Drop cached log records at or past a truncation point
+ *
+ */
+void bdb_osql_logrec_cache_truncate(DB_LSN lsn);
+
 /**
  * Sync-ed return of last log from log_repo
  *
@@ -137,6 +137,18 @@ static unsigned last_logfile;
 static int logfile_pglogs_repo_ready = 0;
 static pthread_mutex_t logfile_pglogs_repo_mutex;
 
+/* Version index over logfile_pglogs_repo: for each page, the ascending list
+ * of logfiles whose pglogs or relinks mention it.  As-of reads probe only
+ * those logfiles instead of every one still retained. */
+struct page_logfiles {
+    PAGE_KEY
+    int nfiles;
+    int alloc;
+    unsigned *files;
+};
+static hash_t *page_logfiles_hash;
+static pthread_mutex_t page_logfiles_lk = PTHREAD_MUTEX_INITIALIZER;
+
 #ifdef NEWSI_STAT
 struct timeval logfile_relink_time;
 struct timeval logfile_pglog_time;
@@ -256,6 +268,11 @@ static int bdb_cursor_move_and_skip_int(bdb_cursor_impl_t *cur,
                                         bdb_berkdb_t *berkdb, int how,
                                         int retrieved, int update_shadows,
                                         int *bdberr);
+static void bdb_cursor_set_batch(bdb_cursor_ifn_t *pcur_ifn,
+                                 bdb_cursor_batch_t *batch);
+static int bdb_cursor_batched(bdb_cursor_ifn_t *pcur_ifn);
+static int bdb_cursor_batch_next(bdb_cursor_impl_t *cur, int *bdberr);
+static void bdb_cursor_batch_drop(bdb_cursor_impl_t *cur);
 
 static inline int berkdb_get_genid_from_dtakey(bdb_cursor_impl_t *cur,
                                                void *dta, void *key,
@@ -694,6 +711,8 @@ bdb_cursor_ifn_t *bdb_cursor_open(
     pcur_ifn->pausearg = pausearg;
     pcur_ifn->count = count_cursors;
     pcur_ifn->countarg = countarg;
+    pcur_ifn->set_batch = bdb_cursor_set_batch;
+    pcur_ifn->batched = bdb_cursor_batched;
 
     pcur_ifn->close = bdb_cursor_close;
 
@@ -1778,6 +1797,108 @@ static int logfile_relink_tmptbl_cmp(void *_, int key1len, const void *key1,
     return 0;
 }
 
+static void page_logfiles_add(unsigned char *fileid, db_pgno_t pgno,
+                              unsigned filenum)
+{
+    struct page_logfiles key, *p;
+    int i;
+
+    memcpy(key.fileid, fileid, DB_FILE_ID_LEN);
+    key.pgno = pgno;
+
+    Pthread_mutex_lock(&page_logfiles_lk);
+    if ((p = hash_find(page_logfiles_hash, &key)) == NULL) {
+        p = calloc(1, sizeof(struct page_logfiles));
+        if (!p) {
+            logmsg(LOGMSG_FATAL, "%s: fail malloc page_logfiles\n", __func__);
+            abort();
+        }
+        memcpy(p->fileid, fileid, DB_FILE_ID_LEN);
+        p->pgno = pgno;
+        hash_add(page_logfiles_hash, p);
+    }
+    /* records arrive in (nearly) lsn order, so this is almost always an
+     * append or a duplicate of the last file */
+    for (i = p->nfiles; i > 0 && p->files[i - 1] > filenum; i--)
+        ;
+    if (i > 0 && p->files[i - 1] == filenum)
+        goto done;
+    if (p->nfiles == p->alloc) {
+        p->alloc = p->alloc ? p->alloc * 2 : 4;
+        p->files = realloc(p->files, p->alloc * sizeof(unsigned));
+        if (!p->files) {
+            logmsg(LOGMSG_FATAL, "%s: fail realloc files\n", __func__);
+            abort();
+        }
+    }
+    memmove(&p->files[i + 1], &p->files[i], (p->nfiles - i) * sizeof(unsigned));
+    p->files[i] = filenum;
+    p->nfiles++;
+done:
+    Pthread_mutex_unlock(&page_logfiles_lk);
+}
+
+/* Returns the logfiles in [first, last] mentioning a page, newest first, in
+ * a malloc'd array. */
+static unsigned *page_logfiles_get(unsigned char *fileid, db_pgno_t pgno,
+                                   unsigned first, unsigned last, int *nfiles)
+{
+    struct page_logfiles key, *p;
+    unsigned *files = NULL;
+    int i, n = 0;
+
+    memcpy(key.fileid, fileid, DB_FILE_ID_LEN);
+    key.pgno = pgno;
+
+    Pthread_mutex_lock(&page_logfiles_lk);
+    if ((p = hash_find(page_logfiles_hash, &key)) != NULL && p->nfiles) {
+        if ((files = malloc(p->nfiles * sizeof(unsigned))) == NULL) {
+            logmsg(LOGMSG_FATAL, "%s: fail malloc files\n", __func__);
+            abort();
+        }
+        for (i = p->nfiles - 1; i >= 0; i--) {
+            if (p->files[i] >= first && p->files[i] <= last)
+                files[n++] = p->files[i];
+        }
+    }
+    Pthread_mutex_unlock(&page_logfiles_lk);
+    *nfiles = n;
+    return files;
+}
+
+struct page_logfiles_prune {
+    unsigned first; /* drop files below this */
+    unsigned only;  /* or just this one, if set */
+};
+
+static int page_logfiles_prune_int(void *obj, void *arg)
+{
+    struct page_logfiles *p = obj;
+    struct page_logfiles_prune *prune = arg;
+    int i, n = 0;
+
+    for (i = 0; i < p->nfiles; i++) {
+        if (prune->only ? p->files[i] == prune->only
+                        : p->files[i] < prune->first)
+            continue;
+        p->files[n++] = p->files[i];
+    }
+    if ((p->nfiles = n) == 0) {
+        hash_del(page_logfiles_hash, p);
+        free(p->files);
+        free(p);
+    }
+    return 0;
+}
+
+static void page_logfiles_prune(unsigned first, unsigned only)
+{
+    struct page_logfiles_prune prune = {.first = first, .only = only};
+    Pthread_mutex_lock(&page_logfiles_lk);
+    hash_for(page_logfiles_hash, page_logfiles_prune_int, &prune);
+    Pthread_mutex_unlock(&page_logfiles_lk);
+}
+
 // Must be called holding the logfile_pglogs_repo_mutex
 static struct logfile_pglogs_entry *
 retrieve_logfile_pglogs(bdb_state_type *bdb_state, unsigned int filenum,
@@ -1898,6 +2019,8 @@ int bdb_delete_logfile_pglogs(bdb_state_type *bdb_state, int filenum, int flags)
     }
     first_logfile = (flags ? first_logfile : (filenum + 1));
     Pthread_mutex_unlock(&logfile_pglogs_repo_mutex);
+    if (rtn == 0)
+        page_logfiles_prune(filenum + 1, flags ? filenum : 0);
     return rtn;
 }
 
@@ -2008,6 +2131,7 @@ int truncate_asof_pglogs(bdb_state_type *bdb_state, int file, int offset)
     struct commit_list *lcommit;
     int del_log = file + 1;
     extern int gbl_snapisol;
+    bdb_osql_logrec_cache_truncate(lsn);
     if (!gbl_new_snapisol || !gbl_snapisol || !logfile_pglogs_repo_ready)
         return 0;
     bdb_clean_pglogs_queues(bdb_state, lsn, 1);
@@ -2410,6 +2534,14 @@ int bdb_gbl_pglogs_init(bdb_state_type *bdb_state)
         Pthread_mutex_init(&logfile_pglogs_repo_mutex, NULL);
         first_logfile = last_logfile = 0;
 
+        page_logfiles_hash = hash_init_o(
+            offsetof(struct page_logfiles, fileid), PAGE_KEY_SIZE);
+        if (!page_logfiles_hash) {
+            logmsg(LOGMSG_ERROR, "%s: failed to init page_logfiles_hash\n",
+                   __func__);
+            return ENOMEM;
+        }
+
         if (gbl_newsi_use_timestamp_table) {
             bdb_gbl_timestamp_lsn = bdb_temp_table_create(bdb_state, &bdberr);
             if (bdb_gbl_timestamp_lsn == NULL) {
@@ -2660,6 +2792,8 @@ static int bdb_insert_logfile_pglog_int(bdb_state_type *bdb_state,
     if (rc) {
         logmsg(LOGMSG_ERROR, "%s:%d failed with rc=%d, bdberr=%d\n", __func__,
                __LINE__, rc, bdberr);
+    } else {
+        page_logfiles_add(fileid, pgno, l_entry->filenum);
     }
 
     return rc;
@@ -2768,6 +2902,7 @@ static int bdb_insert_logfile_relink_int(bdb_state_type *bdb_state,
                    __func__, __LINE__, rc, bdberr);
             return rc;
         }
+        page_logfiles_add(fileid, prev_pgno, l_entry->filenum);
     }
     if (next_pgno) {
         rec.pgno = next_pgno;
@@ -2779,6 +2914,7 @@ static int bdb_insert_logfile_relink_int(bdb_state_type *bdb_state,
                    __func__, __LINE__, rc, bdberr);
             return rc;
         }
+        page_logfiles_add(fileid, next_pgno, l_entry->filenum);
     }
     return 0;
 }
@@ -3891,6 +4027,8 @@ static int bdb_cursor_first(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc;
 
+    bdb_cursor_batch_drop(cur);
+
     rc = bdb_cursor_move(cur, DB_FIRST, bdberr);
 
     return rc;
@@ -3901,6 +4039,8 @@ static int bdb_cursor_last(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc;
 
+    bdb_cursor_batch_drop(cur);
+
     rc = bdb_cursor_move(cur, DB_LAST, bdberr);
 
     return rc;
@@ -3911,6 +4051,12 @@ static int bdb_cursor_next(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc;
 
+    if (cur->batch) {
+        rc = bdb_cursor_batch_next(cur, bdberr);
+        if (rc != IX_NOTFND)
+            return rc;
+    }
+
     rc = bdb_cursor_move(cur, DB_NEXT, bdberr);
 
     /* must stand on the last row */
@@ -3950,6 +4096,8 @@ static int bdb_cursor_prev(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
 /* The YAST test does an 'order by rowid desc' */
 /* assert(cur->type != BDBC_DT); */
 
+    bdb_cursor_batch_drop(cur);
+
     rc = bdb_cursor_move(cur, DB_PREV, bdberr);
 
     /* must stand on the last row */
@@ -4007,6 +4155,8 @@ static int bdb_cursor_find_last_dup(bdb_cursor_ifn_t *pcur_ifn, void *key,
 
     *bdberr = 0;
 
+    bdb_cursor_batch_drop(cur);
+
     if (cur->trak) {
         logmsg(LOGMSG_USER, "Cur %p %s find_last_dup len=%d data[8]=%llx\n", cur,
                 (cur->type == BDBC_DT) ? "data" : "index", keylen,
@@ -6405,6 +6555,8 @@ static int bdb_cursor_find(bdb_cursor_ifn_t *pcur_ifn, void *key, int keylen,
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc, cnt = 0, max = cur->state->attr->max_rowlocks_reposition;
 
+    bdb_cursor_batch_drop(cur);
+
 again:
     rc = bdb_cursor_find_int(pcur_ifn, key, keylen, dirLeft, bdberr);
     if (-1 == rc && BDBERR_NEED_REPOSITION == *bdberr) {
@@ -6592,6 +6744,141 @@ static int serial_update_lastkey(bdb_cursor_impl_t *cur, char *key, int keylen)
     return 0;
 }
 
+/**
+ * A positioned data cursor with nothing to merge or skip can buffer the
+ * following rows of its stripe in the caller supplied batch; the berkdb
+ * cursor stays on the last buffered row, so the regular path picks up
+ * right after it once the batch runs dry.
+ *
+ */
+static inline int bdb_cursor_can_batch(bdb_cursor_impl_t *cur)
+{
+    return cur->type == BDBC_DT && cur->rl && !cur->sd && !cur->addcur &&
+           (!cur->shadow_tran || is_tran_sosql(cur)) && !cur->pageorder &&
+           !cur->rowlocks && !cur->trak && !cur->invalidated && cur->data &&
+           cur->used_rl && !cur->rl->outoforder_get(cur->rl);
+}
+
+static int bdb_cursor_batch_fill(bdb_cursor_impl_t *cur, int *bdberr)
+{
+    bdb_cursor_batch_t *batch = cur->batch;
+    bdb_cursor_batch_row_t *row;
+    bdb_berkdb_t *rl = cur->rl;
+    char *dta, *key;
+    int dtasize, keysize;
+    int used = 0;
+    uint8_t ver;
+    int rc;
+
+    batch->nrows = batch->next = 0;
+
+    while (batch->nrows < batch->maxrows) {
+        rc = rl->move(rl, DB_NEXT, bdberr);
+        if (rc == IX_FND)
+            rc = rl->get_everything(rl, &dta, &dtasize, &key, &keysize, &ver,
+                                    bdberr);
+        if (rc < 0) {
+            /* the current row is preserved; reposition on retry */
+            batch->nrows = 0;
+            rl->outoforder_set(rl, 1);
+            return rc;
+        }
+        if (rc != IX_FND || keysize != sizeof(row->genid) ||
+            dtasize > batch->arenasz - used) {
+            /* berkdb is not standing on the last buffered row anymore */
+            rl->outoforder_set(rl, 1);
+            break;
+        }
+
+        row = &batch->rows[batch->nrows++];
+        berkdb_get_genid_from_dtakey(cur, dta, key, &row->genid, bdberr);
+        row->data = batch->arena + used;
+        row->datalen = dtasize;
+        row->ver = ver;
+        memcpy(row->data, dta, dtasize);
+        used += (dtasize + 7) & ~7;
+    }
+
+    return 0;
+}
+
+/**
+ * Return the next buffered row, refilling the batch if possible.
+ * Returns IX_NOTFND if the caller has to take the regular path.
+ *
+ */
+static int bdb_cursor_batch_next(bdb_cursor_impl_t *cur, int *bdberr)
+{
+    bdb_cursor_batch_t *batch = cur->batch;
+    bdb_cursor_batch_row_t *row;
+    int rc;
+
+    if (batch->nrows == 0) {
+        if (!bdb_cursor_can_batch(cur))
+            return IX_NOTFND;
+        rc = bdb_cursor_batch_fill(cur, bdberr);
+        if (rc)
+            return rc;
+        if (batch->nrows == 0)
+            return IX_NOTFND;
+    }
+
+    row = &batch->rows[batch->next++];
+
+    rc = serial_update_lastkey(cur, (char *)&row->genid, sizeof(row->genid));
+    if (rc) {
+        *bdberr = BDBERR_MALLOC;
+        return rc;
+    }
+
+    cur->nsteps++;
+    cur->rrn = 2;
+    cur->used_rl = 1;
+    cur->genid = row->genid;
+    cur->data = row->data;
+    cur->datalen = row->datalen;
+    cur->ver = row->ver;
+    cur->laststripe = cur->idx;
+    cur->collattr = NULL;
+    cur->collattr_len = 0;
+
+    if (batch->next == batch->nrows)
+        batch->nrows = batch->next = 0;
+
+    return IX_FND;
+}
+
+static void bdb_cursor_batch_drop(bdb_cursor_impl_t *cur)
+{
+    if (!cur->batch || cur->batch->nrows == 0)
+        return;
+
+    cur->batch->nrows = cur->batch->next = 0;
+
+    /* berkdb is ahead of the current row */
+    if (cur->rl)
+        cur->rl->outoforder_set(cur->rl, 1);
+}
+
+static void bdb_cursor_set_batch(bdb_cursor_ifn_t *pcur_ifn,
+                                 bdb_cursor_batch_t *batch)
+{
+    bdb_cursor_impl_t *cur = pcur_ifn->impl;
+
+    bdb_cursor_batch_drop(cur);
+
+    cur->batch = batch;
+    if (batch)
+        batch->nrows = batch->next = 0;
+}
+
+static int bdb_cursor_batched(bdb_cursor_ifn_t *pcur_ifn)
+{
+    bdb_cursor_impl_t *cur = pcur_ifn->impl;
+
+    return cur->batch && cur->batch->nrows > 0;
+}
+
 static int bdb_btree_merge(bdb_cursor_impl_t *cur, int stripe_rl, int page_rl,
                            int index_rl, char *pdata_rl, int pdatalen_rl,
                            char *pdata_sd, int pdatalen_sd, char *key_rl,
@@ -7103,6 +7390,8 @@ static int bdb_cursor_unlock(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
     if (cur->invalidated)
         return 0;
 
+    bdb_cursor_batch_drop(cur);
+
     if (cur->rl) {
         cur->invalidated = 1;
         if (cur->trak) {
@@ -7355,6 +7644,8 @@ static int bdb_copy_logfile_pglogs_to_shadow_tran(bdb_state_type *bdb_state,
     struct relink_list *add_rlent = NULL;
     struct relink_list *add_before_rlent = NULL;
     unsigned filenum, first_filenum;
+    unsigned *files;
+    int i, nfiles;
 
     unsigned char *fileid;
     db_pgno_t pgno;
@@ -7389,8 +7680,11 @@ static int bdb_copy_logfile_pglogs_to_shadow_tran(bdb_state_type *bdb_state,
     buf = NULL;
 #endif
 
-    for (; filenum && filenum >= first_filenum; --filenum) {
+    /* only visit the logfiles which touched this page, newest first */
+    files = page_logfiles_get(fileid, pgno, first_filenum, filenum, &nfiles);
+    for (i = 0; i < nfiles; ++i) {
         struct logfile_pglogs_entry *l_entry;
+        filenum = files[i];
         Pthread_mutex_lock(&logfile_pglogs_repo_mutex);
         l_entry = retrieve_logfile_pglogs(bdb_state, filenum, 0);
 
@@ -7577,6 +7871,7 @@ static int bdb_copy_logfile_pglogs_to_shadow_tran(bdb_state_type *bdb_state,
         }
         Pthread_mutex_unlock(&l_entry->relinks_lk);
     }
+    free(files);
 
 #ifdef NEWSI_STAT
     gettimeofday(&after, NULL);
@@ -7111,6 +7111,7 @@ static int bdb_free_int(bdb_state_type *bdb_state, bdb_state_type *replace,
         free(child->txndir);
         free(child->tmpdir);
         free(child->fld_hints);
+        bdb_cleanup_compr_dicts(child);
         // free bthash
         bdb_handle_dbp_drop_hash(child);
         memset(child, 0xff, sizeof(bdb_state_type));
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <inttypes.h>
 
 #include <segstr.h>
 
@@ -189,6 +190,18 @@ static void log_stats(FILE *out, bdb_state_type *bdb_state)
         prn_stat(st_inline_writes);
     }
 
+    prn_stat(st_group_waits);
+    for (int i = 0; i < DB_LOG_GROUP_HIST; i++) {
+        if (stats->st_group_size[i])
+            logmsgf(LOGMSG_USER, out, "st_group_size[>=%d]: %u\n", 1 << i,
+                    stats->st_group_size[i]);
+    }
+    for (int i = 0; i < DB_LOG_GROUP_HIST; i++) {
+        if (stats->st_group_usec[i])
+            logmsgf(LOGMSG_USER, out, "st_group_usec[<%d]: %u\n", 512 << i,
+                    stats->st_group_usec[i]);
+    }
+
     free(stats);
 }
 
@@ -291,6 +304,9 @@ static void lock_stats(FILE *out, bdb_state_type *bdb_state)
     extern unsigned long long check_waiters_skip_count;
     extern unsigned long long check_waiters_commit_count;
     extern unsigned long long gbl_rowlocks_deadlock_retries;
+    extern uint64_t detect_run, detect_skip, detect_usecs, detect_max_usecs;
+    extern uint64_t detect_local_run, detect_local_clear;
+    extern uint64_t detect_victim_killme, detect_victim_keeper;
     DB_LOCK_STAT *stats = NULL;
 
     rc = bdb_state->dbenv->lock_stat(bdb_state->dbenv, &stats, 0);
@@ -340,6 +356,20 @@ static void lock_stats(FILE *out, bdb_state_type *bdb_state)
     logmsgf(LOGMSG_USER, out, "waiter_commits: %llu\n", check_waiters_commit_count);
     logmsgf(LOGMSG_USER, out, "rowlocks_deadlock_retries: %llu\n",
             gbl_rowlocks_deadlock_retries);
+    logmsgf(LOGMSG_USER, out, "deadlock_detect_runs: %" PRIu64 "\n", detect_run);
+    logmsgf(LOGMSG_USER, out, "deadlock_detect_skips: %" PRIu64 "\n", detect_skip);
+    logmsgf(LOGMSG_USER, out, "deadlock_detect_avg_usecs: %" PRIu64 "\n",
+            detect_run ? detect_usecs / detect_run : 0);
+    logmsgf(LOGMSG_USER, out, "deadlock_detect_max_usecs: %" PRIu64 "\n",
+            detect_max_usecs);
+    logmsgf(LOGMSG_USER, out, "deadlock_detect_local_runs: %" PRIu64 "\n",
+            detect_local_run);
+    logmsgf(LOGMSG_USER, out, "deadlock_detect_local_clears: %" PRIu64 "\n",
+            detect_local_clear);
+    logmsgf(LOGMSG_USER, out, "deadlock_victims_killme: %" PRIu64 "\n",
+            detect_victim_killme);
+    logmsgf(LOGMSG_USER, out, "deadlock_victims_keeper: %" PRIu64 "\n",
+            detect_victim_keeper);
     prn_lstat(st_regsize);
 
     free(stats);
@@ -351,7 +381,7 @@ static void rep_stats(FILE *out, bdb_state_type *bdb_state)
     char str[80];
     extern int64_t gbl_rep_trans_parallel, gbl_rep_trans_serial,
         gbl_rep_trans_deadlocked, gbl_rep_trans_inline,
-        gbl_rep_rowlocks_multifile;
+        gbl_rep_rowlocks_multifile, gbl_rep_trans_by_page;
 
     bdb_state->dbenv->rep_stat(bdb_state->dbenv, &stats, 0);
 
@@ -407,6 +437,8 @@ static void rep_stats(FILE *out, bdb_state_type *bdb_state)
             gbl_rep_trans_inline);
     logmsgf(LOGMSG_USER, out, "txn multifile rowlocks: %" PRId64 "\n",
             gbl_rep_rowlocks_multifile);
+    logmsgf(LOGMSG_USER, out, "txn by page: %" PRId64 "\n",
+            gbl_rep_trans_by_page);
     logmsgf(LOGMSG_USER, out, "txn deadlocked: %" PRId64 "\n",
             gbl_rep_trans_deadlocked);
     prn_lstat(lc_cache_hits);
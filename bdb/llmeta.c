@@ -171,7 +171,8 @@ typedef enum {
     LLMETA_TABLE_TO_AUDITS = 54,
     LLMETA_AUDIT_TO_TABLE = 55,
     LLMETA_TRIGGER_TO_AUDIT = 56,
-    LLMETA_AUDIT_TO_TRIGGER = 57
+    LLMETA_AUDIT_TO_TRIGGER = 57,
+    LLMETA_COMPR_DICT = 58 /* 58 + TABLENAME[32] + VERSION[4] */
 } llmetakey_t;
 
 struct llmeta_file_type_key {
@@ -187,6 +188,16 @@ BB_COMPILE_TIME_ASSERT(llmeta_file_type_key,
 BB_COMPILE_TIME_ASSERT(llmeta_file_type_key_overflow,
                        sizeof(struct llmeta_file_type_key) <= LLMETA_IXLEN);
 
+struct compr_dict_key {
+    int32_t key; // LLMETA_COMPR_DICT
+    char tablename[LLMETA_TBLLEN + 1];
+    uint8_t padding[3];
+    int32_t version; // network order so that versions sort
+};
+
+BB_COMPILE_TIME_ASSERT(compr_dict_key_overflow,
+                       sizeof(struct compr_dict_key) <= LLMETA_IXLEN);
+
 static int kv_get(tran_type *t, void *k, size_t klen, void ***ret, int *num,
                   int *bdberr);
 static int kv_put(tran_type *tran, void *k, void *v, size_t vlen, int *bdberr);
@@ -6780,6 +6791,12 @@ int bdb_llmeta_print_record(bdb_state_type *bdb_state, void *key, int keylen,
                    "LLMETA_TABLE_PARAMETERS table=\"%s\" value=\"%s\"\n",
                    tblname, (char *)data);
         } break;
+        case LLMETA_COMPR_DICT: {
+            struct compr_dict_key *k = key;
+            logmsg(LOGMSG_USER,
+                   "LLMETA_COMPR_DICT table=\"%s\" version=%d size=%d\n",
+                   k->tablename, ntohl(k->version), datalen);
+        } break;
         default:
             logmsg(LOGMSG_USER, "Todo (type=%d)\n", type);
             break;
@@ -10165,6 +10182,238 @@ int bdb_rename_files(bdb_state_type *bdb_state, tran_type *tran,
     return rc;
 }
 
+/*
+** Trained record compression dictionaries (BDB_COMPRESS_LZ4DICT)
+** Schema:
+**   key: table name + version
+** value: dictionary bytes
+** Versions are never reused so that records compressed with an older
+** dictionary stay readable.  Version 0 holds the dictionary trained by a
+** running schema change, prefixed with the version it will be committed as;
+** it is not a version until finalize moves it, in the schema change's
+** transaction.
+*/
+static void compr_dict_key_init(struct compr_dict_key *k, const char *table,
+                                int version)
+{
+    memset(k, 0, sizeof(*k));
+    k->key = htonl(LLMETA_COMPR_DICT);
+    strncpy0(k->tablename, table, sizeof(k->tablename));
+    k->version = htonl(version);
+}
+
+int bdb_get_compr_dict_versions(tran_type *tran, const char *table,
+                                int **versions, int *num)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    void **keys = NULL;
+    int rc, bdberr, n = 0;
+
+    *versions = NULL;
+    *num = 0;
+    compr_dict_key_init(&u.k, table, 0);
+    rc = kv_get_keys(tran, &u, offsetof(struct compr_dict_key, version), &keys,
+                     &n, &bdberr);
+    if (rc == 0 && n > 0) {
+        *versions = malloc(sizeof(int) * n);
+        for (int i = 0; i < n; ++i) {
+            int version = ntohl(((struct compr_dict_key *)keys[i])->version);
+            if (version != 0) /* pending */
+                (*versions)[(*num)++] = version;
+        }
+    }
+    for (int i = 0; i < n; ++i)
+        free(keys[i]);
+    free(keys);
+    return rc;
+}
+
+/* returns 1 if the version does not exist */
+int bdb_get_compr_dict(tran_type *tran, const char *table, int version,
+                       void **dict, int *len)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    int rc, bdberr;
+
+    *dict = NULL;
+    *len = 0;
+    compr_dict_key_init(&u.k, table, version);
+    rc = bdb_lite_exact_var_fetch_tran(llmeta_bdb_state, tran, &u, dict, len,
+                                       &bdberr);
+    if (rc && bdberr == BDBERR_FETCH_DTA)
+        return 1;
+    return rc;
+}
+
+/* the version the next dictionary of this table will be stored under */
+int bdb_next_compr_dict_version(tran_type *tran, const char *table,
+                                int *version)
+{
+    int *versions, num, rc;
+
+    if ((rc = bdb_get_compr_dict_versions(tran, table, &versions, &num)) != 0)
+        return rc;
+    *version = num ? versions[num - 1] + 1 : 1;
+    free(versions);
+    if (*version > BDB_COMPR_DICT_MAX_VERSION) {
+        logmsg(LOGMSG_ERROR, "%s: table %s is out of dictionary versions\n",
+               __func__, table);
+        return -1;
+    }
+    return 0;
+}
+
+/* store a dictionary under the next unused version */
+int bdb_add_compr_dict(tran_type *tran, const char *table, const void *dict,
+                       int len, int *version)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    int rc, bdberr;
+
+    if ((rc = bdb_next_compr_dict_version(tran, table, version)) != 0)
+        return rc;
+    compr_dict_key_init(&u.k, table, *version);
+    if ((rc = kv_put(tran, &u, (void *)dict, len, &bdberr)) == 0) {
+        logmsg(LOGMSG_INFO, "Added compression dictionary %s:%d (%d bytes)\n",
+               table, *version, len);
+    }
+    return rc;
+}
+
+/* park a dictionary trained by a schema change until it commits */
+int bdb_set_compr_dict_pending(tran_type *tran, const char *table, int version,
+                               const void *dict, int len)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    char *val;
+    int rc, bdberr;
+
+    if ((val = malloc(sizeof(int32_t) + len)) == NULL)
+        return ENOMEM;
+    *(int32_t *)val = htonl(version);
+    memcpy(val + sizeof(int32_t), dict, len);
+    compr_dict_key_init(&u.k, table, 0);
+    rc = kv_put(tran, &u, val, sizeof(int32_t) + len, &bdberr);
+    free(val);
+    return rc;
+}
+
+/* returns 1 if no dictionary is pending */
+int bdb_get_compr_dict_pending(tran_type *tran, const char *table,
+                               int *version, void **dict, int *len)
+{
+    char *val;
+    int rc;
+
+    *version = 0;
+    if ((rc = bdb_get_compr_dict(tran, table, 0, (void **)&val, len)) != 0)
+        return rc;
+    if (*len < (int)sizeof(int32_t)) {
+        free(val);
+        return -1;
+    }
+    *version = ntohl(*(int32_t *)val);
+    *len -= sizeof(int32_t);
+    memmove(val, val + sizeof(int32_t), *len);
+    *dict = val;
+    return 0;
+}
+
+int bdb_del_compr_dict_pending(tran_type *tran, const char *table)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    int rc, bdberr;
+
+    compr_dict_key_init(&u.k, table, 0);
+    rc = kv_del(tran, &u, &bdberr);
+    if (rc && bdberr == BDBERR_DEL_DTA)
+        return 0;
+    return rc;
+}
+
+/* make the pending dictionary, if any, a version of the table */
+int bdb_commit_compr_dict_pending(tran_type *tran, const char *table,
+                                  int *version)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    void *dict;
+    int len, rc, bdberr;
+
+    if ((rc = bdb_get_compr_dict_pending(tran, table, version, &dict, &len)))
+        return rc == 1 ? 0 : rc;
+    compr_dict_key_init(&u.k, table, *version);
+    if ((rc = kv_put(tran, &u, dict, len, &bdberr)) == 0)
+        rc = bdb_del_compr_dict_pending(tran, table);
+    free(dict);
+    return rc;
+}
+
+int bdb_del_compr_dicts(tran_type *tran, const char *table)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    int *versions, num, rc, bdberr;
+
+    if ((rc = bdb_get_compr_dict_versions(tran, table, &versions, &num)) != 0)
+        return rc;
+    for (int i = 0; i < num && rc == 0; ++i) {
+        compr_dict_key_init(&u.k, table, versions[i]);
+        rc = kv_del(tran, &u, &bdberr);
+    }
+    free(versions);
+    if (rc == 0)
+        rc = bdb_del_compr_dict_pending(tran, table);
+    return rc;
+}
+
+/* move all dictionary versions of table "oldname" to "newname" */
+int bdb_rename_compr_dicts(tran_type *tran, const char *oldname,
+                           const char *newname)
+{
+    union {
+        struct compr_dict_key k;
+        uint8_t buf[LLMETA_IXLEN];
+    } u;
+    int *versions, num, rc, bdberr;
+
+    if ((rc = bdb_get_compr_dict_versions(tran, oldname, &versions, &num)))
+        return rc;
+    for (int i = 0; i < num && rc == 0; ++i) {
+        void *dict;
+        int len;
+        if ((rc = bdb_get_compr_dict(tran, oldname, versions[i], &dict, &len)))
+            break;
+        compr_dict_key_init(&u.k, newname, versions[i]);
+        if ((rc = kv_put(tran, &u, dict, len, &bdberr)) == 0) {
+            compr_dict_key_init(&u.k, oldname, versions[i]);
+            rc = kv_del(tran, &u, &bdberr);
+        }
+        free(dict);
+    }
+    free(versions);
+    return rc;
+}
+
 /* rename csonparameters for table "oldname" */
 int bdb_rename_table_csonparameters(void *tran, const char *oldname,
                                     const char *newname)
@@ -10215,6 +10464,11 @@ int bdb_rename_table_metadata(bdb_state_type *bdb_state, tran_type *tran,
     if (rc)
         return rc;
 
+    /* rename trained compression dictionaries */
+    rc = bdb_rename_compr_dicts(tran, bdb_state->name, newname);
+    if (rc)
+        return rc;
+
     /* rename files finally, with new versions */
     rc = bdb_rename_files(bdb_state, tran, newname, bdberr);
     if (rc)
@@ -36,6 +36,7 @@
 #include <string.h>
 #include <strings.h>
 #include <fsnapf.h>
+#include <flibc.h>
 
 #include "bdb_int.h"
 #include <locks.h>
@@ -47,6 +48,7 @@
 
 #include <lz4.h>
 #include <logmsg.h>
+#include <memory_sync.h>
 
 #if LZ4_VERSION_NUMBER < 10701
 #define LZ4_compress_default LZ4_compress_limitedOutput
@@ -151,6 +153,8 @@ const char *bdb_algo2compr(int alg)
         return "crle";
     case BDB_COMPRESS_LZ4:
         return "lz4 ";
+    case BDB_COMPRESS_LZ4DICT:
+        return "lz4dict";
     default:
         return "????";
     }
@@ -164,6 +168,8 @@ int bdb_compr2algo(const char *a)
         return BDB_COMPRESS_RLE8;
     if (strcasecmp(a, "crle") == 0)
         return BDB_COMPRESS_CRLE;
+    if (strcasecmp(a, "lz4dict") == 0)
+        return BDB_COMPRESS_LZ4DICT;
     if (strncasecmp(a, "lz4", 3) == 0)
         return BDB_COMPRESS_LZ4;
     if (strncasecmp(a, "none", 4) == 0)
@@ -267,12 +273,227 @@ void init_odh(bdb_state_type *bdb_state, struct odh *odh, void *rec,
     odh->flags = 0;
     odh->recptr = rec;
     if (is_blob) {
-        odh->flags |= (bdb_state->compress_blobs & ODH_FLAG_COMPR_MASK);
+        /* dictionaries are trained on records, not blobs */
+        if (bdb_state->compress_blobs == BDB_COMPRESS_LZ4DICT)
+            odh->flags |= BDB_COMPRESS_LZ4;
+        else
+            odh->flags |= (bdb_state->compress_blobs & ODH_FLAG_COMPR_MASK);
     } else {
         odh->flags |= (bdb_state->compress & ODH_FLAG_COMPR_MASK);
     }
 }
 
+/*
+ * Trained dictionaries for BDB_COMPRESS_LZ4DICT.
+ *
+ * Narrow records compress poorly on their own because lz4 starts every record
+ * with no history.  With a dictionary sampled from the table, field names,
+ * padding and common values can be matched against the dictionary instead.
+ * The compressed payload is
+ *
+ *    [2-byte dictionary version][lz4 block compressed against it]
+ *
+ * and dictionaries live in llmeta keyed by table and version, so records
+ * written with an older dictionary stay readable after a retrain.
+ *
+ * Each version is loaded once into the handle and never changed afterwards;
+ * writers serialize on compr_dict_lk and readers walk the list without a
+ * lock.  The list is kept newest first, so its head is the dictionary used for
+ * new records.  Versions are loaded when the table is opened and whenever a
+ * (replicated) schema change is applied, before any record using them can be
+ * read, so packing and unpacking never go to llmeta.
+ */
+struct compr_dict {
+    int version;
+    int len;
+    LZ4_stream_t *stream; /* preloaded with dict, copied for every record */
+    struct compr_dict *next;
+    char dict[];
+};
+
+enum { LZ4DICT_HDRSZ = 2, LZ4DICT_MAXSZ = 64 * 1024 };
+
+static pthread_mutex_t compr_dict_lk = PTHREAD_MUTEX_INITIALIZER;
+
+/* dictionaries belong to the table, not to the sc temp table's files */
+static const char *compr_dict_table(bdb_state_type *bdb_state)
+{
+    int bdberr;
+    if (bdb_state->origname)
+        return bdb_state->origname;
+    return bdb_unprepend_new_prefix(bdb_state->name, &bdberr);
+}
+
+static struct compr_dict *compr_dict_find(bdb_state_type *bdb_state,
+                                          int version)
+{
+    struct compr_dict *d;
+    for (d = bdb_state->compr_dicts; d; d = d->next) {
+        if (d->version == version)
+            return d;
+        if (d->version < version)
+            break;
+    }
+    return NULL;
+}
+
+/* the dictionary bytes are copied */
+static int compr_dict_add(bdb_state_type *bdb_state, int version,
+                          const void *dict, int len)
+{
+    struct compr_dict *d, **pp;
+
+    if (len <= 0 || len > LZ4DICT_MAXSZ)
+        return EINVAL;
+    if ((d = malloc(sizeof(struct compr_dict) + len)) == NULL)
+        return ENOMEM;
+    if ((d->stream = LZ4_createStream()) == NULL) {
+        free(d);
+        return ENOMEM;
+    }
+    d->version = version;
+    d->len = len;
+    memcpy(d->dict, dict, len);
+    LZ4_loadDict(d->stream, d->dict, len);
+
+    Pthread_mutex_lock(&compr_dict_lk);
+    for (pp = &bdb_state->compr_dicts; *pp; pp = &(*pp)->next) {
+        if ((*pp)->version <= version)
+            break;
+    }
+    if (*pp && (*pp)->version == version) {
+        Pthread_mutex_unlock(&compr_dict_lk);
+        LZ4_freeStream(d->stream);
+        free(d);
+        return 0;
+    }
+    d->next = *pp;
+    /* readers must see a fully built entry */
+    MEMORY_SYNC;
+    *pp = d;
+    Pthread_mutex_unlock(&compr_dict_lk);
+    return 0;
+}
+
+static int compr_dict_fetch(bdb_state_type *bdb_state, tran_type *tran,
+                            int version)
+{
+    void *dict;
+    int len, rc;
+
+    rc = bdb_get_compr_dict(tran, compr_dict_table(bdb_state), version, &dict,
+                            &len);
+    if (rc == 0) {
+        rc = compr_dict_add(bdb_state, version, dict, len);
+        free(dict);
+    }
+    return rc;
+}
+
+int bdb_load_compr_dicts(bdb_state_type *bdb_state, tran_type *tran)
+{
+    int *versions, num, rc;
+
+    rc = bdb_get_compr_dict_versions(tran, compr_dict_table(bdb_state),
+                                     &versions, &num);
+    if (rc)
+        return rc;
+    for (int i = 0; i < num && rc == 0; ++i) {
+        if (compr_dict_find(bdb_state, versions[i]) == NULL)
+            rc = compr_dict_fetch(bdb_state, tran, versions[i]);
+    }
+    free(versions);
+    return rc;
+}
+
+int bdb_load_compr_dict_pending(bdb_state_type *bdb_state, tran_type *tran)
+{
+    void *dict;
+    int version, len, rc;
+
+    rc = bdb_get_compr_dict_pending(tran, compr_dict_table(bdb_state),
+                                    &version, &dict, &len);
+    if (rc == 0) {
+        rc = compr_dict_add(bdb_state, version, dict, len);
+        free(dict);
+    }
+    return rc == 1 ? 0 : rc;
+}
+
+int bdb_get_compr_dict_info(bdb_state_type *bdb_state, int *len)
+{
+    struct compr_dict *d = bdb_state->compr_dicts;
+    *len = d ? d->len : 0;
+    return d ? d->version : 0;
+}
+
+void bdb_cleanup_compr_dicts(bdb_state_type *bdb_state)
+{
+    if (bdb_state == NULL)
+        return;
+    struct compr_dict *d = bdb_state->compr_dicts;
+    while (d) {
+        struct compr_dict *next = d->next;
+        LZ4_freeStream(d->stream);
+        free(d);
+        d = next;
+    }
+    bdb_state->compr_dicts = NULL;
+}
+
+/* dictionary for new records, or NULL if the table has none yet */
+static struct compr_dict *compr_dict_current(bdb_state_type *bdb_state)
+{
+    return bdb_state->compr_dicts;
+}
+
+/* Returns the compressed size, or 0 if the record doesn't get smaller. */
+static int lz4dict_compress(const struct compr_dict *d, const char *src,
+                            char *dst, int len)
+{
+    /* copying the preloaded state is much cheaper than LZ4_loadDict() */
+    LZ4_stream_t stream;
+    int rc;
+
+    if (len <= LZ4DICT_HDRSZ + 1)
+        return 0;
+    memcpy(&stream, d->stream, sizeof(stream));
+    rc = LZ4_compress_fast_continue(&stream, src, dst + LZ4DICT_HDRSZ, len,
+                                    len - LZ4DICT_HDRSZ - 1, 1);
+    if (rc <= 0)
+        return 0;
+    dst[0] = (d->version >> 8) & 0xff;
+    dst[1] = d->version & 0xff;
+    return rc + LZ4DICT_HDRSZ;
+}
+
+int bdb_lz4dict_compress(bdb_state_type *bdb_state, const void *src, int len,
+                         void *dst)
+{
+    struct compr_dict *d = compr_dict_current(bdb_state);
+    return d ? lz4dict_compress(d, src, dst, len) : 0;
+}
+
+/* Returns the decompressed size or a negative number on error. */
+static int lz4dict_decompress(bdb_state_type *bdb_state, const char *src,
+                              int srclen, char *dst, int len)
+{
+    struct compr_dict *d;
+    int version;
+
+    if (srclen < LZ4DICT_HDRSZ)
+        return -1;
+    version = ((uint8_t)src[0] << 8) | (uint8_t)src[1];
+    if ((d = compr_dict_find(bdb_state, version)) == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: %s has no dictionary version %d loaded\n",
+               __func__, bdb_state->name, version);
+        return -1;
+    }
+    return LZ4_decompress_safe_usingDict(src + LZ4DICT_HDRSZ, dst,
+                                         srclen - LZ4DICT_HDRSZ, len, d->dict,
+                                         d->len);
+}
+
 /* Pack a record ready for storage on disk with the ODH (if enabled).
  *
  * Input:
@@ -409,6 +630,21 @@ int bdb_pack(bdb_state_type *bdb_state, const struct odh *odh, void *to,
             break;
         }
 
+        case BDB_COMPRESS_LZ4DICT: {
+            struct compr_dict *d = compr_dict_current(bdb_state);
+            if (d) {
+                rc = lz4dict_compress(d, odh->recptr, (char *)to + ODH_SIZE,
+                                      odh->length);
+                if (rc == 0)
+                    alg = BDB_COMPRESS_NONE;
+                else
+                    *recsize = rc + ODH_SIZE;
+                break;
+            }
+            /* nothing trained yet */
+            flags = (flags & ~ODH_FLAG_COMPR_MASK) | BDB_COMPRESS_LZ4;
+        }
+        /* fall through */
         case BDB_COMPRESS_LZ4:
             if ((rc = LZ4_compress_default(
                      odh->recptr, (char *)to + ODH_SIZE, odh->length,
@@ -599,6 +835,12 @@ static int bdb_unpack_updateid(bdb_state_type *bdb_state, const void *from, size
                 if (rc != odh->length) {
                     goto err;
                 }
+            } else if (alg == BDB_COMPRESS_LZ4DICT) {
+                rc = lz4dict_decompress(bdb_state, (char *)from + ODH_SIZE,
+                                        fromlen - ODH_SIZE, to, odh->length);
+                if (rc != odh->length) {
+                    goto err;
+                }
             }
 
             /* Successfully decompressed */
@@ -1442,3 +1684,148 @@ int bdb_pack_heap(bdb_state_type *bdb_state, void *in, size_t inlen, void **out,
         free(*freeptr);
     return rc;
 }
+
+/* Append the record at the cursor to the dictionary being built.  Returns the
+ * number of bytes added. */
+static int compr_dict_sample(bdb_state_type *bdb_state, DBC *dbcp,
+                             unsigned long long *genid, char *dict, int off,
+                             int dictsz)
+{
+    DBT key = {0}, data = {0};
+    struct odh odh;
+    void *freeptr = NULL;
+    int len = 0;
+
+    key.data = genid;
+    key.size = key.ulen = sizeof(*genid);
+    key.flags = DB_DBT_USERMEM;
+    data.flags = DB_DBT_MALLOC;
+
+    if (dbcp->c_get(dbcp, &key, &data, DB_SET_RANGE) != 0)
+        return 0;
+    if (bdb_unpack(bdb_state, data.data, data.size, NULL, 0, &odh,
+                   &freeptr) == 0) {
+        len = odh.length;
+        if (len > dictsz - off)
+            len = dictsz - off;
+        memcpy(dict + off, odh.recptr, len);
+    }
+    free(freeptr);
+    free(data.data);
+    return len;
+}
+
+/* Random probes into each data stripe between its oldest and newest genid.
+ * This touches only the sampled pages, so training costs the same on a huge
+ * table as on a small one. */
+static int compr_dict_build(bdb_state_type *bdb_state, char *dict, int dictsz,
+                            int nsamples)
+{
+    int nstripes = bdb_get_datafile_num_files(bdb_state, 0);
+    int per_stripe = nsamples / nstripes + 1;
+    int off = 0;
+
+    for (int stripe = 0; stripe < nstripes && off < dictsz; ++stripe) {
+        DB *dbp = bdb_state->dbp_data[0][stripe];
+        unsigned long long lo, hi;
+        DBT key = {0}, data = {0};
+        DBC *dbcp;
+
+        if (dbp->cursor(dbp, NULL, &dbcp, 0) != 0)
+            continue;
+        key.data = &lo;
+        key.ulen = sizeof(lo);
+        key.flags = DB_DBT_USERMEM;
+        /* keys only */
+        data.flags = DB_DBT_PARTIAL | DB_DBT_USERMEM;
+        if (dbcp->c_get(dbcp, &key, &data, DB_FIRST) != 0) {
+            dbcp->c_close(dbcp);
+            continue;
+        }
+        key.data = &hi;
+        if (dbcp->c_get(dbcp, &key, &data, DB_LAST) != 0) {
+            dbcp->c_close(dbcp);
+            continue;
+        }
+
+        /* genids compare as big-endian integers */
+        uint64_t first = flibc_ntohll(lo), span = flibc_ntohll(hi) - first;
+        for (int i = 0; i < per_stripe && off < dictsz; ++i) {
+            uint64_t r = ((uint64_t)random() << 31) ^ random();
+            unsigned long long genid =
+                flibc_htonll(first + (span ? r % (span + 1) : 0));
+            off += compr_dict_sample(bdb_state, dbcp, &genid, dict, off,
+                                     dictsz);
+        }
+        dbcp->c_close(dbcp);
+    }
+    return off;
+}
+
+static char *compr_dict_train(bdb_state_type *bdb_state, int *len,
+                              int *bdberr)
+{
+    int dictsz = bdb_state->attr->compr_dict_size;
+    char *dict;
+
+    *bdberr = BDBERR_NOERROR;
+    if (dictsz > LZ4DICT_MAXSZ)
+        dictsz = LZ4DICT_MAXSZ;
+    if (dictsz <= 0 || (dict = malloc(dictsz)) == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return NULL;
+    }
+
+    BDB_READLOCK("bdb_train_compr_dict");
+    *len = compr_dict_build(bdb_state, dict, dictsz,
+                            bdb_state->attr->compr_dict_samples);
+    BDB_RELLOCK();
+
+    /* a dictionary smaller than a few records isn't worth a version */
+    if (*len < 2 * bdb_state->lrl || *len < 256) {
+        logmsg(LOGMSG_ERROR,
+               "%s: not enough data in %s to train a dictionary (%d bytes)\n",
+               __func__, bdb_state->name, *len);
+        free(dict);
+        *bdberr = BDBERR_FETCH_DTA;
+        return NULL;
+    }
+    return dict;
+}
+
+int bdb_train_compr_dict(bdb_state_type *bdb_state, tran_type *tran,
+                         int *version, int *bdberr)
+{
+    char *dict;
+    int len, rc;
+
+    if ((dict = compr_dict_train(bdb_state, &len, bdberr)) == NULL)
+        return -1;
+    rc = bdb_add_compr_dict(tran, compr_dict_table(bdb_state), dict, len,
+                            version);
+    free(dict);
+    if (rc)
+        *bdberr = BDBERR_MISC;
+    return rc;
+}
+
+int bdb_train_compr_dict_pending(bdb_state_type *from, bdb_state_type *to,
+                                 int *version, int *bdberr)
+{
+    const char *table = compr_dict_table(from);
+    char *dict;
+    int len, rc;
+
+    if ((dict = compr_dict_train(from, &len, bdberr)) == NULL)
+        return -1;
+    /* only one schema change runs on a table, so nobody else can take the
+     * version before finalize commits it */
+    if ((rc = bdb_next_compr_dict_version(NULL, table, version)) == 0 &&
+        (rc = bdb_set_compr_dict_pending(NULL, table, *version, dict, len)) ==
+            0)
+        rc = compr_dict_add(to, *version, dict, len);
+    free(dict);
+    if (rc)
+        *bdberr = BDBERR_MISC;
+    return rc;
+}
@@ -71,6 +71,7 @@
 #include "flibc.h"
 #include "logmsg.h"
 #include "analyze.h"
+#include "hll.h"
 
 extern int get_schema_change_in_progress(const char *func, int line);
 static double analyze_headroom = 6;
@@ -128,14 +129,46 @@ struct sampler {
     int pos;                    /* to keep track of the index in the page */
     void *data;                 /* payload of the entry at `pos' */
     int len;                    /* length of the payload */
+    struct sampled_page *pages; /* in-memory sample, used instead of tmptbl */
+    int npages;                 /* number of pages in the in-memory sample */
+    int ipage;                  /* current page in the in-memory sample */
 };
 
-int sampler_first(sampler_t *sampler)
+/* A leaf page kept by the streaming summary, and its 1st key to sort on */
+struct sampled_page {
+    PAGE *page;
+    void *key;
+    int keylen;
+};
+
+static int sampler_first_page(sampler_t *sampler)
 {
-    struct temp_cursor *tmpcur = sampler->tmpcur;
     int unused;
+    if (sampler->pages) {
+        sampler->ipage = 0;
+        return sampler->npages > 0 ? 0 : -1;
+    }
+    return bdb_temp_table_first(sampler->bdb_state, sampler->tmpcur, &unused);
+}
 
-    if (bdb_temp_table_first(sampler->bdb_state, tmpcur, &unused) != 0)
+static int sampler_next_page(sampler_t *sampler)
+{
+    int unused;
+    if (sampler->pages)
+        return ++sampler->ipage < sampler->npages ? 0 : -1;
+    return bdb_temp_table_next(sampler->bdb_state, sampler->tmpcur, &unused);
+}
+
+static PAGE *sampler_page(sampler_t *sampler)
+{
+    if (sampler->pages)
+        return sampler->pages[sampler->ipage].page;
+    return (PAGE *)bdb_temp_table_data(sampler->tmpcur);
+}
+
+int sampler_first(sampler_t *sampler)
+{
+    if (sampler_first_page(sampler) != 0)
         return IX_EMPTY;
 
     sampler->pos = 0;
@@ -163,12 +196,10 @@ int sampler_next(sampler_t *sampler)
     DB *dbp = &sampler->db;
     PAGE *page;
     db_indx_t *inp;
-    int unused;
-    struct temp_cursor *tmpcur = sampler->tmpcur;
     int ii, n, minlen, memcmprc;
 
 next_leaf:
-    page = (PAGE *)bdb_temp_table_data(tmpcur);
+    page = sampler_page(sampler);
     inp = P_INP(dbp, page);
     ii = sampler->pos;
     n = NUM_ENT(page);
@@ -215,7 +246,7 @@ next_leaf:
     }
 
     if (rc != IX_FND) {
-        if (bdb_temp_table_next(sampler->bdb_state, tmpcur, &unused) != 0)
+        if (sampler_next_page(sampler) != 0)
             return IX_PASTEOF;
         sampler->pos = 0;
         goto next_leaf;
@@ -263,15 +294,133 @@ int sampler_close(sampler_t *sampler)
     if (sampler == NULL)
         return 0;
 
-    (void)bdb_temp_table_close(sampler->bdb_state, sampler->tmptbl, &unused);
+    if (sampler->tmptbl)
+        (void)bdb_temp_table_close(sampler->bdb_state, sampler->tmptbl,
+                                   &unused);
+    for (int i = 0; i < sampler->npages; ++i) {
+        free(sampler->pages[i].page);
+        free(sampler->pages[i].key);
+    }
+    free(sampler->pages);
     free(sampler->data);
     free(sampler);
     return 0;
 }
 
-int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
-                        sampler_t **samplerp, unsigned long long *outrecs,
-                        unsigned long long *cmprecs, int *bdberr)
+/* State of a streaming (single pass, no temptable) summary */
+struct summarize_sketch {
+    int nprefix;                 /* number of key prefixes to count */
+    const int *prefixlen;        /* ondisk length of each prefix */
+    struct hll **hll;            /* one distinct-count sketch per prefix */
+    unsigned long long nkeys;    /* live keys seen on all leaf pages */
+    unsigned long long nleaf;    /* leaf pages offered to the reservoir */
+    int cap;                     /* reservoir size, in pages */
+    int nres;                    /* pages currently in the reservoir */
+    struct sampled_page *res;    /* the reservoir */
+    PAGE *scratch;               /* page copy we can byteswap in place */
+};
+
+#define SUMMARIZE_HLL_PRECISION 14
+
+/* Feed every live key on this leaf page to the prefix sketches. The page
+   is copied first as decoding byteswaps it in place. */
+static void sketch_page(DB *dbp, PAGE *page, db_indx_t n, int pgsz,
+                        struct summarize_sketch *sk)
+{
+    uint8_t pfxbuf[KEYBUF];
+    PAGE *pg = sk->scratch;
+    memcpy(pg, page, pgsz);
+    db_indx_t *inp = P_INP(dbp, pg);
+
+    for (int ii = 0; ii < n; ii += 2) {
+        if (F_ISSET(dbp, DB_AM_SWAP))
+            inp[ii] = flibc_shortflip(inp[ii]);
+        if (inp[ii] >= pgsz)
+            continue;
+        BKEYDATA *data = GET_BKEYDATA(dbp, pg, ii);
+        if (B_DISSET(data) || B_TYPE(data) != B_KEYDATA)
+            continue;
+        if (F_ISSET(dbp, DB_AM_SWAP))
+            data->len = flibc_shortflip(data->len);
+        if (bk_decompress(dbp, pg, &data, pfxbuf, sizeof(pfxbuf)) != 0)
+            continue;
+        db_indx_t len;
+        ASSIGN_ALIGN(db_indx_t, len, data->len);
+
+        uint64_t h = HLL_HASH_INIT;
+        int off = 0;
+        for (int i = 0; i < sk->nprefix; ++i) {
+            int end = sk->prefixlen[i] < len ? sk->prefixlen[i] : len;
+            if (end > off) {
+                h = hll_hash_update(h, data->data + off, end - off);
+                off = end;
+            }
+            hll_add(sk->hll[i], hll_hash_final(h));
+        }
+        ++sk->nkeys;
+    }
+}
+
+/* Reservoir-sample this leaf page (Vitter's algorithm R): every page seen
+   so far has the same chance, cap/nleaf, of being kept. */
+static int reservoir_page(PAGE *page, int pgsz, void *key, int keylen,
+                          struct summarize_sketch *sk)
+{
+    unsigned long long seen = sk->nleaf++;
+    int slot;
+    if (sk->nres < sk->cap) {
+        slot = sk->nres++;
+    } else {
+        unsigned long long r = ((unsigned long long)rand() << 31) ^ rand();
+        r %= seen + 1;
+        if (r >= sk->cap)
+            return 0;
+        slot = r;
+        free(sk->res[slot].page);
+        free(sk->res[slot].key);
+    }
+    struct sampled_page *sp = &sk->res[slot];
+    sp->page = malloc(pgsz);
+    sp->key = malloc(keylen);
+    if (sp->page == NULL || sp->key == NULL) {
+        free(sp->page);
+        free(sp->key);
+        sp->page = sp->key = NULL;
+        return -1;
+    }
+    memcpy(sp->page, page, pgsz);
+    memcpy(sp->key, key, keylen);
+    sp->keylen = keylen;
+    return 0;
+}
+
+static int sampled_page_cmp(const void *a, const void *b)
+{
+    const struct sampled_page *l = a, *r = b;
+    int minlen = l->keylen < r->keylen ? l->keylen : r->keylen;
+    int cmp = memcmp(l->key, r->key, minlen);
+    if (cmp)
+        return cmp;
+    return l->keylen - r->keylen;
+}
+
+static void sketch_free(struct summarize_sketch *sk)
+{
+    for (int i = 0; i < sk->nprefix; ++i)
+        hll_free(sk->hll[i]);
+    free(sk->hll);
+    for (int i = 0; i < sk->nres; ++i) {
+        free(sk->res[i].page);
+        free(sk->res[i].key);
+    }
+    free(sk->res);
+    free(sk->scratch);
+}
+
+static int summarize_int(bdb_state_type *bdb_state, int ixnum, int comp_pct,
+                         struct summarize_sketch *sk, size_t max_bytes,
+                         sampler_t **samplerp, unsigned long long *outrecs,
+                         unsigned long long *cmprecs, int *bdberr)
 {
     DB_ENV *dbenv = bdb_state->dbenv;
     int is_hmac = CRYPTO_ON(dbenv);
@@ -308,14 +457,21 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         goto done;
     }
 
-    rc = check_free_space(bdb_state->dir);
+    /* the streaming summary keeps its sample in memory */
+    rc = sk ? BDBERR_NOERROR : check_free_space(bdb_state->dir);
     if (rc != BDBERR_NOERROR) {
         *bdberr = rc;
         rc = -1;
         goto done;
     }
 
-    sampler = sampler_init(bdb_state, bdberr);
+    if (sk) {
+        sampler = calloc(1, sizeof(sampler_t));
+        if (sampler)
+            sampler->bdb_state = bdb_state;
+    } else {
+        sampler = sampler_init(bdb_state, bdberr);
+    }
 
     if (sampler == NULL) {
         rc = -1;
@@ -358,6 +514,20 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
     }
     pgsz = dbp->pgsize;
     page = malloc(pgsz);
+    if (sk) {
+        struct stat st;
+        long long npages = fstat(fd, &st) == 0 ? st.st_size / pgsz : 0;
+        long long cap = npages * comp_pct / 100;
+        if (cap > max_bytes / pgsz)
+            cap = max_bytes / pgsz;
+        sk->cap = cap > 0 ? cap : 1;
+        sk->res = calloc(sk->cap, sizeof(struct sampled_page));
+        sk->scratch = malloc(pgsz);
+        if (sk->res == NULL || sk->scratch == NULL) {
+            rc = -1;
+            goto done;
+        }
+    }
 #ifndef NDEBUG
     uint8_t *max = (uint8_t *)page + pgsz;
 #endif
@@ -440,6 +610,13 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         if (n == 0)
             continue;
 
+        if (sk) {
+            NUM_ENT(page) = n;
+            sketch_page(dbp, page, n, pgsz, sk);
+            recs_looked_at += (n >> 1);
+            goto check;
+        }
+
         /* We only care about the key so we take half entries
            on the page. We don't check the flags of every entry
            to get the count, so it's likely deleted entries are
@@ -454,9 +631,10 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         NUM_ENT(page) = n;
         nrecs += (n >> 1);
 
+    check:
         /* Check disk space, schema changes, analyze abort request etc. */
         now = comdb2_time_epoch();
-        if (now - last >= 10) {
+        if (!sk && now - last >= 10) {
             last = now;
             rc = check_free_space(bdb_state->dir);
             if (rc != BDBERR_NOERROR) {
@@ -516,6 +694,13 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         inp[0] = originp;
         origdta->len = origdlen;
 
+        if (sk) {
+            rc = reservoir_page(page, pgsz, data->data, len, sk);
+            if (rc)
+                goto done;
+            continue;
+        }
+
         /* Save the entire page:
            key is the 1st key on the page;
            data is the page itself. */
@@ -532,6 +717,19 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         goto done;
     }
 
+    if (sk) {
+        /* hand the reservoir over to the sampler, in key order */
+        qsort(sk->res, sk->nres, sizeof(struct sampled_page),
+              sampled_page_cmp);
+        for (int i = 0; i < sk->nres; ++i)
+            nrecs += NUM_ENT(sk->res[i].page) >> 1;
+        sampler->pages = sk->res;
+        sampler->npages = sk->nres;
+        sk->res = NULL;
+        sk->nres = 0;
+        recs_looked_at = sk->nkeys;
+    }
+
     logmsg(LOGMSG_INFO, "summarize added %llu records, traversed %llu\n", nrecs,
            recs_looked_at);
 done:
@@ -554,3 +752,53 @@ done:
 
     return rc;
 }
+
+int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
+                        sampler_t **samplerp, unsigned long long *outrecs,
+                        unsigned long long *cmprecs, int *bdberr)
+{
+    return summarize_int(bdb_state, ixnum, comp_pct, NULL, 0, samplerp,
+                         outrecs, cmprecs, bdberr);
+}
+
+int bdb_summarize_table_streaming(bdb_state_type *bdb_state, int ixnum,
+                                  int comp_pct, size_t max_bytes, int nprefix,
+                                  const int *prefixlen, uint64_t *ndistinct,
+                                  sampler_t **samplerp,
+                                  unsigned long long *outrecs,
+                                  unsigned long long *cmprecs, int *bdberr)
+{
+    struct summarize_sketch sk = {0};
+    int rc;
+
+    sk.nprefix = nprefix;
+    sk.prefixlen = prefixlen;
+    sk.hll = calloc(nprefix, sizeof(struct hll *));
+    if (sk.hll == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+    for (int i = 0; i < nprefix; ++i) {
+        if ((sk.hll[i] = hll_new(SUMMARIZE_HLL_PRECISION)) == NULL) {
+            sketch_free(&sk);
+            *bdberr = BDBERR_MALLOC;
+            return -1;
+        }
+    }
+
+    rc = summarize_int(bdb_state, ixnum, comp_pct, &sk, max_bytes, samplerp,
+                       outrecs, cmprecs, bdberr);
+    if (rc == 0 && *bdberr == BDBERR_NOERROR) {
+        for (int i = 0; i < nprefix; ++i) {
+            uint64_t n = hll_count(sk.hll[i]);
+            /* an estimate, so keep it within what is possible */
+            if (n > sk.nkeys)
+                n = sk.nkeys;
+            if (n < 1)
+                n = 1;
+            ndistinct[i] = n;
+        }
+    }
+    sketch_free(&sk);
+    return rc;
+}
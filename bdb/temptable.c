@@ -192,7 +192,12 @@ typedef struct arr_elem {
    or the in-memory data size exceeds a pre-configured cache size,
    a temparray will fall back to a temptable.
    A temparray is more efficient than a temptable. Besides, it uses far
-   less memory than a temptable for small and medium-sized requests. */
+   less memory than a temptable for small and medium-sized requests.
+
+   Keys and data live in an arena owned by the table. With lazy sorting
+   on, out-of-order inserts are appended and the array is sorted (stably,
+   so duplicates keep insertion order) by the first operation that needs
+   the order: a cursor move, a find, or a spill to the temptable. */
 enum {
     TEMP_TABLE_TYPE_BTREE,
     TEMP_TABLE_TYPE_HASH,
@@ -223,8 +228,174 @@ struct temp_table {
     unsigned long long inmemsz;
     unsigned long long cachesz;
     arr_elem_t *elements;
+    int elements_cap;
+    int unsorted; /* temparray has entries appended out of order */
+    int lazy_sort;
+    struct temp_arena_chunk *arena;
+    unsigned long long arenasz;
+};
+
+/* Temparray keys and data are carved out of these; nothing is freed
+   until the whole table is truncated, spilled or closed. */
+#define TEMP_ARENA_CHUNK (64 * 1024)
+struct temp_arena_chunk {
+    struct temp_arena_chunk *next;
+    size_t used;
+    size_t size;
+    uint8_t buf[];
 };
 
+static uint8_t *temp_arena_alloc(struct temp_table *tbl, size_t len)
+{
+    struct temp_arena_chunk *c = tbl->arena;
+
+    len = (len + 7) & ~(size_t)7;
+    if (c == NULL || c->size - c->used < len) {
+        size_t sz = len > TEMP_ARENA_CHUNK ? len : TEMP_ARENA_CHUNK;
+        struct temp_arena_chunk *n = malloc(sizeof(*n) + sz);
+        if (n == NULL)
+            return NULL;
+        n->used = 0;
+        n->size = sz;
+        tbl->arenasz += sz;
+        if (c != NULL && sz > TEMP_ARENA_CHUNK) {
+            /* oversized: keep carving from the current chunk */
+            n->next = c->next;
+            c->next = n;
+            n->used = len;
+            return n->buf;
+        }
+        n->next = c;
+        tbl->arena = c = n;
+    }
+    uint8_t *p = c->buf + c->used;
+    c->used += len;
+    return p;
+}
+
+static void temp_arena_reset(struct temp_table *tbl)
+{
+    struct temp_arena_chunk *c = tbl->arena, *n;
+    while (c) {
+        n = c->next;
+        free(c);
+        c = n;
+    }
+    tbl->arena = NULL;
+    tbl->arenasz = 0;
+}
+
+/* Move live entries into one fresh chunk, dropping space left behind by
+   deletes and growing updates. */
+static int temp_arena_compact(struct temp_table *tbl)
+{
+    struct temp_arena_chunk *c;
+    arr_elem_t *elem;
+    size_t total = 0;
+
+    for (unsigned long long ii = 0; ii != tbl->num_mem_entries; ++ii) {
+        elem = &tbl->elements[ii];
+        total += (elem->keylen + elem->dtalen + 7) & ~(size_t)7;
+    }
+    if ((c = malloc(sizeof(*c) + total)) == NULL)
+        return -1;
+    c->next = NULL;
+    c->size = c->used = total;
+
+    uint8_t *p = c->buf;
+    for (unsigned long long ii = 0; ii != tbl->num_mem_entries; ++ii) {
+        elem = &tbl->elements[ii];
+        memcpy(p, elem->key, elem->keylen + elem->dtalen);
+        elem->key = p;
+        elem->dta = p + elem->keylen;
+        p += (elem->keylen + elem->dtalen + 7) & ~(size_t)7;
+    }
+    temp_arena_reset(tbl);
+    tbl->arena = c;
+    tbl->arenasz = total;
+    return 0;
+}
+
+static int temp_array_reserve(struct temp_table *tbl, int n)
+{
+    if (n <= tbl->elements_cap)
+        return 0;
+    int cap = tbl->elements_cap ? tbl->elements_cap : 64;
+    while (cap < n)
+        cap *= 2;
+    if (cap > tbl->max_mem_entries && n <= tbl->max_mem_entries)
+        cap = tbl->max_mem_entries;
+    arr_elem_t *e = realloc(tbl->elements, sizeof(arr_elem_t) * cap);
+    if (e == NULL)
+        return -1;
+    tbl->elements = e;
+    tbl->elements_cap = cap;
+    return 0;
+}
+
+static void temp_array_merge(struct temp_table *tbl, arr_elem_t *a, int na,
+                             arr_elem_t *b, int nb, arr_elem_t *out)
+{
+    tmptbl_cmp cmpfn = tbl->cmpfunc;
+    int i = 0, j = 0, k = 0;
+
+    while (i < na && j < nb) {
+        /* take from the left run on ties so the sort is stable */
+        if (cmpfn(NULL, b[j].keylen, b[j].key, a[i].keylen, a[i].key) < 0)
+            out[k++] = b[j++];
+        else
+            out[k++] = a[i++];
+    }
+    while (i < na)
+        out[k++] = a[i++];
+    while (j < nb)
+        out[k++] = b[j++];
+}
+
+/* Bottom-up merge sort: stable, and runs that are already in order (the
+   common case for mostly-sorted inserts) cost one compare per element. */
+static int temp_array_sort(struct temp_table *tbl)
+{
+    int n = tbl->num_mem_entries;
+    arr_elem_t *src = tbl->elements, *dst, *tmp;
+    tmptbl_cmp cmpfn = tbl->cmpfunc;
+
+    if (!tbl->unsorted)
+        return 0;
+    if ((tmp = malloc(sizeof(arr_elem_t) * n)) == NULL)
+        return -1;
+    dst = tmp;
+
+    for (int width = 1; width < n; width *= 2) {
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            int mid = lo + width < n ? lo + width : n;
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;
+            if (mid < hi && cmpfn(NULL, src[mid].keylen, src[mid].key,
+                                  src[mid - 1].keylen, src[mid - 1].key) < 0)
+                temp_array_merge(tbl, src + lo, mid - lo, src + mid, hi - mid,
+                                 dst + lo);
+            else
+                memcpy(dst + lo, src + lo, sizeof(arr_elem_t) * (hi - lo));
+        }
+        arr_elem_t *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != tbl->elements)
+        memcpy(tbl->elements, src, sizeof(arr_elem_t) * n);
+    free(tmp);
+    tbl->unsorted = 0;
+    return 0;
+}
+
+#define TEMP_ARRAY_SORT(t)                                                     \
+    do {                                                                       \
+        if ((t)->unsorted && temp_array_sort(t) != 0) {                        \
+            logmsg(LOGMSG_ERROR, "%s: failed to sort temparray\n", __func__);  \
+            return -1;                                                         \
+        }                                                                      \
+    } while (0)
+
 enum { TMPTBL_PRIORITY, TMPTBL_WAIT };
 
 static int curid; /* for debug trace only */
@@ -351,6 +522,9 @@ static int bdb_array_copy_to_temp_db(bdb_state_type *bdb_state,
         bdb_temp_table_destroy_pool_wrapper(tbl, bdb_state);
     }
 
+    /* key order also makes the btree inserts below hit its append path */
+    TEMP_ARRAY_SORT(tbl);
+
     for (ii = 0; ii != nents; ++ii) {
         elem = &tbl->elements[ii];
         dbt_key.flags = dbt_data.flags = DB_DBT_USERMEM;
@@ -366,10 +540,7 @@ static int bdb_array_copy_to_temp_db(bdb_state_type *bdb_state,
         }
     }
 
-    for (ii = 0; ii != nents; ++ii) {
-        elem = &tbl->elements[ii];
-        free(elem->key);
-    }
+    temp_arena_reset(tbl);
     tbl->inmemsz = 0;
     tbl->num_mem_entries = nents;
 
@@ -790,15 +961,14 @@ static struct temp_table *bdb_temp_table_create_type(bdb_state_type *bdb_state,
             listc_init(&table->temp_tbl_list, offsetof(struct temp_list_node, lnk));
             break;
         case TEMP_TABLE_TYPE_ARRAY:
-            if (table->elements == NULL) {
-                table->elements = calloc(table->max_mem_entries, sizeof(arr_elem_t));
-                if (table->elements == NULL) {
-                    bdb_temp_table_destroy_pool_wrapper(table, bdb_state);
-                    return NULL;
-                }
+            if (temp_array_reserve(table, 1) != 0) {
+                bdb_temp_table_destroy_pool_wrapper(table, bdb_state);
+                return NULL;
             }
+            table->lazy_sort = bdb_state->attr->temparray_lazy_sort;
             break;
         }
+        table->unsorted = 0;
 
         table->num_mem_entries = 0;
         table->cmpfunc = key_memcmp;
@@ -954,15 +1124,17 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
         if (!cur->valid)
             return -1;
 
-        /* Free the existing elements and update the memory footprint. */
-        elem = &cur->tbl->elements[cur->ind];
-        free(elem->key);
-        cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
+        TEMP_ARRAY_SORT(cur->tbl);
 
-        /* malloc and copy */
-        keycopy = malloc(keylen + dtalen);
-        if (keycopy == NULL)
+        /* Reuse the old space if the new entry fits, otherwise take new
+           space from the arena. Update the memory footprint. */
+        elem = &cur->tbl->elements[cur->ind];
+        if (keylen + dtalen <= elem->keylen + elem->dtalen)
+            keycopy = elem->key;
+        else if ((keycopy = temp_arena_alloc(cur->tbl, keylen + dtalen)) ==
+                 NULL)
             return -1;
+        cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
         dtacopy = keycopy + keylen;
         memcpy(keycopy, key, keylen);
         memcpy(dtacopy, data, dtalen);
@@ -1118,6 +1290,7 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
     }
 
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
+        TEMP_ARRAY_SORT(cur->tbl);
         arrlen = cur->tbl->num_mem_entries;
         if (arrlen == 0) {
             cur->valid = 0;
@@ -1216,6 +1389,7 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
     }
 
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
+        TEMP_ARRAY_SORT(cur->tbl);
         if ((how == DB_NEXT && ++cur->ind >= cur->tbl->num_mem_entries) ||
             (how == DB_PREV && --cur->ind < 0)) {
             cur->valid = 0;
@@ -1450,8 +1624,7 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
 {
     if (tbl == NULL)
         return 0;
-    int rc = 0, ii = 0;
-    arr_elem_t *elem;
+    int rc = 0;
 
     switch (tbl->temp_table_type) {
     case TEMP_TABLE_TYPE_LIST: {
@@ -1485,12 +1658,10 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
         break;
 
     case TEMP_TABLE_TYPE_ARRAY:
-        for (; ii != tbl->num_mem_entries; ++ii) {
-            elem = &tbl->elements[ii];
-            free(elem->key);
-        }
+        temp_arena_reset(tbl);
         tbl->inmemsz = 0;
         tbl->num_mem_entries = 0;
+        tbl->unsorted = 0;
         break;
 
     case TEMP_TABLE_TYPE_BTREE:
@@ -1625,8 +1796,7 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
                                int *bdberr)
 {
     DB_MPOOL_STAT *tmp;
-    int rc, ii;
-    arr_elem_t *elem;
+    int rc;
 
     rc = 0;
 
@@ -1723,10 +1893,6 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
     } break;
 
     case TEMP_TABLE_TYPE_ARRAY:
-        for (ii = 0; ii != tbl->num_mem_entries; ++ii) {
-            elem = &tbl->elements[ii];
-            free(elem->key);
-        }
         break;
 
     case TEMP_TABLE_TYPE_BTREE:
@@ -1735,6 +1901,7 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
 
     if (tbl->temp_hash_tbl != NULL)
         hash_free(tbl->temp_hash_tbl);
+    temp_arena_reset(tbl);
     free(tbl->elements);
 
     /* close the environments*/
@@ -1793,8 +1960,8 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
     }
 
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
+        TEMP_ARRAY_SORT(cur->tbl);
         elem = &cur->tbl->elements[cur->ind];
-        free(elem->key);
         --cur->tbl->num_mem_entries;
         cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
         memmove(elem, elem + 1,
@@ -1917,6 +2084,7 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
             cur->valid = 0;
             return IX_EMPTY;
         }
+        TEMP_ARRAY_SORT(cur->tbl);
 
         lo = 0;
         hi = cur->tbl->num_mem_entries - 1;
@@ -2072,6 +2240,7 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
             cur->valid = 0;
             return IX_EMPTY;
         }
+        TEMP_ARRAY_SORT(cur->tbl);
 
         lo = 0;
         hi = cur->tbl->num_mem_entries - 1;
@@ -2413,31 +2582,45 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
            If 1 or more elements of the same key already exist,
            insert it after the last one of those elements. */
 
-        keycopy = malloc(keylen + dtalen);
+        if (temp_array_reserve(tbl, tbl->num_mem_entries + 1) != 0)
+            return -1;
+        /* reclaim space from deletes/updates once it dominates the arena */
+        if (tbl->arenasz > 2 * tbl->cachesz &&
+            tbl->arenasz > 2 * (tbl->inmemsz + 8 * tbl->num_mem_entries))
+            temp_arena_compact(tbl);
+        keycopy = temp_arena_alloc(tbl, keylen + dtalen);
         if (keycopy == NULL)
             return -1;
         dtacopy = keycopy + keylen;
         memcpy(keycopy, key, keylen);
         memcpy(dtacopy, data, dtalen);
 
-        lo = 0;
-        hi = tbl->num_mem_entries - 1;
-        if (hi >= 0) {
-            cmpfn = tbl->cmpfunc;
-
-            while (lo <= hi) {
-                mid = (lo + hi) >> 1;
-                elem = &tbl->elements[mid];
-                cmp = cmpfn(NULL, elem->keylen, elem->key, keylen, key);
-
-                if (cmp < 0)
-                    lo = mid + 1;
-                else if (cmp > 0)
-                    hi = mid - 1;
+        cmpfn = tbl->cmpfunc;
+        lo = hi = tbl->num_mem_entries;
+        if (hi > 0 && !tbl->unsorted) {
+            /* in order (the usual case for bulk loads): just append */
+            elem = &tbl->elements[hi - 1];
+            if (cmpfn(NULL, elem->keylen, elem->key, keylen, key) > 0) {
+                if (tbl->lazy_sort)
+                    tbl->unsorted = 1;
                 else
-                    lo = mid + 1;
+                    lo = 0;
             }
+        }
+        for (--hi; lo <= hi;) {
+            mid = (lo + hi) >> 1;
+            elem = &tbl->elements[mid];
+            cmp = cmpfn(NULL, elem->keylen, elem->key, keylen, key);
+
+            if (cmp < 0)
+                lo = mid + 1;
+            else if (cmp > 0)
+                hi = mid - 1;
+            else
+                lo = mid + 1;
+        }
 
+        if (lo < tbl->num_mem_entries) {
             elem = &tbl->elements[lo];
             memmove(elem + 1, elem,
                     sizeof(arr_elem_t) * (tbl->num_mem_entries - lo));
@@ -1,4 +1,6 @@
-#include <db.h>
+#include <db_config.h>
+#include <db_int.h>
+#include <dbinc/db_page.h>
 #include <btree/bt_cache.h>
 #include <crc32c.h>
 
@@ -15,8 +17,20 @@ uint32_t rcache_savd;
 uint32_t rcache_invalid;
 uint32_t rcache_collide;
 
+/*
+ * Per-thread cache of the top levels of hot btrees.  Slots are keyed by
+ * (fileid, pgno) and grouped into sets of RCACHE_WAYS; a page may live in
+ * any way of its set, so two hot trees hashing to the same set no longer
+ * evict each other.  Cached copies are used without pinning or locking the
+ * buffer pool page: the BH generation and page LSN recorded at save time
+ * act as the version, and the searcher re-validates every copy it used
+ * once it holds a lock on the first real page below them.
+ */
+#define RCACHE_WAYS 4
+
 typedef struct {
 	uint8_t fileid[DB_FILE_ID_LEN];
+	db_pgno_t pgno;
 	uint16_t gen;
 	uint32_t hitmiss;
 	void *bfpool_pg;
@@ -26,19 +40,25 @@ typedef struct {
 typedef struct {
 	size_t pgsz;
 	size_t count;
+	size_t nsets;
+	int levels;
 	CacheSlot slots[];
 } CacheHndl;
 
 static __thread CacheHndl *hndl = NULL;
 
 void
-rcache_init(size_t count, size_t pgsz)
+rcache_init(size_t count, size_t pgsz, int levels)
 {
 #ifdef __x86_64
 	if (pgsz % (4 * 1024) != 0) {
 		logmsg(LOGMSG_ERROR, "cache size must be multiple of 4 KB");
 		return;
 	}
+	size_t nsets = (count + RCACHE_WAYS - 1) / RCACHE_WAYS;
+	if (nsets == 0)
+		return;
+	count = nsets * RCACHE_WAYS;
 	size_t bytes = sizeof(CacheHndl)
 	    + sizeof(CacheSlot) * count + pgsz * count;
 
@@ -47,13 +67,16 @@ rcache_init(size_t count, size_t pgsz)
 		return;
 	}
 	hndl->count = count;
+	hndl->nsets = nsets;
 	hndl->pgsz = pgsz;
+	hndl->levels = levels < 1 ? 1 : levels;
 	uint8_t *pages = (uint8_t *)&hndl->slots[count];
 	CacheSlot *slot = &hndl->slots[0];
 	CacheSlot *end = &hndl->slots[count];
 
 	do {
 		slot->bfpool_pg = NULL;
+		slot->hitmiss = 0;
 
 		slot->cached_pg = pages;
 		pages += pgsz;
@@ -61,11 +84,20 @@ rcache_init(size_t count, size_t pgsz)
 #endif
 }
 
-static inline void
-hash_fileid(void *fileid, uint32_t * crc, uint32_t * hash)
+/* Returns the first slot of the set (fileid, pgno) maps to. */
+static inline int
+hash_page(void *fileid, db_pgno_t pgno, uint32_t * set)
 {
-	*crc = crc32c(fileid, DB_FILE_ID_LEN);
-	*hash = *crc % hndl->count;
+	uint8_t key[DB_FILE_ID_LEN + sizeof(db_pgno_t)];
+	uint32_t crc;
+
+	memcpy(key, fileid, DB_FILE_ID_LEN);
+	memcpy(key + DB_FILE_ID_LEN, &pgno, sizeof(db_pgno_t));
+	crc = crc32c(key, sizeof(key));
+	if (crc == 0)
+		return -1;
+	*set = (crc % hndl->nsets) * RCACHE_WAYS;
+	return 0;
 }
 
 void
@@ -78,28 +110,36 @@ rcache_destroy(void)
 }
 
 int
-rcache_find(DB *dbp, void **cached_pg, void **bfpool_pg,
+rcache_levels(void)
+{
+	return hndl ? hndl->levels : 0;
+}
+
+int
+rcache_find(DB *dbp, db_pgno_t pgno, void **cached_pg, void **bfpool_pg,
     uint16_t * gen, uint32_t * slot_ptr)
 {
 	if (hndl == NULL || dbp->pgsize > hndl->pgsz)
 		return -1;
-	uint32_t crc, slot;
+	uint32_t set, way;
 
-	hash_fileid(dbp->fileid, &crc, &slot);
-	if (crc == 0)
+	if (hash_page(dbp->fileid, pgno, &set) != 0)
 		return -1;
-	CacheSlot *cache = &hndl->slots[slot];
-
-	if (cache->bfpool_pg
-	    && memcmp(cache->fileid, dbp->fileid, DB_FILE_ID_LEN) == 0) {
-		*cached_pg = cache->cached_pg;
-		*bfpool_pg = cache->bfpool_pg;
-		*gen = cache->gen;
-		*slot_ptr = slot;
-		++rcache_hits;
-		if (cache->hitmiss < 256)
-			++cache->hitmiss;
-		return 0;
+
+	for (way = 0; way < RCACHE_WAYS; ++way) {
+		CacheSlot *cache = &hndl->slots[set + way];
+
+		if (cache->bfpool_pg && cache->pgno == pgno
+		    && memcmp(cache->fileid, dbp->fileid, DB_FILE_ID_LEN) == 0) {
+			*cached_pg = cache->cached_pg;
+			*bfpool_pg = cache->bfpool_pg;
+			*gen = cache->gen;
+			*slot_ptr = set + way;
+			++rcache_hits;
+			if (cache->hitmiss < 256)
+				++cache->hitmiss;
+			return 0;
+		}
 	}
 	++rcache_miss;
 	return -1;
@@ -110,22 +150,44 @@ rcache_save(DB *dbp, void *page, uint16_t gen)
 {
 	if (hndl == NULL || dbp->pgsize > hndl->pgsz)
 		return -1;
-	uint32_t crc, slot;
+	db_pgno_t pgno = PGNO(page);
+	uint32_t set, way;
+	CacheSlot *cache, *victim = NULL;
 
-	hash_fileid(dbp->fileid, &crc, &slot);
-	if (crc == 0)
+	if (hash_page(dbp->fileid, pgno, &set) != 0)
 		return -1;
-	CacheSlot *cache = &hndl->slots[slot];
 
-	if (cache->bfpool_pg) {
+	/*
+	 * Reuse this page's slot or an empty one if there is one.  Otherwise
+	 * age every way in the set and take the least used one once its
+	 * count drops to zero, so a burst of cold pages cannot flush a set
+	 * whose entries are in active use.
+	 */
+	for (way = 0; way < RCACHE_WAYS; ++way) {
+		cache = &hndl->slots[set + way];
+		if (cache->bfpool_pg == NULL || (cache->pgno == pgno &&
+		    memcmp(cache->fileid, dbp->fileid, DB_FILE_ID_LEN) == 0)) {
+			victim = cache;
+			break;
+		}
+	}
+	if (victim == NULL) {
 		++rcache_collide;
-		--cache->hitmiss;
-		if (cache->hitmiss) {	// slot in active use
+		for (way = 0; way < RCACHE_WAYS; ++way) {
+			cache = &hndl->slots[set + way];
+			if (cache->hitmiss)
+				--cache->hitmiss;
+			if (victim == NULL || cache->hitmiss < victim->hitmiss)
+				victim = cache;
+		}
+		if (victim->hitmiss) {	// all ways in active use
 			return -1;
 		}
 	}
+	cache = victim;
 	cache->hitmiss = 1;
 	cache->bfpool_pg = page;
+	cache->pgno = pgno;
 	cache->gen = gen;
 	memcpy(cache->cached_pg, page, dbp->pgsize);
 	memcpy(cache->fileid, dbp->fileid, DB_FILE_ID_LEN);
@@ -47,6 +47,7 @@ static int __bam_c_first __P((DBC *));
 static int __bam_c_get __P((DBC *, DBT *, DBT *, u_int32_t, db_pgno_t *));
 static int __bam_c_getstack __P((DBC *));
 static int __bam_c_last __P((DBC *));
+static int __bam_c_near __P((DBC *, db_pgno_t, const DBT *, int *, int *));
 static int __bam_c_next __P((DBC *, int, int));
 static int __bam_c_physdel __P((DBC *));
 static int __bam_c_prev __P((DBC *));
@@ -3765,6 +3766,101 @@ __bam_c_prev(dbc)
 	return (0);
 }
 
+/*
+ * __bam_c_near --
+ *	Position the cursor for an insert on the advisory page pgno if the
+ *	key sorts strictly inside the page's key range.  Sets *hitp when the
+ *	cursor is positioned; otherwise nothing is held on return.
+ *
+ *	The page lock is only tried, never waited for: a search from the root
+ *	would not have asked for this page first, so waiting here could add
+ *	lock orders (and deadlocks) that the normal descent does not have.
+ */
+static int
+__bam_c_near(dbc, pgno, key, exactp, hitp)
+	DBC *dbc;
+	db_pgno_t pgno;
+	const DBT *key;
+	int *exactp;
+	int *hitp;
+{
+	BTREE *t;
+	BTREE_CURSOR *cp;
+	DB *dbp;
+	PAGE *h;
+	db_indx_t base, indx, lim;
+	int cmp, oldret, ret;
+
+	dbp = dbc->dbp;
+	cp = (BTREE_CURSOR *)dbc->internal;
+	t = dbp->bt_internal;
+	*hitp = 0;
+
+	if (cp->page != NULL) {
+		ret = __memp_fput(dbp->mpf, cp->page, 0);
+		cp->page = NULL;
+		if (ret != 0)
+			goto miss;
+	}
+	cp->pgno = PGNO_INVALID;
+	if (STD_LOCKING(dbc) && (ret = __db_lget(dbc,
+	    LCK_COUPLE, pgno, DB_LOCK_WRITE, DB_LOCK_NOWAIT, &cp->lock)) != 0)
+		goto miss;
+	if ((ret = __memp_fget(dbp->mpf, &pgno, 0, &cp->page)) != 0)
+		goto miss;
+	cp->pgno = pgno;
+	cp->lock_mode = DB_LOCK_WRITE;
+
+	/* Need at least two keys to bracket the new one. */
+	h = cp->page;
+	if (TYPE(h) != P_LBTREE || NUM_ENT(h) < 2 * P_INDX)
+		goto miss;
+
+	if ((ret = __bam_cmp(dbp, key, h, 0, t->bt_compare, &cmp)) != 0)
+		goto miss;
+	if (cmp <= 0)
+		goto miss;
+	if ((ret = __bam_cmp(dbp,
+	    key, h, NUM_ENT(h) - P_INDX, t->bt_compare, &cmp)) != 0)
+		goto miss;
+	if (cmp >= 0)
+		goto miss;
+
+	/*
+	 * Binary search the page as __bam_search would.  An exact match is
+	 * left to the full search so duplicate positioning stays in one place.
+	 */
+	for (base = 0, lim = NUM_ENT(h) / P_INDX; lim != 0; lim >>= 1) {
+		indx = base + ((lim >> 1) * P_INDX);
+		if ((ret = __bam_cmp(dbp,
+		    key, h, indx, t->bt_compare, &cmp)) != 0)
+			goto miss;
+		if (cmp == 0)
+			goto miss;
+		if (cmp > 0) {
+			base = indx + P_INDX;
+			--lim;
+		}
+	}
+
+	*exactp = 0;
+	BT_STK_CLR(cp);
+	BT_STK_ENTER(dbp->dbenv, cp, h, base, cp->lock, cp->lock_mode, ret);
+	if (ret != 0)
+		return (ret);
+	*hitp = 1;
+	return (0);
+
+miss:	oldret = ret;
+	DISCARD_CUR(dbc, ret);
+	cp->pgno = PGNO_INVALID;
+	(void)__LPUT(dbc, cp->lock);
+	if (ret != 0)
+		return (ret);
+	/* Only a deadlock is worth reporting; anything else means retry slow. */
+	return (oldret == DB_LOCK_DEADLOCK ? oldret : 0);
+}
+
 /*
  * __bam_c_search --
  *	Move to a specified record.
@@ -3858,7 +3954,7 @@ fast_search:	/*
 		 * If the tree has no history of insertion, do it the slow way.
 		 */
 		if (bt_lpgno == PGNO_INVALID)
-			goto search;
+			goto near_search;
 
 		/* Lock and retrieve the page on which we last inserted. */
 		h = NULL;
@@ -3965,6 +4061,25 @@ fast_miss:	/*
 		if (oldret == DB_LOCK_DEADLOCK) 
 		    return oldret;
 
+near_search:	/*
+		 * Sorted batches (e.g. deferred index adds on the master) land
+		 * in the middle of the tree, one after another on the same
+		 * leaf.  If the key sorts strictly between the first and last
+		 * keys of the page this locker last inserted on, that page is
+		 * the only one it can belong to.  The hint is only taken by
+		 * the locker that left it, which already holds the page.
+		 */
+		bt_lpgno = t->bt_npgno;
+		if (dbp->dbenv->attr.bt_near_insert &&
+		    bt_lpgno != PGNO_INVALID && t->bt_nlocker == dbc->locker) {
+			int hit = 0;
+			if ((ret = __bam_c_near(dbc,
+			    bt_lpgno, key, exactp, &hit)) != 0)
+				return (ret);
+			if (hit)
+				break;
+		}
+
 search:		if ((ret = __bam_search(dbc, root_pgno,
 		     key, sflags, 1, NULL, exactp)) != 0)
 			return (ret);
@@ -3993,12 +4108,17 @@ search:		if ((ret = __bam_search(dbc, root_pgno,
 	 * is why we subtract P_INDX below.
 	 */
 	if (TYPE(cp->page) == P_LBTREE &&
-	    (flags == DB_KEYFIRST || flags == DB_KEYLAST))
+	    (flags == DB_KEYFIRST || flags == DB_KEYLAST)) {
 		t->bt_lpgno =
 		    (NEXT_PGNO(cp->page) == PGNO_INVALID &&
 		    cp->indx >= NUM_ENT(cp->page) - P_INDX) ||
 		    (PREV_PGNO(cp->page) == PGNO_INVALID &&
 		    cp->indx == 0) ? cp->pgno : PGNO_INVALID;
+		if (t->bt_lpgno == PGNO_INVALID) {
+			t->bt_npgno = cp->pgno;
+			t->bt_nlocker = dbc->locker;
+		}
+	}
 	return (0);
 }
 
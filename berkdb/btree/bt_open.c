@@ -329,6 +329,8 @@ __bam_read_root(dbp, txn, base_pgno, flags)
 	 * intuitively obvious that it belongs here.
 	 */
 	t->bt_lpgno = PGNO_INVALID;
+	t->bt_npgno = PGNO_INVALID;
+	t->bt_nlocker = 0;
 
 	/*
 	 * We must initialize last_pgno, it could be stale.
@@ -346,10 +346,13 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 	int adjust, cmp, deloffset, ret, stack;
 	int (*func) __P((DB *, const DBT *, const DBT *));
 	void *cached_pg = NULL;
-	void *bfpool_pg = NULL;
-	int save = 0;
-	uint16_t gen;
-	uint32_t slot;
+	int save = 0, nocache = 0, rlevels = 0, depth, ncached, n;
+	struct {
+		void *cached_pg;
+		void *bfpool_pg;
+		uint16_t gen;
+		uint32_t slot;
+	} rpath[RCACHE_MAX_LEVELS];
 	unsigned int hh = 0;
 	genid_hash *hash = NULL;
 	__genid_pgno *hashtbl = NULL;
@@ -400,11 +403,17 @@ try_again:
 
 	extern int gbl_rcache;
 
-	if (gbl_rcache && pg == 1 && bfpool_pg == NULL &&
+	cached_pg = NULL;
+	depth = ncached = 0;
+	if (gbl_rcache && pg == 1 && !nocache &&
 	    lock_mode == DB_LOCK_READ && LF_ISSET(S_FIND)) {
 		save = 1;
-		if (rcache_find(
-		    dbp, &cached_pg, &bfpool_pg, &gen, &slot) == 0) {
+		if ((rlevels = rcache_levels()) > RCACHE_MAX_LEVELS)
+			rlevels = RCACHE_MAX_LEVELS;
+		if (rcache_find(dbp, pg, &cached_pg, &rpath[0].bfpool_pg,
+		    &rpath[0].gen, &rpath[0].slot) == 0) {
+			rpath[0].cached_pg = cached_pg;
+			ncached = 1;
 			h = cached_pg;
 			goto got_pg;
 		}
@@ -738,7 +747,25 @@ next:		if (recnop != NULL)
 			    LF_ISSET(S_WRITE) ? DB_LOCK_WRITE : DB_LOCK_READ;
 
 			if (cached_pg) {
-				/* Used rcache to get here. Don't lck couple. */
+				/*
+				 * Used rcache to get here.  Keep descending
+				 * through cached copies while the child is an
+				 * internal page within the cached levels;
+				 * otherwise lock the child, without lock
+				 * coupling, and validate the path below.
+				 */
+				if (!stack && lock_mode == DB_LOCK_READ &&
+				    depth + 1 < rlevels &&
+				    rcache_find(dbp, pg, &cached_pg,
+					&rpath[ncached].bfpool_pg,
+					&rpath[ncached].gen,
+					&rpath[ncached].slot) == 0) {
+					rpath[ncached].cached_pg = cached_pg;
+					++ncached;
+					++depth;
+					h = cached_pg;
+					continue;
+				}
 				if ((ret = __db_lget(dbc, 0, pg, lock_mode, 0,
 					    &lock)) != 0)
 					goto err;
@@ -770,9 +797,8 @@ next:		if (recnop != NULL)
 				 * Used rcache and failed getting child
 				 * page. Let's retry w/o rcache.
 				 */
-				cached_pg = NULL;
-
-				rcache_invalidate(slot);
+				rcache_invalidate(rpath[ncached - 1].slot);
+				nocache = 1;
 				__LPUT(dbc, lock);
 				goto try_again;
 			}
@@ -780,21 +806,40 @@ next:		if (recnop != NULL)
 		}
 
 		if (cached_pg) {
-			/* Used rcache and got child page. Validate rcache. */
-			DB_LSN *l1 = &LSN(cached_pg);
-			DB_LSN *l2 = &LSN(bfpool_pg);
+			/*
+			 * Used rcache and got child page.  Validate every
+			 * cached page on the path: if none changed since it
+			 * was copied, the path was current once we held the
+			 * lock on the child, so the child is the right page.
+			 */
 			cached_pg = NULL;
 
-			if (gen == GET_BH_GEN(bfpool_pg)
-			    && memcmp(l1, l2, sizeof(DB_LSN)) == 0 && gen == GET_BH_GEN(bfpool_pg)	//re-check. warm&fuzzy
-			    ) {
-				;
-			} else {
+			for (n = 0; n < ncached; ++n) {
+				DB_LSN *l1 = &LSN(rpath[n].cached_pg);
+				DB_LSN *l2 = &LSN(rpath[n].bfpool_pg);
+				uint16_t gen = rpath[n].gen;
+
+				if (gen != GET_BH_GEN(rpath[n].bfpool_pg)
+				    || memcmp(l1, l2, sizeof(DB_LSN)) != 0 || gen != GET_BH_GEN(rpath[n].bfpool_pg)	//re-check. warm&fuzzy
+				    )
+					break;
+			}
+			if (n < ncached) {
 				__memp_fput(mpf, h, 0);
 				__LPUT(dbc, lock);
-				rcache_invalidate(slot);
+				rcache_invalidate(rpath[n].slot);
+				nocache = 1;
 				goto try_again;
 			}
+			ncached = 0;
+		}
+
+		if (save && ++depth < rlevels && TYPE(h) == P_IBTREE &&
+		    lock_mode == DB_LOCK_READ) {
+			uint16_t gen = LSN(h).file + LSN(h).offset;
+
+			GET_BH_GEN(h) = gen;
+			rcache_save(dbp, h, gen);
 		}
 	}
 	/* NOTREACHED */
@@ -678,6 +678,7 @@ struct __db_log_cursor {
 };
 
 /* Log statistics structure. */
+#define	DB_LOG_GROUP_HIST	12	/* Buckets in the group commit histograms. */
 struct __db_log_stat {
 	u_int32_t st_magic;		/* Log file magic number. */
 	u_int32_t st_version;		/* Log file version number. */
@@ -713,6 +714,11 @@ struct __db_log_stat {
 	u_int32_t st_ondisk_get;	/* On-disk log_get. */
 	u_int32_t st_inmem_trav;	/* Mem-log steps for partial reads. */
 	u_int32_t st_wrap_copy;		/* Count of wrapped copies. */
+	u_int32_t st_group_waits;	/* Flushes held open to grow a group. */
+					/* Commits/flush, bucket i >= 1 << i. */
+	u_int32_t st_group_size[DB_LOG_GROUP_HIST];
+					/* Flush usecs, bucket i < 512 << i. */
+	u_int32_t st_group_usec[DB_LOG_GROUP_HIST];
 };
 
 /*******************************************************
@@ -2954,6 +2960,9 @@ int berkdb_verify_lsn_written_to_disk(DB_ENV *dbenv, DB_LSN *lsn,
 
 u_int32_t file_id_for_recovery_record(DB_ENV *env, DB_LSN *lsn,
 	int rectype, DBT *dbt);
+#define	RECOVERY_RECORD_MAX_PGNOS 4
+int pgnos_for_recovery_record(DB_ENV *env, int rectype, DBT *dbt,
+	db_pgno_t pgnos[RECOVERY_RECORD_MAX_PGNOS]);
 
 int __rep_get_master(DB_ENV *dbenv, char **master, u_int32_t *gen, u_int32_t *egen);
 int __rep_get_eid(DB_ENV *dbenv,char **eid);
@@ -403,6 +403,85 @@ file_id_for_recovery_record(DB_ENV *env, DB_LSN *lsn, int rectype, DBT *dbt)
 	return fileid;
 }
 
+/*
+ * Fill in pgnos with the pages of its file that a recovery record touches, and
+ * return how many there are, or -1 if we don't know.  Like the fileid above,
+ * the offsets come from the autogenerated read routines.  Only the record types
+ * that make up the bulk of a large transaction are handled; a replicant applies
+ * everything else in order with the rest of the file.
+ */
+int
+pgnos_for_recovery_record(DB_ENV *env, int rectype, DBT *dbt,
+    db_pgno_t pgnos[RECOVERY_RECORD_MAX_PGNOS])
+{
+	u_int8_t *bp;
+	int n = 0;
+
+#define	PGNO_AT(o)	do {						\
+	LOGCOPY_32(&pgnos[n], bp + (o));				\
+	if (pgnos[n] != PGNO_INVALID)					\
+		n++;							\
+} while (0)
+
+	/* All records begin with a type + txnid + prev_lsn. */
+	bp = (u_int8_t *)dbt->data +
+	    sizeof(u_int32_t) + sizeof(u_int32_t) + sizeof(DB_LSN);
+
+	switch (rectype) {
+	case DB___db_addrem:
+		/* opcode, fileid, pgno */
+		PGNO_AT(8);
+		break;
+	case DB___db_big:
+		/* opcode, fileid, pgno, prev_pgno, next_pgno */
+		PGNO_AT(8);
+		PGNO_AT(12);
+		PGNO_AT(16);
+		break;
+	case DB___db_relink:
+		/* opcode, fileid, pgno, lsn, prev, lsn_prev, next */
+		PGNO_AT(8);
+		PGNO_AT(20);
+		PGNO_AT(32);
+		break;
+	case DB___bam_adj:
+	case DB___bam_cadjust:
+	case DB___bam_cdel:
+	case DB___bam_repl:
+	case DB___bam_prefix:
+	case DB___db_ovref:
+		/* fileid, pgno */
+		PGNO_AT(4);
+		break;
+	case DB___bam_split:
+		/* fileid, left, llsn, right, rlsn, indx, npgno, nlsn, root_pgno */
+		PGNO_AT(4);
+		PGNO_AT(16);
+		PGNO_AT(32);
+		PGNO_AT(44);
+		break;
+	case DB___db_pg_alloc:
+		/* fileid, meta_lsn, meta_pgno, page_lsn, pgno */
+		PGNO_AT(12);
+		PGNO_AT(24);
+		/* Recovery also updates last_pgno on the base meta page. */
+		pgnos[n++] = PGNO_BASE_MD;
+		break;
+	case DB___db_pg_free:
+	case DB___db_pg_freedata:
+		/* fileid, pgno, meta_lsn, meta_pgno */
+		PGNO_AT(4);
+		PGNO_AT(16);
+		pgnos[n++] = PGNO_BASE_MD;
+		break;
+	default:
+		return (-1);
+	}
+#undef	PGNO_AT
+
+	return (n);
+}
+
 /*
  * __db_dispatch --
  *
@@ -468,6 +468,12 @@ __db_new(dbc, type, pagepp)
 		if (ret != meta->pagesize * page_extent_size)
 			goto err;
 
+		/* The extent bypassed the mpool, so tell the changed-page
+		 * tracker about it ourselves. */
+		if (!F_ISSET(mpf->mfp, MP_TEMP) && mpf->mfp->path_off != 0)
+			__memp_pgtrack_mark(__memp_fn(mpf), firstpage,
+			    page_extent_size);
+
 		/* Set the max page number known by the mpool.  This is
 		 * normally done by __memp_fget(..., DB_MPOOL_NEW).
 		 * We don't want these pages brought into the mpool, since they
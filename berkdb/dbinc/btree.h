@@ -311,6 +311,8 @@ struct __btree {			/* Btree access method. */
 	 * of its information.
 	 */
 	db_pgno_t bt_lpgno;		/* Last insert location. */
+	db_pgno_t bt_npgno;		/* Last mid-tree insert location. */
+	u_int32_t bt_nlocker;		/* Locker that made that insert. */
 
 	/*
 	 * !!!
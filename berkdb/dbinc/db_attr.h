@@ -29,6 +29,8 @@ BERK_DEF_ATTR(check_applied_lsns_fatal, "Abort if check_applied_lsns fails", BER
 BERK_DEF_ATTR(check_applied_lsns_debug, "Lots of verbose trace for debugging applied LSNs.", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_enabled, "Do scatter gather I/O", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_max, "Max scatter gather I/O to do at one time", BERK_ATTR_TYPE_INTEGER, 10 * MEGABYTE)
+BERK_DEF_ATTR(iouring_enabled, "Submit multi-page buffer pool writes through io_uring when the kernel supports it", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(iouring_depth, "Queue depth of the per-thread io_uring", BERK_ATTR_TYPE_INTEGER, 64)
 BERK_DEF_ATTR(btpf_enabled, "Enables index pages read ahead", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(btpf_wndw_min, "Minimum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 100 )
 BERK_DEF_ATTR(btpf_wndw_max, "Maximum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1000 )
@@ -59,9 +61,16 @@ BERK_DEF_ATTR(latch_max_poll, "Poll latch this many times before returning deadl
 BERK_DEF_ATTR(latch_timed_mutex, "Use a timed mutex", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(log_cursor_cache, "Cache log cursors", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(recovery_processor_poll_interval_us, "Recovery processor wakes this often to check workers", BERK_ATTR_TYPE_INTEGER, 1000)
+BERK_DEF_ATTR(rep_page_affinity, "Apply large transactions on replicants in parallel by page rather than by file", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(rep_page_affinity_min_records, "Apply transactions with at least this many log records by page", BERK_ATTR_TYPE_INTEGER, 10000)
+BERK_DEF_ATTR(rep_page_affinity_threads, "Number of threads applying a transaction by page", BERK_ATTR_TYPE_INTEGER, 8)
 BERK_DEF_ATTR(lsnerr_logflush, "Flush log on lsn error", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(tracked_locklist_init, "Initial allocation count for tracked locks", BERK_ATTR_TYPE_INTEGER, 10)
 /* This is a placeholder for now */
 BERK_DEF_ATTR(transient_page_reallocation, "Orphaned pages are maintained locally", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(elect_highest_committed_gen, "Bias election by the highest generation in the logfile", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(sync_standalone, "Force a log-sync at commit for standalone instances", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(log_group_commit, "Hold a commit flush open for an adaptive window so concurrent commits share one fsync", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(log_group_commit_pct, "Group commit window as a percentage of the average log fsync latency", BERK_ATTR_TYPE_INTEGER, 50)
+BERK_DEF_ATTR(log_group_commit_max_usec, "Upper bound in microseconds on the group commit window", BERK_ATTR_TYPE_INTEGER, 1000)
+BERK_DEF_ATTR(bt_near_insert, "Try the page of the last mid-tree insert by the same locker before searching from the root", BERK_ATTR_TYPE_BOOLEAN, 0)
@@ -295,6 +295,7 @@ typedef struct __db_locker {
 	u_int32_t flags;
 	u_int8_t has_pglk_lsn;
 	u_int8_t wstatus;  /* master locker waiting, for deadlock detection */
+	DB_LOCKOBJ *wait_obj;	/* object master is waiting on, if any */
 } DB_LOCKER;
 
 /*
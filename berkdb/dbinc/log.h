@@ -257,6 +257,8 @@ struct __log {
 	u_int32_t log_nsize;		/* Next log file's size. */
 
 	u_int32_t ncommit;		/* Number of txns waiting to commit. */
+	u_int32_t gc_fsync_usec;	/* Running average fsync latency. */
+	u_int32_t gc_group_x16;		/* Running average commits/flush, x16. */
 
 	DB_LSN	  t_lsn;		/* LSN of first commit */
 	SH_TAILQ_HEAD(__commit, __db_commit) commits;/* list of txns waiting to commit. */
@@ -97,6 +97,27 @@ struct __fileid_mpf {
 	LISTC_T(struct __mpoolfile) mpflist;
 };
 
+/*
+ * Buffer replacement policies, selected by gbl_mpool_policy.
+ *
+ * MPOOL_POLICY_LRU: every unpin moves the buffer to the head of the LRU.
+ *
+ * MPOOL_POLICY_2Q: a buffer's first unpin places it in the "old" portion of
+ * the LRU, MPOOL_2Q_OLD_PCT percent of the cache from the tail.  It only
+ * gets an ordinary (hot) priority if it is referenced again after more than
+ * 1/MPOOL_2Q_CORRELATED of the cache has been unpinned since, so the repeated
+ * gets a cursor does on one page during a scan don't count.  A table scan
+ * therefore cycles through the old buffers and leaves the hot set alone.
+ *
+ * Keep these in sync with the bufferpool_policy tunable.
+ */
+#define	MPOOL_POLICY_LRU	0
+#define	MPOOL_POLICY_2Q		1
+#define	MPOOL_POLICY_MAX	2
+
+#define	MPOOL_2Q_OLD_PCT	37
+#define	MPOOL_2Q_CORRELATED	64
+
 /*
  * MPOOL --
  *	Shared memory pool region.
@@ -171,6 +192,16 @@ struct __mpool {
 	 * know that none exist.
 	 */
 	DB_LSN	  trickle_lsn;		/* Maximum checkpoint LSN. */
+
+	/*
+	 * Replacement policy statistics, indexed by the policy that was in
+	 * effect at the time.  Not thread protected, like the stat fields.
+	 */
+	u_int64_t policy_hit[MPOOL_POLICY_MAX];	/* Buffer found in cache. */
+	u_int64_t policy_evict[MPOOL_POLICY_MAX];/* Buffer evicted. */
+	u_int64_t q_old_hit;		/* 2Q: hits on old buffers. */
+	u_int64_t q_old_evict;		/* 2Q: evictions of old buffers. */
+	u_int64_t q_promote;		/* 2Q: old buffers made hot. */
 };
 
 typedef SH_TAILQ_HEAD(HashTab, __bh) HashTab;
@@ -310,10 +341,13 @@ struct __bh {
 #define	BH_TRASH	0x020		/* Page is garbage. */
 #define BH_NOINCR	0x040		/* Don't increment lru_cache. */
 #define BH_PREFAULT	0x080		/* prefault pages */
+#define	BH_OLD		0x100		/* 2Q: in the old portion of the LRU. */
+#define	BH_HOT		0x200		/* 2Q: promoted out of the old portion. */
 	u_int16_t	flags;
 	u_int16_t	generation;	/* This changes before page changes */
 	u_int32_t	priority;	/* LRU priority. */
 	u_int32_t	fget_count;	/* Number memp_fgets. */
+	u_int32_t	first_put;	/* 2Q: lru_count when made old. */
 	SH_TAILQ_ENTRY(__bh) hq;	/* MPOOL hash bucket queue. */
 
 	db_pgno_t pgno;			/* Underlying MPOOLFILE page number. */
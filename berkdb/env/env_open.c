@@ -460,6 +460,10 @@ __dbenv_open(dbenv, db_home, flags, mode)
 		if ((ret = __checkpoint_open(dbenv, db_home)) != 0)
 			goto err;
 
+		/* Pick up changed-page maps before recovery writes pages. */
+		if ((ret = __memp_pgtrack_open(dbenv, db_home)) != 0)
+			goto err;
+
 		/* Perform recovery for any previous run. */
 		if (LF_ISSET(DB_RECOVER | DB_RECOVER_FATAL)) {
 			extern int gbl_recovery_lsn_file, gbl_recovery_lsn_offset, 
@@ -1005,6 +1009,9 @@ __dbenv_refresh(dbenv, orig_flags, rep_check)
 			if ((t_ret = __memp_dbenv_refresh(dbenv)) != 0 &&
 			    ret == 0)
 				ret = t_ret;
+
+			/* Nothing is written after this; save page maps. */
+			(void)__memp_pgtrack_close(dbenv);
 		}
 	}
 
@@ -71,6 +71,7 @@ extern int gbl_page_latches;
 extern int gbl_replicant_latches;
 extern int gbl_print_deadlock_cycles;
 extern int gbl_lock_conflict_trace;
+extern int gbl_deadlock_detect_local;
 
 int gbl_berkdb_track_locks = 0;
 unsigned gbl_ddlk = 0;
@@ -2708,7 +2709,12 @@ upgrade:
 			}
 		}
 
-		region->need_dd = 1;
+		/*
+		 * With local detection the waits-for search below decides
+		 * whether the full detector needs to run at all.
+		 */
+		if (!gbl_deadlock_detect_local)
+			region->need_dd = 1;
 
 		/*
 		 * First check to see if this txn has expired.
@@ -2754,11 +2760,15 @@ upgrade:
 			region->next_timeout = sh_locker->lk_expire;
 
 		/* set waiting status for master_locker */
-		if (sh_locker->master_locker == INVALID_ROFF)
+		if (sh_locker->master_locker == INVALID_ROFF) {
+			sh_locker->wait_obj = sh_obj;
 			sh_locker->wstatus = 1;
-		else
-			((DB_LOCKER *)R_ADDR(&lt->reginfo,
-				sh_locker->master_locker))->wstatus = 1;
+		} else {
+			DB_LOCKER *mlockerp = (DB_LOCKER *)R_ADDR(&lt->reginfo,
+			    sh_locker->master_locker);
+			mlockerp->wait_obj = sh_obj;
+			mlockerp->wstatus = 1;
+		}
 
 		unlock_locker_partition(region, lpartition);
 
@@ -2814,8 +2824,12 @@ upgrade:
 		 * We are about to wait; before waiting, see if the deadlock
 		 * detector should be run.
 		 */
-		if (region->detect != DB_LOCK_NORUN && !no_dd)
+		if (region->detect != DB_LOCK_NORUN && !no_dd &&
+		    (!gbl_deadlock_detect_local ||
+			__lock_detect_local(dbenv, sh_locker, sh_obj))) {
+			region->need_dd = 1;
 			__lock_detect(dbenv, region->detect, NULL);
+		}
 
 		if (gbl_bb_berkdb_enable_lock_timing) {
 			x1 = bb_berkdb_fasttime();
@@ -2920,11 +2934,15 @@ expired:			obj_ndx = sh_obj->index;
 
 
 	/* clear waiting status for master_locker */
-	if (sh_locker->master_locker == INVALID_ROFF)
+	if (sh_locker->master_locker == INVALID_ROFF) {
 		sh_locker->wstatus = 0;
-	else
-		((DB_LOCKER *)R_ADDR(&lt->reginfo,
-			sh_locker->master_locker))->wstatus = 0;
+		sh_locker->wait_obj = NULL;
+	} else {
+		DB_LOCKER *mlockerp = (DB_LOCKER *)R_ADDR(&lt->reginfo,
+		    sh_locker->master_locker);
+		mlockerp->wstatus = 0;
+		mlockerp->wait_obj = NULL;
+	}
 
 	if (is_pagelock(sh_obj))
 		sh_locker->npagelocks++;
@@ -4062,6 +4080,7 @@ __lock_getlocker_int(lt, locker, indx, partition, create, prop, retp,
 		sh_locker->nhandlelocks = 0;
 		sh_locker->nwrites = 0;
 		sh_locker->has_waiters = 0;
+		sh_locker->wait_obj = NULL;
 		sh_locker->priority = prop ? prop->priority : 0;
 		sh_locker->num_retries = prop ? prop->retries : 0;
 		if (prop && prop->flags & DB_LOCK_ID_LOWPRI)
@@ -33,6 +33,7 @@ static const char revid[] = "$Id: lock_deadlock.c,v 11.66 2003/11/19 19:59:02 ub
 #include "debug_switches.h"
 #include "logmsg.h"
 #include "locks_wrap.h"
+#include "comdb2_atomic.h"
 
 extern int verbose_deadlocks;
 extern int gbl_sparse_lockerid_map;
@@ -460,6 +461,128 @@ __dd_print_tracked(idmap, deadmap, nlockers, victim)
 
 uint64_t detect_skip = 0;
 uint64_t detect_run = 0;
+uint64_t detect_usecs = 0;
+uint64_t detect_max_usecs = 0;
+uint64_t detect_local_run = 0;
+uint64_t detect_local_clear = 0;
+uint64_t detect_victim_killme = 0;
+uint64_t detect_victim_keeper = 0;
+
+int gbl_deadlock_detect_local = 0;
+int gbl_deadlock_detect_local_max = 128;
+
+/* The search runs on the blocking thread's stack; keep it bounded. */
+#define	DD_LOCAL_MAXSEEN	1024
+
+#define DD_MASTER(lt, lockerp)						\
+	((lockerp)->master_locker == INVALID_ROFF ? (lockerp) :		\
+	    (DB_LOCKER *)R_ADDR(&(lt)->reginfo, (lockerp)->master_locker))
+
+/*
+ * __lock_detect_local --
+ *	Walk the waits-for graph outward from a locker which is about to
+ *	block on sh_obj.  Returns 0 if no cycle can pass through the locker,
+ *	or 1 if there may be one and the full detector has to run.  Called
+ *	with no lock table partitions held.
+ *
+ *	Only the locker closing a cycle needs to find it: every locker
+ *	publishes its wait_obj before searching, so of any set of lockers
+ *	that block concurrently the last one sees all the others.
+ *
+ * PUBLIC: int __lock_detect_local __P((DB_ENV *, DB_LOCKER *, DB_LOCKOBJ *));
+ */
+int
+__lock_detect_local(dbenv, sh_locker, sh_obj)
+	DB_ENV *dbenv;
+	DB_LOCKER *sh_locker;
+	DB_LOCKOBJ *sh_obj;
+{
+	struct __db_lock *lp;
+	DB_LOCKER *holder, *lockerp, *self, *seen[DD_LOCAL_MAXSEEN];
+	DB_LOCKOBJ *op;
+	DB_LOCKREGION *region;
+	DB_LOCKTAB *lt;
+	u_int32_t partition;
+	int found, i, max, next, nseen;
+
+	lt = dbenv->lk_handle;
+	region = lt->reginfo.primary;
+
+	/* Also orders our wait_obj store before the loads below. */
+	ATOMIC_ADD64(detect_local_run, 1);
+
+	/* Lock timeouts are only serviced by the full detector. */
+	if (LOCK_TIME_ISVALID(&region->next_timeout))
+		return (1);
+
+	if ((max = gbl_deadlock_detect_local_max) <= 0)
+		return (1);
+	if (max > DD_LOCAL_MAXSEEN)
+		max = DD_LOCAL_MAXSEEN;
+
+	self = DD_MASTER(lt, sh_locker);
+	seen[0] = self;
+	nseen = 1;
+
+	for (next = 0; next < nseen; next++) {
+		lockerp = seen[next];
+		op = (next == 0) ? sh_obj : lockerp->wait_obj;
+		if (op == NULL)
+			continue;
+
+		partition = op->partition;
+		if (partition >= gbl_lk_parts)
+			return (1);
+		lock_obj_partition(region, partition);
+		if (partition != op->partition) {
+			unlock_obj_partition(region, partition);
+			return (1);
+		}
+
+		/* Make sure the locker is still waiting on this object. */
+		found = 0;
+		for (lp = SH_TAILQ_FIRST(&op->waiters, __db_lock);
+		    lp != NULL; lp = SH_TAILQ_NEXT(lp, links, __db_lock)) {
+			if (lp->status == DB_LSTAT_WAITING &&
+			    lp->holderp != NULL &&
+			    DD_MASTER(lt, lp->holderp) == lockerp) {
+				found = 1;
+				break;
+			}
+		}
+		if (!found) {
+			unlock_obj_partition(region, partition);
+			continue;
+		}
+
+		/* Same edges as __dd_build: waiters wait on held locks only. */
+		for (lp = SH_TAILQ_FIRST(&op->holders, __db_lock);
+		    lp != NULL; lp = SH_TAILQ_NEXT(lp, links, __db_lock)) {
+			if (lp->status != DB_LSTAT_HELD)
+				continue;
+			holder = DD_MASTER(lt, lp->holderp);
+			if (holder == self) {
+				unlock_obj_partition(region, partition);
+				return (1);
+			}
+			if (holder->wait_obj == NULL)
+				continue;
+			for (i = 0; i < nseen && seen[i] != holder; i++)
+				;
+			if (i < nseen)
+				continue;
+			if (nseen == max) {
+				unlock_obj_partition(region, partition);
+				return (1);
+			}
+			seen[nseen++] = holder;
+		}
+		unlock_obj_partition(region, partition);
+	}
+
+	ATOMIC_ADD64(detect_local_clear, 1);
+	return (0);
+}
 
 #define LOCK_DETECT_Q 1
 
@@ -505,9 +628,15 @@ __lock_detect(dbenv, atype, abortp)
 		q = 0;
 		Pthread_mutex_unlock(&qlock);
 		int retry = 0;
+		uint64_t start, usecs;
+		start = bb_berkdb_fasttime();
 		ret = __lock_detect_int(dbenv, atype, abortp, &retry);
 		if (retry)
 			ret = __lock_detect_int(dbenv, atype, abortp, NULL);
+		usecs = bb_berkdb_fasttime() - start;
+		detect_usecs += usecs;
+		if (usecs > detect_max_usecs)
+			detect_max_usecs = usecs;
 	}
 	Pthread_mutex_unlock(&dlock);
 	return ret;
@@ -704,6 +833,7 @@ __lock_detect_int(dbenv, atype, abortp, can_retry)
 				logmsg(LOGMSG_USER, "killid %d has killme set, killing it.\n",
 				    killid);
 			}
+			++detect_victim_killme;
 			goto dokill;
 		}
 
@@ -723,6 +853,7 @@ __lock_detect_int(dbenv, atype, abortp, can_retry)
 			if (idmap[i].killme) {
 				keeper = killid;
 				killid = i;
+				++detect_victim_killme;
 
 				goto dokill;
 			}
@@ -842,6 +973,7 @@ dokill:
 			UNLOCKREGION(dbenv, lt);
 
 			killid = keeper;
+			++detect_victim_keeper;
 		}
 
 		if (berkdb_deadlock_callback) {
@@ -44,6 +44,7 @@ static const char revid[] = "$Id: log_put.c,v 11.145 2003/09/13 19:20:39 bostic
 
 #include "logmsg.h"
 #include <locks_wrap.h>
+#include <epochlib.h>
 #include <poll.h>
 
 extern unsigned long long get_commit_context(const void *, uint32_t generation);
@@ -1288,6 +1289,42 @@ __log_lwr_lsn(dblp)
 	}
 }
 
+/*
+ * __log_group_window --
+ *	Return how many usecs a commit flush should stay open so that other
+ *	committers can join its fsync.  Nothing is held open unless commits
+ *	are already arriving faster than one per fsync; the window is then a
+ *	fraction of the running average fsync latency.
+ */
+static u_int32_t
+__log_group_window(dbenv, lp)
+	DB_ENV *dbenv;
+	LOG *lp;
+{
+	u_int64_t window;
+
+	/* Fewer than 1.5 commits per flush and nobody queued: don't wait. */
+	if (lp->ncommit == 0 && lp->gc_group_x16 < 24)
+		return (0);
+
+	window = (u_int64_t)lp->gc_fsync_usec *
+	    dbenv->attr.log_group_commit_pct / 100;
+	if (window > (u_int64_t)dbenv->attr.log_group_commit_max_usec)
+		window = dbenv->attr.log_group_commit_max_usec;
+	return ((u_int32_t)window);
+}
+
+static inline int
+__log_group_bucket(v)
+	u_int64_t v;
+{
+	int b;
+
+	for (b = 0; v > 1 && b < DB_LOG_GROUP_HIST - 1; ++b)
+		v >>= 1;
+	return (b);
+}
+
 /*
  * __log_flush_int --
  *	Write all records less than or equal to the specified LSN; internal
@@ -1310,7 +1347,8 @@ __log_flush_int(dblp, lsnp, release)
 	DB_LSN flush_lsn, f_lsn, s_lsn;
 	DB_MUTEX *flush_mutexp;
 	LOG *lp;
-	u_int32_t ncommit, w_off, listcnt;
+	u_int32_t ncommit, w_off, listcnt, window, waited, slice, target;
+	u_int64_t group_start, fsync_start, fsync_usec;
 	int do_flush, first, ret, wrote_inmem;
 
 	dbenv = dblp->dbenv;
@@ -1318,6 +1356,7 @@ __log_flush_int(dblp, lsnp, release)
 	flush_mutexp = R_ADDR(&dblp->reginfo, lp->flush_mutex_off);
 	ncommit = 0;
 	ret = 0;
+	group_start = fsync_start = 0;
 
 	/*
 	 * If no LSN specified, flush the entire log by setting the flush LSN
@@ -1448,6 +1487,30 @@ __log_flush_int(dblp, lsnp, release)
 			return (0);
 	}
 
+	/*
+	 * Group commit: this thread is about to lead a flush.  If commits are
+	 * arriving concurrently, advertise a flush in progress so they queue
+	 * behind us, and give them a short window to arrive before we sync.
+	 * Stop early once one more than the usual group has queued up.
+	 */
+	group_start = comdb2_time_epochus();
+	if (release && dbenv->attr.log_group_commit &&
+	    (window = __log_group_window(dbenv, lp)) != 0) {
+		target = (lp->gc_group_x16 + 15) / 16 + 1;
+		slice = window < 200 ? window : window / 4;
+		lp->in_flush++;
+		R_UNLOCK(dbenv, &dblp->reginfo);
+		for (waited = 0;
+		    waited < window && lp->ncommit + 1 < target;
+		    waited += slice)
+			(void)__os_sleep(dbenv, 0, slice);
+		R_LOCK(dbenv, &dblp->reginfo);
+		lp->in_flush--;
+		if (log_compare(&flush_lsn, &lp->t_lsn) < 0)
+			flush_lsn = lp->t_lsn;
+		++lp->stat.st_group_waits;
+	}
+
 	/*
 	 * Protect flushing with its own mutex so we can release
 	 * the region lock except during file switches.
@@ -1538,6 +1601,7 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 		R_UNLOCK(dbenv, &dblp->reginfo);
 
 	/* Sync all writes to disk. */
+	fsync_start = comdb2_time_epochus();
 	if ((ret = __os_fsync(dbenv, dblp->lfhp)) != 0) {
 		MUTEX_UNLOCK(dbenv, flush_mutexp);
 		if (release)
@@ -1545,6 +1609,7 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 		ret = __db_panic(dbenv, ret);
 		return (ret);
 	}
+	fsync_usec = comdb2_time_epochus() - fsync_start;
 
 	/*
 	 * Set the last-synced LSN.
@@ -1571,6 +1636,12 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 	lp->in_flush--;
 	++lp->stat.st_scount;
 
+	lp->gc_fsync_usec = lp->gc_fsync_usec - lp->gc_fsync_usec / 8 +
+	    (u_int32_t)(fsync_usec / 8);
+	if (group_start != 0)
+		++lp->stat.st_group_usec[__log_group_bucket(
+		    (comdb2_time_epochus() - group_start) >> 8)];
+
 	/*
 	 * How many flush calls (usually commits) did this call actually sync?
 	 * At least one, if it got here.
@@ -1650,6 +1721,11 @@ done:	listcnt = 0;
 			}
 		}
 	}
+	if (fsync_start != 0 && ncommit != 0) {
+		++lp->stat.st_group_size[__log_group_bucket(ncommit)];
+		lp->gc_group_x16 = lp->gc_group_x16 - lp->gc_group_x16 / 8 +
+		    ncommit * 2;
+	}
 	if (lp->stat.st_maxcommitperflush < ncommit)
 		lp->stat.st_maxcommitperflush = ncommit;
 	if (lp->stat.st_mincommitperflush > ncommit ||
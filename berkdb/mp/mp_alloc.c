@@ -41,6 +41,11 @@ typedef struct {
 
 static void __memp_bad_buffer __P((DB_MPOOL_HASH *));
 
+/* Buffer replacement policy, see MPOOL_POLICY_* in mp.h. */
+int gbl_mpool_policy = MPOOL_POLICY_LRU;
+
+static const char *mpool_policy_names[MPOOL_POLICY_MAX] = { "LRU", "2Q" };
+
 // PUBLIC: int __memp_dump_bufferpool_info __P((DB_ENV *, FILE *));
 int
 __memp_dump_bufferpool_info(dbenv, f)
@@ -53,7 +58,7 @@ __memp_dump_bufferpool_info(dbenv, f)
 	REGINFO *memreg;
 	MPOOL *mp, *c_mp;
 	DB_MPOOL *dbmp;
-	int count, n_cache;
+	int count, i, n_cache;
 	u_int64_t bufcnt;
 
 	dbmp = dbenv->mp_handle;
@@ -101,8 +106,18 @@ __memp_dump_bufferpool_info(dbenv, f)
 			MUTEX_UNLOCK(dbenv, mutexp);
 		}
 		logmsgf(LOGMSG_USER, f, "LRU_COUNT = %d\n", c_mp->lru_count);
+		for (i = 0; i < MPOOL_POLICY_MAX; i++)
+			logmsgf(LOGMSG_USER, f,
+			    "%s HITS = %"PRIu64" EVICTIONS = %"PRIu64"\n",
+			    mpool_policy_names[i], c_mp->policy_hit[i],
+			    c_mp->policy_evict[i]);
+		logmsgf(LOGMSG_USER, f, "2Q OLD HITS = %"PRIu64
+		    " OLD EVICTIONS = %"PRIu64" PROMOTIONS = %"PRIu64"\n",
+		    c_mp->q_old_hit, c_mp->q_old_evict, c_mp->q_promote);
 		logmsgf(LOGMSG_USER, f, "\n");
 	}
+	logmsgf(LOGMSG_USER, f, "POLICY = %s\n",
+	    mpool_policy_names[gbl_mpool_policy]);
 	logmsgf(LOGMSG_USER, f, "BUFCNT = %"PRIu64"\n", bufcnt);
 	return 0;
 }
@@ -306,7 +321,9 @@ __memp_alloc_flags(dbmp, memreg, mfp, len, offsetp, flags, retp)
 	 * First we try to allocate from free memory.  If that fails, scan the
 	 * buffer pool to find buffers with low priorities.  We consider small
 	 * sets of hash buckets each time to limit the amount of work needing
-	 * to be done.  This approximates LRU, but not very well.  We either
+	 * to be done.  This approximates LRU, but not very well.  (Under the
+	 * 2Q policy, __memp_fput gives buffers that have only been used once
+	 * a low priority, so they are found here first.)  We either
 	 * find a buffer of the same size to use, or we will free 3 times what
 	 * we need in the hopes it will coalesce into a contiguous chunk of the
 	 * right size.  In the latter case we branch back here and try again.
@@ -546,6 +563,11 @@ found:		if (offsetp != NULL)
 			goto next_hb;
 		}
 
+		++c_mp->policy_evict[gbl_mpool_policy];
+		if (gbl_mpool_policy == MPOOL_POLICY_2Q &&
+		    F_ISSET(bhp, BH_OLD))
+			++c_mp->q_old_evict;
+
 		/*
 		 * Check to see if the buffer is the size we're looking for.
 		 * If so, we can simply reuse it.  Else, free the buffer and
@@ -1019,6 +1019,10 @@ __memp_pgwrite_multi(dbenv, dbmfp, hps, bhps, numpages, wrrec)
 	if (0 == idx || 1 == idx)
 		__os_fsync(dbenv, dbmfp->fhp);
 
+	/* Remember the pages for the next incremental backup. */
+	if (!F_ISSET(mfp, MP_TEMP) && mfp->path_off != 0)
+		__memp_pgtrack_mark(__memp_fn(dbmfp), bhps[0]->pgno, numpages);
+
 	mfp->file_written = 1;
 	mfp->stat.st_page_out += numpages;
 	mfp->stat.st_rw_merges += numpages - 1;
@@ -50,6 +50,7 @@ struct bdb_state_tag;
 typedef struct bdb_state_tag bdb_state_type;
 
 extern int gbl_prefault_udp;
+extern int gbl_mpool_policy;
 extern __thread int send_prefault_udp;
 extern __thread DB *prefault_dbp;
 
@@ -397,6 +398,10 @@ retry:	st_hsearch = 0;
 			++mfp->stat.st_cache_lhit;
 
 		++mfp->stat.st_cache_hit;
+		++c_mp->policy_hit[gbl_mpool_policy];
+		if (gbl_mpool_policy == MPOOL_POLICY_2Q &&
+		    F_ISSET(bhp, BH_OLD))
+			++c_mp->q_old_hit;
 
         if (LF_ISSET(DB_MPOOL_PFGET))
             ++c_mp->stat.st_page_pf_in_late;
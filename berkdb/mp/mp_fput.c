@@ -25,7 +25,9 @@ static const char revid[] = "$Id: mp_fput.c,v 11.48 2003/09/30 17:12:00 sue Exp
 #include "comdb2_atomic.h"
 
 extern int gbl_enable_cache_internal_nodes;
+extern int gbl_mpool_policy;
 
+static void __memp_2q_put __P((MPOOL *, BH *));
 static void __memp_reset_lru __P((DB_ENV *, REGINFO *));
 
 /*
@@ -228,6 +230,8 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 		 * only means a buffer has the wrong priority.
 		 */
 		bhp->priority = c_mp->lru_count;
+		if (gbl_mpool_policy == MPOOL_POLICY_2Q)
+			__memp_2q_put(c_mp, bhp);
 
 		adjust = 0;
 		if (dbmfp->mfp->priority != 0)
@@ -341,6 +345,38 @@ __memp_fput_pageorder(dbmfp, pgaddr, flags)
 }
 
 
+/*
+ * __memp_2q_put --
+ *	Set the base priority of a buffer being unpinned under the 2Q policy.
+ *	Buffers stay in the old portion of the LRU until they are referenced
+ *	again outside of the correlated reference period.
+ */
+static void
+__memp_2q_put(c_mp, bhp)
+	MPOOL *c_mp;
+	BH *bhp;
+{
+	u_int32_t old;
+
+	if (F_ISSET(bhp, BH_HOT))
+		return;
+
+	if (!F_ISSET(bhp, BH_OLD)) {
+		F_SET(bhp, BH_OLD);
+		bhp->first_put = c_mp->lru_count;
+	} else if (c_mp->lru_count - bhp->first_put >
+	    c_mp->stat.st_pages / MPOOL_2Q_CORRELATED) {
+		F_CLR(bhp, BH_OLD);
+		F_SET(bhp, BH_HOT);
+		++c_mp->q_promote;
+		return;
+	}
+
+	old = (u_int32_t)(((u_int64_t)c_mp->stat.st_pages *
+	    MPOOL_2Q_OLD_PCT) / 100);
+	bhp->priority = c_mp->lru_count > old ? c_mp->lru_count - old : 0;
+}
+
 /*
  * __memp_reset_lru --
  *	Reset the cache LRU counter.
@@ -377,10 +413,15 @@ __memp_reset_lru(dbenv, memreg)
 
 		MUTEX_LOCK(dbenv, &hp->hash_mutex);
 		for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
-		    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh))
+		    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
 			if (bhp->priority != UINT32_T_MAX &&
 			    bhp->priority > MPOOL_BASE_DECREMENT)
 				bhp->priority -= MPOOL_BASE_DECREMENT;
+			if (bhp->first_put > MPOOL_BASE_DECREMENT)
+				bhp->first_put -= MPOOL_BASE_DECREMENT;
+			else
+				bhp->first_put = 0;
+		}
 		MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
 	}
 }
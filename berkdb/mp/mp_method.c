@@ -440,6 +440,10 @@ fsop:
 	}
 
 
+	__memp_pgtrack_forget(fullold);
+	if (newname != NULL)
+		__memp_pgtrack_forget(fullnew);
+
 	if (newname == NULL) {
 		ret = __os_unlink(dbenv, fullold);
 		if (recp_old_path)
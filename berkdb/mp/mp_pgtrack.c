@@ -0,0 +1,551 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Changed-page tracking for incremental backups.
+ *
+ * Every page the buffer pool writes is marked in a bitmap for its file.  A
+ * backup rotates the bitmaps when it starts, copies just the pages they mark
+ * and acknowledges the rotation when it is done, which drops the pages it
+ * copied.  Each file keeps two maps: "pend" holds writes from before the last
+ * rotation that have not been acknowledged yet, "cur" holds writes since, so
+ * a backup that fails or races another one loses nothing.
+ *
+ * The maps are saved in the environment home on a clean close only.  The
+ * saved state is removed as soon as it is loaded, so after a crash tracking
+ * restarts without an acknowledged epoch and the next backup falls back to
+ * comparing every page.  An environment opened with tracking off removes it
+ * too: the pages that run writes are in no map.
+ */
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/db_shash.h"
+#include "dbinc/mp.h"
+
+#include "plhash.h"
+#include "logmsg.h"
+#include "locks_wrap.h"
+
+char *bdb_trans(const char infile[], char outfile[]);
+
+int gbl_pgtrack = 0;
+
+#define PGTRACK_MAGIC 0x50475452
+#define PGTRACK_VERSION 1
+
+struct pgtrack_file {
+	char *name;		/* basename, the hash key */
+	u_int32_t nwords;	/* words allocated in each map */
+	u_int64_t *pend;	/* written before the last rotation */
+	u_int64_t *cur;		/* written since the last rotation */
+	int pend_lost;		/* renamed or removed before the last rotation */
+	int cur_lost;		/* renamed or removed since */
+};
+
+struct pgtrack_hdr {
+	u_int32_t magic;
+	u_int32_t version;
+	u_int64_t epoch;
+	u_int64_t acked;
+	u_int32_t nfiles;
+	u_int32_t pad;
+};
+
+static struct {
+	pthread_mutex_t lk;
+	hash_t *files;
+	u_int64_t epoch;	/* bumped by each rotation */
+	u_int64_t acked;	/* maps cover writes since this rotation, 0 if
+				 * they cover nothing useful yet */
+	char path[PATH_MAX];
+	int open;
+} pgtrack = { PTHREAD_MUTEX_INITIALIZER };
+
+static const char *
+pgtrack_basename(name)
+	const char *name;
+{
+	const char *p;
+
+	return ((p = strrchr(name, '/')) == NULL ? name : p + 1);
+}
+
+static struct pgtrack_file *
+pgtrack_get(name)
+	const char *name;
+{
+	struct pgtrack_file *f;
+
+	name = pgtrack_basename(name);
+	if ((f = hash_find_readonly(pgtrack.files, &name)) != NULL)
+		return (f);
+	if ((f = calloc(1, sizeof(*f))) == NULL)
+		return (NULL);
+	if ((f->name = strdup(name)) == NULL) {
+		free(f);
+		return (NULL);
+	}
+	hash_add(pgtrack.files, f);
+	return (f);
+}
+
+static int
+pgtrack_grow(f, nwords)
+	struct pgtrack_file *f;
+	u_int32_t nwords;
+{
+	u_int64_t *pend, *cur;
+
+	if (nwords <= f->nwords)
+		return (0);
+	/* Grow geometrically, files are extended a page at a time. */
+	if (nwords < 2 * f->nwords)
+		nwords = 2 * f->nwords;
+	if ((pend = realloc(f->pend, nwords * sizeof(u_int64_t))) == NULL)
+		return (ENOMEM);
+	f->pend = pend;
+	if ((cur = realloc(f->cur, nwords * sizeof(u_int64_t))) == NULL)
+		return (ENOMEM);
+	f->cur = cur;
+	memset(f->pend + f->nwords, 0,
+	    (nwords - f->nwords) * sizeof(u_int64_t));
+	memset(f->cur + f->nwords, 0,
+	    (nwords - f->nwords) * sizeof(u_int64_t));
+	f->nwords = nwords;
+	return (0);
+}
+
+static int
+pgtrack_free_file(obj, arg)
+	void *obj;
+	void *arg;
+{
+	struct pgtrack_file *f = obj;
+
+	free(f->name);
+	free(f->pend);
+	free(f->cur);
+	free(f);
+	return (0);
+}
+
+static int
+pgtrack_load(fp)
+	FILE *fp;
+{
+	struct pgtrack_hdr hdr;
+	struct pgtrack_file *f;
+	u_int32_t i, len, nwords;
+	char name[PATH_MAX];
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    hdr.magic != PGTRACK_MAGIC || hdr.version != PGTRACK_VERSION)
+		return (EINVAL);
+
+	for (i = 0; i < hdr.nfiles; i++) {
+		if (fread(&len, sizeof(len), 1, fp) != 1 ||
+		    len == 0 || len >= sizeof(name) ||
+		    fread(name, len, 1, fp) != 1)
+			return (EINVAL);
+		name[len] = '\0';
+		if ((f = pgtrack_get(name)) == NULL)
+			return (ENOMEM);
+		if (fread(&f->pend_lost, sizeof(int), 1, fp) != 1 ||
+		    fread(&f->cur_lost, sizeof(int), 1, fp) != 1 ||
+		    fread(&nwords, sizeof(nwords), 1, fp) != 1)
+			return (EINVAL);
+		if (pgtrack_grow(f, nwords) != 0)
+			return (ENOMEM);
+		if (nwords != 0 &&
+		    (fread(f->pend, sizeof(u_int64_t), nwords, fp) != nwords ||
+		    fread(f->cur, sizeof(u_int64_t), nwords, fp) != nwords))
+			return (EINVAL);
+	}
+
+	pgtrack.epoch = hdr.epoch;
+	pgtrack.acked = hdr.acked;
+	return (0);
+}
+
+static int
+pgtrack_save_file(obj, arg)
+	void *obj;
+	void *arg;
+{
+	struct pgtrack_file *f = obj;
+	FILE *fp = arg;
+	u_int32_t len;
+
+	len = (u_int32_t)strlen(f->name);
+	fwrite(&len, sizeof(len), 1, fp);
+	fwrite(f->name, len, 1, fp);
+	fwrite(&f->pend_lost, sizeof(int), 1, fp);
+	fwrite(&f->cur_lost, sizeof(int), 1, fp);
+	fwrite(&f->nwords, sizeof(f->nwords), 1, fp);
+	fwrite(f->pend, sizeof(u_int64_t), f->nwords, fp);
+	fwrite(f->cur, sizeof(u_int64_t), f->nwords, fp);
+	return (0);
+}
+
+/*
+ * __memp_pgtrack_open --
+ *	Start tracking changed pages, picking up the state saved by the last
+ *	clean close in db_home if there is one.  With tracking off, just drop
+ *	any saved state.
+ *
+ * PUBLIC: int __memp_pgtrack_open __P((DB_ENV *, const char *));
+ */
+int
+__memp_pgtrack_open(dbenv, db_home)
+	DB_ENV *dbenv;
+	const char *db_home;
+{
+	FILE *fp;
+	char fname[PATH_MAX];
+	char path[PATH_MAX];
+	int ret;
+
+	if (!gbl_pgtrack) {
+		snprintf(fname, sizeof(fname), "%s/pgtrack", db_home);
+		if (unlink(bdb_trans(fname, path)) == 0)
+			logmsg(LOGMSG_INFO, "changed page tracking is off, "
+			    "removed %s\n", path);
+		return (0);
+	}
+
+	Pthread_mutex_lock(&pgtrack.lk);
+	if (pgtrack.open) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (0);
+	}
+	if ((pgtrack.files = hash_init_strptr(
+	    offsetof(struct pgtrack_file, name))) == NULL) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (ENOMEM);
+	}
+
+	snprintf(fname, sizeof(fname), "%s/pgtrack", db_home);
+	bdb_trans(fname, pgtrack.path);
+
+	if ((fp = fopen(pgtrack.path, "r")) != NULL) {
+		ret = pgtrack_load(fp);
+		fclose(fp);
+		if (ret != 0) {
+			__db_err(dbenv, "%s: ignoring changed page map: %s",
+			    pgtrack.path, db_strerror(ret));
+			hash_for(pgtrack.files, pgtrack_free_file, NULL);
+			hash_clear(pgtrack.files);
+			pgtrack.acked = 0;
+		}
+		/* Only a clean close may leave the maps behind. */
+		(void)unlink(pgtrack.path);
+	}
+
+	/*
+	 * Epochs keep rising across lost state so a backup can never
+	 * mistake a restarted map for the one it acknowledged.
+	 */
+	if (pgtrack.epoch < (u_int64_t)time(NULL))
+		pgtrack.epoch = (u_int64_t)time(NULL);
+
+	logmsg(LOGMSG_INFO, "changed page tracking: epoch %llu acked %llu\n",
+	    (unsigned long long)pgtrack.epoch,
+	    (unsigned long long)pgtrack.acked);
+	pgtrack.open = 1;
+	Pthread_mutex_unlock(&pgtrack.lk);
+	return (0);
+}
+
+/*
+ * __memp_pgtrack_close --
+ *	Stop tracking and save the maps so they survive the restart.  Called
+ *	after the buffer pool has been flushed.
+ *
+ * PUBLIC: int __memp_pgtrack_close __P((DB_ENV *));
+ */
+int
+__memp_pgtrack_close(dbenv)
+	DB_ENV *dbenv;
+{
+	struct pgtrack_hdr hdr;
+	FILE *fp;
+	char tmp[PATH_MAX];
+	int ret;
+
+	Pthread_mutex_lock(&pgtrack.lk);
+	if (!pgtrack.open) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (0);
+	}
+	pgtrack.open = 0;
+
+	ret = 0;
+	snprintf(tmp, sizeof(tmp), "%s.tmp", pgtrack.path);
+	if ((fp = fopen(tmp, "w")) == NULL) {
+		ret = errno;
+		goto done;
+	}
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = PGTRACK_MAGIC;
+	hdr.version = PGTRACK_VERSION;
+	hdr.epoch = pgtrack.epoch;
+	hdr.acked = pgtrack.acked;
+	hdr.nfiles = hash_get_num_entries(pgtrack.files);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	hash_for(pgtrack.files, pgtrack_save_file, fp);
+	if (fflush(fp) != 0 || ferror(fp) || fsync(fileno(fp)) != 0)
+		ret = errno ? errno : EIO;
+	if (fclose(fp) != 0 && ret == 0)
+		ret = errno;
+	if (ret == 0 && rename(tmp, pgtrack.path) != 0)
+		ret = errno;
+	if (ret != 0)
+		(void)unlink(tmp);
+
+done:	if (ret != 0)
+		__db_err(dbenv, "%s: cannot save changed page map: %s",
+		    pgtrack.path, db_strerror(ret));
+	hash_for(pgtrack.files, pgtrack_free_file, NULL);
+	hash_clear(pgtrack.files);
+	hash_free(pgtrack.files);
+	pgtrack.files = NULL;
+	Pthread_mutex_unlock(&pgtrack.lk);
+	return (ret);
+}
+
+/*
+ * __memp_pgtrack_mark --
+ *	Record that npages pages starting at pgno were written to a file.
+ *
+ * PUBLIC: void __memp_pgtrack_mark __P((const char *, db_pgno_t, int));
+ */
+void
+__memp_pgtrack_mark(name, pgno, npages)
+	const char *name;
+	db_pgno_t pgno;
+	int npages;
+{
+	struct pgtrack_file *f;
+	db_pgno_t last;
+
+	if (!pgtrack.open)
+		return;
+
+	last = pgno + npages - 1;
+	Pthread_mutex_lock(&pgtrack.lk);
+	if (!pgtrack.open) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return;
+	}
+	if ((f = pgtrack_get(name)) == NULL ||
+	    pgtrack_grow(f, last / 64 + 1) != 0) {
+		/* Can't remember the write, so don't vouch for the file. */
+		if (f != NULL)
+			f->cur_lost = 1;
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return;
+	}
+	for (; pgno <= last; pgno++)
+		f->cur[pgno / 64] |= 1ULL << (pgno % 64);
+	Pthread_mutex_unlock(&pgtrack.lk);
+}
+
+/*
+ * __memp_pgtrack_forget --
+ *	A file was renamed or removed: its pages can no longer be accounted
+ *	for by name until a backup has copied it whole.
+ *
+ * PUBLIC: void __memp_pgtrack_forget __P((const char *));
+ */
+void
+__memp_pgtrack_forget(name)
+	const char *name;
+{
+	struct pgtrack_file *f;
+
+	if (!pgtrack.open)
+		return;
+
+	Pthread_mutex_lock(&pgtrack.lk);
+	if (pgtrack.open && (f = pgtrack_get(name)) != NULL)
+		f->cur_lost = 1;
+	Pthread_mutex_unlock(&pgtrack.lk);
+}
+
+static int
+pgtrack_rotate_file(obj, arg)
+	void *obj;
+	void *arg;
+{
+	struct pgtrack_file *f = obj;
+	u_int32_t i;
+
+	for (i = 0; i < f->nwords; i++) {
+		f->pend[i] |= f->cur[i];
+		f->cur[i] = 0;
+	}
+	f->pend_lost |= f->cur_lost;
+	f->cur_lost = 0;
+	return (0);
+}
+
+/*
+ * __memp_pgtrack_rotate --
+ *	Start a new epoch for a backup that is about to begin.  Returns the new
+ *	epoch, which the backup acknowledges when it completes, and the epoch
+ *	the maps are valid since (0 if none).
+ *
+ * PUBLIC: int __memp_pgtrack_rotate __P((u_int64_t *, u_int64_t *));
+ */
+int
+__memp_pgtrack_rotate(epochp, ackedp)
+	u_int64_t *epochp, *ackedp;
+{
+	Pthread_mutex_lock(&pgtrack.lk);
+	if (!pgtrack.open) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (EINVAL);
+	}
+	hash_for(pgtrack.files, pgtrack_rotate_file, NULL);
+	*epochp = ++pgtrack.epoch;
+	*ackedp = pgtrack.acked;
+	Pthread_mutex_unlock(&pgtrack.lk);
+	return (0);
+}
+
+static int
+pgtrack_ack_file(obj, arg)
+	void *obj;
+	void *arg;
+{
+	struct pgtrack_file *f = obj;
+	u_int32_t i;
+
+	if (f->nwords != 0)
+		memset(f->pend, 0, f->nwords * sizeof(u_int64_t));
+	f->pend_lost = 0;
+
+	/* Drop files that haven't been touched since, removed ones included. */
+	if (f->cur_lost)
+		return (0);
+	for (i = 0; i < f->nwords; i++) {
+		if (f->cur[i] != 0)
+			return (0);
+	}
+	hash_del(pgtrack.files, f);
+	pgtrack_free_file(f, NULL);
+	return (0);
+}
+
+/*
+ * __memp_pgtrack_ack --
+ *	A backup started at epoch has completed: forget the pages written
+ *	before it.  Fails if another backup has rotated since.
+ *
+ * PUBLIC: int __memp_pgtrack_ack __P((u_int64_t));
+ */
+int
+__memp_pgtrack_ack(epoch)
+	u_int64_t epoch;
+{
+	Pthread_mutex_lock(&pgtrack.lk);
+	if (!pgtrack.open || epoch != pgtrack.epoch) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (EINVAL);
+	}
+	hash_for(pgtrack.files, pgtrack_ack_file, NULL);
+	pgtrack.acked = epoch;
+	Pthread_mutex_unlock(&pgtrack.lk);
+	return (0);
+}
+
+/*
+ * __memp_pgtrack_pages --
+ *	Collect the pages of a file written since the acknowledged epoch, in
+ *	ascending order, into a malloc'd array.  Returns ENOENT if they can't
+ *	be accounted for.
+ *
+ * PUBLIC: int __memp_pgtrack_pages
+ * PUBLIC:     __P((const char *, db_pgno_t **, u_int32_t *));
+ */
+int
+__memp_pgtrack_pages(name, pgnosp, npgnosp)
+	const char *name;
+	db_pgno_t **pgnosp;
+	u_int32_t *npgnosp;
+{
+	struct pgtrack_file *f;
+	db_pgno_t *pgnos;
+	u_int64_t word;
+	u_int32_t i, n, alloc;
+
+	*pgnosp = NULL;
+	*npgnosp = 0;
+
+	Pthread_mutex_lock(&pgtrack.lk);
+	if (!pgtrack.open || pgtrack.acked == 0) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (ENOENT);
+	}
+	name = pgtrack_basename(name);
+	if ((f = hash_find_readonly(pgtrack.files, &name)) == NULL) {
+		/* Not written since the acknowledged epoch. */
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (0);
+	}
+	if (f->pend_lost || f->cur_lost) {
+		Pthread_mutex_unlock(&pgtrack.lk);
+		return (ENOENT);
+	}
+
+	pgnos = NULL;
+	n = alloc = 0;
+	for (i = 0; i < f->nwords; i++) {
+		word = f->pend[i] | f->cur[i];
+		while (word != 0) {
+			if (n == alloc) {
+				alloc = alloc ? 2 * alloc : 64;
+				if ((*pgnosp = realloc(pgnos,
+				    alloc * sizeof(db_pgno_t))) == NULL) {
+					free(pgnos);
+					Pthread_mutex_unlock(&pgtrack.lk);
+					return (ENOMEM);
+				}
+				pgnos = *pgnosp;
+			}
+			pgnos[n++] = i * 64 + __builtin_ctzll(word);
+			word &= word - 1;
+		}
+	}
+	Pthread_mutex_unlock(&pgtrack.lk);
+
+	*pgnosp = pgnos;
+	*npgnosp = n;
+	return (0);
+}
@@ -813,6 +813,42 @@ __berkdb_direct_pwritev(DB_ENV *dbenv,
 }
 #endif
 
+/*
+ * Account a vectored write that started at x1 in the pwrite stats, and
+ * complain if it took longer than the write alarm.
+ */
+static void
+__os_iov_write_stats(fhp, nbytes, x1, how)
+	DB_FH *fhp;
+	size_t nbytes;
+	uint64_t x1;
+	const char *how;
+{
+	uint64_t x2;
+
+	x2 = bb_berkdb_fasttime();
+	if (gbl_bb_berkdb_enable_thread_stats) {
+		struct berkdb_thread_stats *p, *t;
+
+		t = bb_berkdb_get_thread_stats();
+		p = bb_berkdb_get_process_stats();
+		p->n_pwrites++;
+		p->pwrite_bytes += nbytes;
+		p->pwrite_time_us += (x2 - x1);
+		t->n_pwrites++;
+		t->pwrite_bytes += nbytes;
+		t->pwrite_time_us += (x2 - x1);
+	}
+
+	if ((x2 - x1) > M2U(__berkdb_write_alarm_ms) && __berkdb_trace_func) {
+		char s[80];
+
+		snprintf(s, sizeof(s), "LONG %sPWRITEV (%d) %d ms  fd %d\n",
+		    how, (int)nbytes, U2M(x2 - x1), fhp->fd);
+		__berkdb_trace_func(s);
+	}
+}
+
 /*
  * __os_iov --
  *      Write a vector of data. Useful for skipping mpool buffer headers.
@@ -855,6 +891,25 @@ __os_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs, niop)
 		}
 	}
 
+	if (nobufs > 1 && op == DB_IO_WRITE && dbenv->attr.iouring_enabled &&
+	    DB_GLOBAL(j_read) == NULL && DB_GLOBAL(j_write) == NULL &&
+	    !dbenv->attr.check_zero_lsn_writes) {
+		uint64_t x1 = 0;
+
+		if (__berkdb_write_alarm_ms)
+			x1 = bb_berkdb_fasttime();
+		if (__os_uring_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs,
+		    niop) == 0) {
+			if (__berkdb_num_write_ios)
+				(*__berkdb_num_write_ios)++;
+			if (__berkdb_write_alarm_ms)
+				__os_iov_write_stats(fhp, *niop, x1, "URING");
+			if (write_callback)
+				write_callback(*niop);
+			return (0);
+		}
+	}
+
 	if (!F_ISSET(fhp, DB_FH_DIRECT))
 		goto slow;
 	if (nobufs == 1)
@@ -978,32 +1033,8 @@ __os_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs, niop)
 		} while (single_niop != 0 && *niop < nobufs * pagesize);
 
 
-		if (__berkdb_write_alarm_ms) {
-			x2 = bb_berkdb_fasttime();
-			if (gbl_bb_berkdb_enable_thread_stats) {
-				struct berkdb_thread_stats *p, *t;
-
-				t = bb_berkdb_get_thread_stats();
-				p = bb_berkdb_get_process_stats();
-				p->n_pwrites++;
-				p->pwrite_bytes += nobufs * pagesize;
-				p->pwrite_time_us += (x2 - x1);
-				t->n_pwrites++;
-				t->pwrite_bytes += nobufs * pagesize;
-				t->pwrite_time_us += (x2 - x1);
-			}
-
-			if ((x2 - x1) > M2U(__berkdb_write_alarm_ms)
-			    && __berkdb_trace_func) {
-				char s[80];
-
-				snprintf(s, sizeof(s),
-				    "LONG PWRITEV (%d) %d ms "
-				    " fd %d\n",
-				    (int)(nobufs * pagesize), U2M(x2 - x1), fhp->fd);
-				__berkdb_trace_func(s);
-			}
-		}
+		if (__berkdb_write_alarm_ms)
+			__os_iov_write_stats(fhp, nobufs * pagesize, x1, "");
 
 		if (write_callback)
 			write_callback(nobufs * pagesize);
@@ -0,0 +1,357 @@
+/*
+   Copyright 2021 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif /* NO_SYSTEM_INCLUDES */
+
+#include "db_int.h"
+#include "logmsg.h"
+
+/*
+ * Multi-page writes through io_uring.  Each thread that does multi-page I/O
+ * gets its own ring, so submission and completion need no locking.  A run of
+ * pages is cut into sgio_max sized vectored requests which are all queued,
+ * submitted with a single io_uring_enter and reaped before returning, so the
+ * device sees every chunk of the run at once.  The kernel interface is used
+ * directly, as liburing is not a dependency.  Anything the ring can't do (old
+ * kernel, seccomp, unaligned direct I/O, short submissions or transfers) is
+ * reported to the caller, which falls back to the synchronous path.
+ */
+#if defined(__linux__) && defined(SYS_io_uring_setup)
+#include <linux/io_uring.h>
+
+struct os_uring {
+	int fd;
+	unsigned entries;
+
+	unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+	struct io_uring_sqe *sqes;
+	unsigned *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_cqe *cqes;
+
+	void *sq_ring, *cq_ring;
+	size_t sq_ring_sz, cq_ring_sz, sqes_sz;
+
+	struct iovec *iov;
+	size_t niov;
+};
+
+static pthread_key_t uring_key;
+static pthread_once_t uring_once = PTHREAD_ONCE_INIT;
+static int uring_unavailable;
+
+static void
+__os_uring_destroy(arg)
+	void *arg;
+{
+	struct os_uring *r = arg;
+
+	if (r->sqes != NULL && r->sqes != MAP_FAILED)
+		munmap(r->sqes, r->sqes_sz);
+	if (r->cq_ring != NULL && r->cq_ring != MAP_FAILED)
+		munmap(r->cq_ring, r->cq_ring_sz);
+	if (r->sq_ring != NULL && r->sq_ring != MAP_FAILED)
+		munmap(r->sq_ring, r->sq_ring_sz);
+	if (r->fd >= 0)
+		close(r->fd);
+	free(r->iov);
+	free(r);
+}
+
+static void
+__os_uring_init_key(void)
+{
+	pthread_key_create(&uring_key, __os_uring_destroy);
+}
+
+static struct os_uring *
+__os_uring_create(depth)
+	unsigned depth;
+{
+	struct io_uring_params p;
+	struct os_uring *r;
+	u_int8_t *sq, *cq;
+	int err;
+
+	if ((r = calloc(1, sizeof(*r))) == NULL)
+		return (NULL);
+
+	memset(&p, 0, sizeof(p));
+	if ((r->fd = syscall(SYS_io_uring_setup, depth, &p)) < 0) {
+		err = errno;
+		/* Not coming back: don't retry on every I/O. */
+		if (err == ENOSYS || err == EPERM) {
+			uring_unavailable = 1;
+			logmsg(LOGMSG_WARN,
+			    "io_uring unavailable (%s), using pread/pwrite\n",
+			    strerror(err));
+		}
+		free(r);
+		return (NULL);
+	}
+
+	r->entries = p.sq_entries;
+	r->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	r->cq_ring_sz = p.cq_off.cqes +
+	    p.cq_entries * sizeof(struct io_uring_cqe);
+	r->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+
+	r->sq_ring = mmap(NULL, r->sq_ring_sz, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+	r->cq_ring = mmap(NULL, r->cq_ring_sz, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+	r->sqes = mmap(NULL, r->sqes_sz, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if (r->sq_ring == MAP_FAILED || r->cq_ring == MAP_FAILED ||
+	    r->sqes == MAP_FAILED) {
+		__os_uring_destroy(r);
+		return (NULL);
+	}
+
+	sq = r->sq_ring;
+	r->sq_head = (unsigned *)(sq + p.sq_off.head);
+	r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+	r->sq_array = (unsigned *)(sq + p.sq_off.array);
+
+	cq = r->cq_ring;
+	r->cq_head = (unsigned *)(cq + p.cq_off.head);
+	r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+	r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+	return (r);
+}
+
+static struct os_uring *
+__os_uring_get(dbenv)
+	DB_ENV *dbenv;
+{
+	struct os_uring *r;
+
+	pthread_once(&uring_once, __os_uring_init_key);
+
+	if ((r = pthread_getspecific(uring_key)) != NULL)
+		return (r);
+
+	if ((r = __os_uring_create(dbenv->attr.iouring_depth)) != NULL)
+		pthread_setspecific(uring_key, r);
+	return (r);
+}
+
+/*
+ * Queue nobufs pages as vectored requests of up to per pages each (at most
+ * r->entries of them), submit them, and wait for the ones the kernel took.
+ * Returns 0 if every page was transferred in full.  On any other return the
+ * ring may still hold unsubmitted entries and must not be reused, but
+ * nothing submitted is still in flight.
+ */
+static int
+__os_uring_batch(r, op, fd, pgno, pagesize, bufs, nobufs, per)
+	struct os_uring *r;
+	int op, fd;
+	db_pgno_t pgno;
+	size_t pagesize, nobufs, per;
+	u_int8_t **bufs;
+{
+	struct io_uring_sqe *sqe;
+	struct io_uring_cqe *cqe;
+	struct iovec *iov;
+	unsigned head, tail, idx, nsqe, reaped;
+	size_t i, n;
+	int ret, submitted, waiterr;
+
+	if (nobufs > r->niov) {
+		if ((iov = realloc(r->iov, nobufs * sizeof(*iov))) == NULL)
+			return (ENOMEM);
+		r->iov = iov;
+		r->niov = nobufs;
+	}
+
+	tail = *r->sq_tail;
+	nsqe = 0;
+	for (i = 0; i < nobufs; i += n) {
+		n = nobufs - i;
+		if (n > per)
+			n = per;
+		idx = tail & *r->sq_mask;
+		sqe = &r->sqes[idx];
+		memset(sqe, 0, sizeof(*sqe));
+
+		sqe->opcode = (op == DB_IO_READ) ?
+		    IORING_OP_READV : IORING_OP_WRITEV;
+		sqe->fd = fd;
+		sqe->off = (u_int64_t)(pgno + i) * pagesize;
+		sqe->addr = (u_int64_t)(uintptr_t)&r->iov[i];
+		sqe->len = n;
+		sqe->user_data = n * pagesize;
+		for (; n > 0; n--, i++) {
+			r->iov[i].iov_base = bufs[i];
+			r->iov[i].iov_len = pagesize;
+		}
+		n = 0;
+
+		r->sq_array[idx] = idx;
+		tail++;
+		nsqe++;
+	}
+	__atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+
+	do {
+		submitted = syscall(SYS_io_uring_enter, r->fd, nsqe, nsqe,
+		    IORING_ENTER_GETEVENTS, NULL, 0);
+	} while (submitted < 0 && errno == EINTR);
+	if (submitted < 0)
+		return (errno);
+
+	/*
+	 * The kernel may take fewer entries than we queued (EAGAIN/EBUSY on
+	 * the rest).  Only those it took will complete; reap them so their
+	 * buffers are no longer in use, and let the caller redo the run.
+	 *
+	 * Every submitted entry is reaped even if waiting fails: the caller
+	 * rewrites the run synchronously on error, and a write still in
+	 * flight could land on top of it afterwards.
+	 */
+	ret = ((unsigned)submitted < nsqe) ? EAGAIN : 0;
+	waiterr = 0;
+	for (reaped = 0; reaped < (unsigned)submitted;) {
+		head = *r->cq_head;
+		if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+			if (syscall(SYS_io_uring_enter, r->fd, 0, 1,
+			    IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+			    errno != EINTR) {
+				if (waiterr == 0) {
+					waiterr = errno;
+					logmsg(LOGMSG_WARN, "%s: io_uring_enter: "
+					    "%s, waiting for %u requests\n",
+					    __func__, strerror(waiterr),
+					    (unsigned)submitted - reaped);
+				}
+				if (ret == 0)
+					ret = waiterr;
+				poll(NULL, 0, 10);
+			}
+			continue;
+		}
+		cqe = &r->cqes[head & *r->cq_mask];
+		if (cqe->res < 0)
+			ret = -cqe->res;
+		else if ((u_int64_t)cqe->res != cqe->user_data && ret == 0)
+			ret = EIO;
+		__atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+		reaped++;
+	}
+
+	return (ret);
+}
+#endif
+
+/*
+ * __os_uring_iov --
+ *	Read or write a run of pages through this thread's io_uring.  Returns
+ *	0 if all pages were transferred, an error if the caller should fall
+ *	back to the synchronous path (which redoes the whole run).
+ *
+ * PUBLIC: int __os_uring_iov __P((DB_ENV *, int, DB_FH *, db_pgno_t, size_t,
+ * PUBLIC:     u_int8_t **, size_t, size_t *));
+ */
+int
+__os_uring_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs, niop)
+	DB_ENV *dbenv;
+	int op;
+	DB_FH *fhp;
+	db_pgno_t pgno;
+	size_t pagesize, nobufs, *niop;
+	u_int8_t **bufs;
+{
+#if defined(__linux__) && defined(SYS_io_uring_setup)
+	struct os_uring *r;
+	size_t i, n, per;
+	int ret;
+
+	*niop = 0;
+
+	if (uring_unavailable)
+		return (ENOSYS);
+
+	/* O_DIRECT needs aligned buffers; leave the rest to the bounce path. */
+	if (F_ISSET(fhp, DB_FH_DIRECT)) {
+		if (pagesize % 512)
+			return (EINVAL);
+		for (i = 0; i < nobufs; i++)
+			if ((uintptr_t)bufs[i] % 512)
+				return (EINVAL);
+	}
+
+	if ((r = __os_uring_get(dbenv)) == NULL)
+		return (ENOSYS);
+
+	if (op == DB_IO_WRITE)
+		__checkpoint_verify(dbenv);
+
+	/* Same request size as the pwritev path, one request per ring slot. */
+	per = dbenv->attr.sgio_max / pagesize;
+	if (per == 0)
+		per = 1;
+	if (per > IOV_MAX)
+		per = IOV_MAX;
+
+	for (i = 0; i < nobufs; i += n) {
+		n = nobufs - i;
+		if (n > per * r->entries)
+			n = per * r->entries;
+		if ((ret = __os_uring_batch(r, op, fhp->fd, pgno + i,
+		    pagesize, &bufs[i], n, per)) != 0) {
+			/* Don't trust the ring state; start over next time. */
+			pthread_setspecific(uring_key, NULL);
+			__os_uring_destroy(r);
+			return (ret);
+		}
+		*niop += n * pagesize;
+	}
+
+	return (0);
+#else
+	COMPQUIET(dbenv, NULL);
+	COMPQUIET(op, 0);
+	COMPQUIET(fhp, NULL);
+	COMPQUIET(pgno, 0);
+	COMPQUIET(pagesize, 0);
+	COMPQUIET(bufs, NULL);
+	COMPQUIET(nobufs, 0);
+	*niop = 0;
+	return (ENOSYS);
+#endif
+}
@@ -3843,17 +3843,96 @@ size_t __dbenv_get_log_header_size(DB_ENV* dbenv)
 // TODO(NC): rename it to lockerid
 u_int32_t gbl_rep_lockid;
 
+/*
+ * Apply one record of a transaction being processed by rp.  Records that
+ * weren't cached are read through *logcp, which is opened on first use.
+ */
+static void
+worker_apply_record(dbenv, rp, rr, logcp, tmpdbt)
+	DB_ENV *dbenv;
+	struct __recovery_processor *rp;
+	struct __recovery_record *rr;
+	DB_LOGC **logcp;
+	DBT *tmpdbt;
+{
+	u_int32_t rectype;
+	int rc;
+
+	if (rr->logdbt.data == NULL) {
+		if (*logcp == NULL) {
+			if (__log_cursor(dbenv, logcp)) {
+				__db_err(dbenv,
+					"worker can't get log cursor while processing %u:%u\n",
+					rr->lsn.file, rr->lsn.offset);
+				abort();
+			}
+			bzero(tmpdbt, sizeof(DBT));
+			tmpdbt->flags = DB_DBT_REALLOC;
+		}
+		if ((rc = __log_c_get(*logcp, &rr->lsn, tmpdbt, DB_SET))) {
+			__db_err(dbenv, "worker can't get lsn %u:%u\n",
+				rr->lsn.file, rr->lsn.offset);
+			abort();
+		}
+		LOGCOPY_32(&rectype, tmpdbt->data);
+		tmpdbt->app_data = &rp->context;
+
+		/* Map the txnid to the context */
+		if (dispatch_rectype(rectype)) {
+			rc = __db_dispatch(dbenv, dbenv->recover_dtab,
+				dbenv->recover_dtab_size, tmpdbt, &rr->lsn,
+				DB_TXN_APPLY, rp->txninfo);
+		} else
+			rc = 0;
+	} else {
+
+		LOGCOPY_32(&rectype, rr->logdbt.data);
+
+		rr->logdbt.app_data = &rp->context;
+		if (dispatch_rectype(rectype)) {
+			rc = __db_dispatch(dbenv, dbenv->recover_dtab,
+				dbenv->recover_dtab_size, &rr->logdbt,
+				&rr->lsn, DB_TXN_APPLY, rp->txninfo);
+		} else
+			rc = 0;
+	}
+
+	/* TODO: what do I do on an error? */
+	if (rc) {
+		__db_err(dbenv, "transaction failed at %lu:%lu rc=%d",
+			(u_long)rr->lsn.file, (u_long)rr->lsn.offset, rc);
+		/* and now? */
+		abort();
+	}
+}
+
+static void
+worker_close_logc(dbenv, logc, tmpdbt)
+	DB_ENV *dbenv;
+	DB_LOGC *logc;
+	DBT *tmpdbt;
+{
+	int rc;
+
+	if (logc) {
+		if (tmpdbt->data)
+			free(tmpdbt->data);
+		if ((rc = __log_c_close(logc))) {
+			__db_err(dbenv, "__log_c_close rc %d\n", rc);
+			abort();
+		}
+	}
+}
+
 static void
 worker_thd(struct thdpool *pool, void *work, void *thddata, int op)
 {
 	struct __recovery_processor *rp;
 	struct __recovery_queue *rq;
 	struct __recovery_record *rr;
-	int rc;
 	DB_ENV *dbenv;
 	DB_LOGC *logc = NULL;
 	DBT tmpdbt;
-	u_int32_t rectype;
 	int recnum = 0;
 	LISTC_T(struct recovery_record) q;
 
@@ -3870,53 +3949,7 @@ worker_thd(struct thdpool *pool, void *work, void *thddata, int op)
 
 	while (rr) {
 		recnum++;
-		if (rr->logdbt.data == NULL) {
-			if (logc == NULL) {
-				if (__log_cursor(dbenv, &logc)) {
-					__db_err(dbenv,
-						"worker can't get log cursor while processing %u:%u\n",
-						rr->lsn.file, rr->lsn.offset);
-					abort();
-				}
-				bzero(&tmpdbt, sizeof(DBT));
-				tmpdbt.flags = DB_DBT_REALLOC;
-			}
-			if ((rc = __log_c_get(logc, &rr->lsn, &tmpdbt, DB_SET))) {
-				__db_err(dbenv, "worker can't get lsn %u:%u\n",
-					rr->lsn.file, rr->lsn.offset);
-				abort();
-			}
-			LOGCOPY_32(&rectype, tmpdbt.data);
-			tmpdbt.app_data = &rp->context;
-
-			/* Map the txnid to the context */
-			if (dispatch_rectype(rectype)) {
-				rc = __db_dispatch(dbenv, dbenv->recover_dtab,
-					dbenv->recover_dtab_size, &tmpdbt, &rr->lsn,
-					DB_TXN_APPLY, rq->processor->txninfo);
-			} else
-				rc = 0;
-		} else {
-
-			LOGCOPY_32(&rectype, rr->logdbt.data);
-
-			rr->logdbt.app_data = &rp->context;
-			if (dispatch_rectype(rectype)) {
-				rc = __db_dispatch(dbenv, dbenv->recover_dtab,
-					dbenv->recover_dtab_size, &rr->logdbt,
-					&rr->lsn, DB_TXN_APPLY,
-					rq->processor->txninfo);
-			} else
-				rc = 0;
-		}
-
-		/* TODO: what do I do on an error? */
-		if (rc) {
-			__db_err(dbenv, "transaction failed at %lu:%lu rc=%d",
-				(u_long)rr->lsn.file, (u_long)rr->lsn.offset, rc);
-			/* and now? */
-			abort();
-		}
+		worker_apply_record(dbenv, rp, rr, &logc, &tmpdbt);
 
 		/* mempool? */
 		listc_abl(&q, rr);
@@ -3924,14 +3957,7 @@ worker_thd(struct thdpool *pool, void *work, void *thddata, int op)
 		rr = listc_rtl(&rq->records);
 	}
 
-	if (logc) {
-		if (tmpdbt.data)
-			free(tmpdbt.data);
-		if ((rc = __log_c_close(logc))) {
-			__db_err(dbenv, "__log_c_close rc %d\n", rc);
-			abort();
-		}
-	}
+	worker_close_logc(dbenv, logc, &tmpdbt);
 
 	Pthread_mutex_lock(&rq->processor->lk);
 	rr = listc_rtl(&q);
@@ -4003,6 +4029,346 @@ logical_record_file_affinity(int rectype)
 	}
 }
 
+/*
+ * Page affinity apply.
+ *
+ * A large transaction is applied by several threads at once.  Each record
+ * waits for the previous record in the transaction that touched any of the
+ * same pages (pgnos_for_recovery_record), so every page sees its records in
+ * log order.  Records that we can't map to pages (logical records, file ops,
+ * ...) wait for everything before them in the same file, and everything after
+ * them in that file waits for them.  Records with no file wait for each other.
+ * The commit itself is still done by the processor once every record has been
+ * applied, so commit order is unchanged.
+ */
+#define	PGAFF_NONE	UINT32_MAX
+#define	PGAFF_NSUCC	(RECOVERY_RECORD_MAX_PGNOS + 1)
+
+struct __pgaff_node {
+	struct __recovery_record *rr;
+	u_int32_t npred;	/* Predecessors that aren't applied yet. */
+	u_int32_t next;		/* Ready list. */
+	u_int32_t nsucc;
+	u_int32_t maxsucc;
+	u_int32_t succ[PGAFF_NSUCC];
+	u_int32_t *xsucc;	/* Successors past PGAFF_NSUCC. */
+};
+
+struct __pgaff_page {
+	struct {
+		int32_t fileid;
+		db_pgno_t pgno;
+	} key;
+	u_int32_t last;		/* Last record on this page. */
+	u_int32_t barrier;	/* File barrier in effect for last. */
+};
+
+struct __pgaff_file {
+	u_int32_t barrier;	/* Last record not mapped to pages. */
+	u_int32_t *since;	/* Records since barrier. */
+	u_int32_t nsince;
+	u_int32_t maxsince;
+};
+
+struct __pgaff {
+	struct __recovery_processor *rp;
+	struct __pgaff_node *nodes;
+	u_int32_t nnodes;
+	pool_t *pages;
+	hash_t *pagehash;
+	struct __pgaff_file *files;
+	int nfiles;
+
+	pthread_mutex_t lk;
+	pthread_cond_t cond;
+	u_int32_t head, tail;	/* Ready list. */
+	u_int32_t napplied;
+	int nthreads;		/* Pool threads still running. */
+};
+
+int64_t gbl_rep_trans_by_page = 0;
+
+static int
+pgaff_init(pa, rp, nrecs)
+	struct __pgaff *pa;
+	struct __recovery_processor *rp;
+	u_int32_t nrecs;
+{
+	memset(pa, 0, sizeof(*pa));
+	pa->rp = rp;
+	pa->head = pa->tail = PGAFF_NONE;
+	if ((pa->nodes = calloc(nrecs, sizeof(*pa->nodes))) == NULL ||
+	    (pa->pages = pool_setalloc_init(sizeof(struct __pgaff_page), 0,
+	    malloc, free)) == NULL ||
+	    (pa->pagehash = hash_init_o(offsetof(struct __pgaff_page, key),
+	    sizeof(((struct __pgaff_page *)0)->key))) == NULL) {
+		if (pa->pages)
+			pool_free(pa->pages);
+		free(pa->nodes);
+		return (ENOMEM);
+	}
+	Pthread_mutex_init(&pa->lk, NULL);
+	Pthread_cond_init(&pa->cond, NULL);
+	return (0);
+}
+
+static void
+pgaff_destroy(pa)
+	struct __pgaff *pa;
+{
+	u_int32_t i;
+	int f;
+
+	for (i = 0; i < pa->nnodes; i++) {
+		free(pa->nodes[i].xsucc);
+		pool_relablk(pa->rp->recpool, pa->nodes[i].rr);
+	}
+	for (f = 0; f < pa->nfiles; f++)
+		free(pa->files[f].since);
+	hash_clear(pa->pagehash);
+	hash_free(pa->pagehash);
+	pool_free(pa->pages);
+	free(pa->files);
+	free(pa->nodes);
+	Pthread_cond_destroy(&pa->cond);
+	Pthread_mutex_destroy(&pa->lk);
+}
+
+static void
+pgaff_edge(pa, from, to)
+	struct __pgaff *pa;
+	u_int32_t from, to;
+{
+	struct __pgaff_node *n;
+
+	if (from == PGAFF_NONE || from == to)
+		return;
+	n = &pa->nodes[from];
+	/* Edges into a record are added together: skip repeats. */
+	if (n->nsucc > 0 && (n->nsucc <= PGAFF_NSUCC ?
+	    n->succ[n->nsucc - 1] : n->xsucc[n->nsucc - PGAFF_NSUCC - 1]) == to)
+		return;
+	if (n->nsucc < PGAFF_NSUCC)
+		n->succ[n->nsucc] = to;
+	else {
+		if (n->nsucc - PGAFF_NSUCC == n->maxsucc) {
+			n->maxsucc = n->maxsucc ? n->maxsucc * 2 : 16;
+			n->xsucc = realloc(n->xsucc,
+			    n->maxsucc * sizeof(u_int32_t));
+			if (n->xsucc == NULL) {
+				logmsg(LOGMSG_FATAL, "%s: out of memory\n",
+				    __func__);
+				abort();
+			}
+		}
+		n->xsucc[n->nsucc - PGAFF_NSUCC] = to;
+	}
+	n->nsucc++;
+	pa->nodes[to].npred++;
+}
+
+static struct __pgaff_file *
+pgaff_file(pa, fileid)
+	struct __pgaff *pa;
+	int fileid;
+{
+	int f;
+
+	if (fileid >= pa->nfiles) {
+		pa->files = realloc(pa->files,
+		    (fileid + 1) * sizeof(struct __pgaff_file));
+		if (pa->files == NULL) {
+			logmsg(LOGMSG_FATAL, "%s: out of memory\n", __func__);
+			abort();
+		}
+		for (f = pa->nfiles; f <= fileid; f++) {
+			memset(&pa->files[f], 0, sizeof(struct __pgaff_file));
+			pa->files[f].barrier = PGAFF_NONE;
+		}
+		pa->nfiles = fileid + 1;
+	}
+	return (&pa->files[fileid]);
+}
+
+/*
+ * Add the next record of the transaction.  npgnos < 0 means the record
+ * can't be mapped to pages.
+ */
+static void
+pgaff_add(pa, rr, fileid, pgnos, npgnos)
+	struct __pgaff *pa;
+	struct __recovery_record *rr;
+	int fileid;
+	db_pgno_t *pgnos;
+	int npgnos;
+{
+	struct __pgaff_file *file;
+	struct __pgaff_page *pg, key;
+	u_int32_t id, i;
+	int j;
+
+	id = pa->nnodes++;
+	pa->nodes[id].rr = rr;
+	pa->nodes[id].next = PGAFF_NONE;
+	file = pgaff_file(pa, fileid);
+
+	if (npgnos <= 0 || fileid == 0) {
+		for (i = 0; i < file->nsince; i++)
+			pgaff_edge(pa, file->since[i], id);
+		pgaff_edge(pa, file->barrier, id);
+		file->barrier = id;
+		file->nsince = 0;
+		return;
+	}
+
+	for (j = 0; j < npgnos; j++) {
+		memset(&key, 0, sizeof(key));
+		key.key.fileid = fileid;
+		key.key.pgno = pgnos[j];
+		if ((pg = hash_find(pa->pagehash, &key.key)) == NULL) {
+			pg = pool_getablk(pa->pages);
+			*pg = key;
+			pg->last = PGAFF_NONE;
+			hash_add(pa->pagehash, pg);
+		}
+		if (pg->barrier == file->barrier && pg->last != PGAFF_NONE)
+			pgaff_edge(pa, pg->last, id);
+		else
+			pgaff_edge(pa, file->barrier, id);
+		pg->last = id;
+		pg->barrier = file->barrier;
+	}
+
+	if (file->nsince == file->maxsince) {
+		file->maxsince = file->maxsince ? file->maxsince * 2 : 64;
+		file->since = realloc(file->since,
+		    file->maxsince * sizeof(u_int32_t));
+		if (file->since == NULL) {
+			logmsg(LOGMSG_FATAL, "%s: out of memory\n", __func__);
+			abort();
+		}
+	}
+	file->since[file->nsince++] = id;
+}
+
+/* Call with pa->lk held. */
+static inline void
+pgaff_ready(pa, id)
+	struct __pgaff *pa;
+	u_int32_t id;
+{
+	pa->nodes[id].next = PGAFF_NONE;
+	if (pa->tail == PGAFF_NONE)
+		pa->head = id;
+	else
+		pa->nodes[pa->tail].next = id;
+	pa->tail = id;
+}
+
+/*
+ * Apply records as they become ready until the transaction is done.  Run by
+ * the processor and by every pool thread it started.  A thread only waits
+ * while other threads are applying records, so this can't hang even if the
+ * pool never runs any of them.
+ */
+static void
+pgaff_apply(pa)
+	struct __pgaff *pa;
+{
+	struct __pgaff_node *n;
+	DB_ENV *dbenv;
+	DB_LOGC *logc = NULL;
+	DBT tmpdbt;
+	u_int32_t id, i, s;
+	int wake;
+
+	dbenv = pa->rp->dbenv;
+
+	Pthread_mutex_lock(&pa->lk);
+	for (;;) {
+		while (pa->head == PGAFF_NONE && pa->napplied < pa->nnodes)
+			Pthread_cond_wait(&pa->cond, &pa->lk);
+		if (pa->napplied == pa->nnodes)
+			break;
+
+		id = pa->head;
+		n = &pa->nodes[id];
+		pa->head = n->next;
+		if (pa->head == PGAFF_NONE)
+			pa->tail = PGAFF_NONE;
+		Pthread_mutex_unlock(&pa->lk);
+
+		worker_apply_record(dbenv, pa->rp, n->rr, &logc, &tmpdbt);
+
+		Pthread_mutex_lock(&pa->lk);
+		pa->napplied++;
+		wake = (pa->napplied == pa->nnodes);
+		for (i = 0; i < n->nsucc; i++) {
+			s = i < PGAFF_NSUCC ? n->succ[i] :
+			    n->xsucc[i - PGAFF_NSUCC];
+			if (--pa->nodes[s].npred == 0) {
+				pgaff_ready(pa, s);
+				wake = 1;
+			}
+		}
+		if (wake)
+			Pthread_cond_broadcast(&pa->cond);
+	}
+	Pthread_mutex_unlock(&pa->lk);
+
+	worker_close_logc(dbenv, logc, &tmpdbt);
+}
+
+static void
+pgaff_thd(struct thdpool *pool, void *work, void *thddata, int op)
+{
+	struct __pgaff *pa = work;
+
+	pgaff_apply(pa);
+
+	Pthread_mutex_lock(&pa->lk);
+	pa->nthreads--;
+	Pthread_cond_broadcast(&pa->cond);
+	Pthread_mutex_unlock(&pa->lk);
+}
+
+static void
+pgaff_run(pa)
+	struct __pgaff *pa;
+{
+	DB_ENV *dbenv;
+	u_int32_t i;
+	int nthreads;
+
+	dbenv = pa->rp->dbenv;
+
+	for (i = 0; i < pa->nnodes; i++)
+		if (pa->nodes[i].npred == 0)
+			pgaff_ready(pa, i);
+
+	nthreads = dbenv->attr.rep_page_affinity_threads;
+	for (; nthreads > 1; nthreads--) {
+		Pthread_mutex_lock(&pa->lk);
+		pa->nthreads++;
+		Pthread_mutex_unlock(&pa->lk);
+		if (thdpool_enqueue(dbenv->recovery_workers, pgaff_thd, pa, 0,
+		    NULL, 0) != 0) {
+			Pthread_mutex_lock(&pa->lk);
+			pa->nthreads--;
+			Pthread_mutex_unlock(&pa->lk);
+			break;
+		}
+	}
+
+	pgaff_apply(pa);
+
+	/* pa lives on our stack: wait for the pool threads to let go of it. */
+	Pthread_mutex_lock(&pa->lk);
+	while (pa->nthreads > 0)
+		Pthread_cond_wait(&pa->cond, &pa->lk);
+	Pthread_mutex_unlock(&pa->lk);
+}
+
 #include <stdlib.h>
 
 int gbl_processor_thd_poll;
@@ -4024,6 +4390,9 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	DB_LSN *lsnp;
 	int j;
 	LISTC_T(struct __recovery_queue) queues;
+	struct __pgaff pgaff, *pa = NULL;
+	db_pgno_t pgnos[RECOVERY_RECORD_MAX_PGNOS];
+	DBT *dbtp;
 
 	DB_REP *db_rep;
 	REP *rep;
@@ -4107,6 +4476,15 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	if ((ret = __log_cursor(dbenv, &logc)) != 0)
 		goto err;
 
+	/*
+	 * Large transactions are applied by page rather than by file, if
+	 * enabled.
+	 */
+	if (dbenv->attr.rep_page_affinity && rp->lc.nlsns > 1 &&
+	    rp->lc.nlsns >= dbenv->attr.rep_page_affinity_min_records &&
+	    pgaff_init(&pgaff, rp, rp->lc.nlsns) == 0)
+		pa = &pgaff;
+
 	/* First, bucket records per queue. */
 	data_dbt.flags = DB_DBT_REALLOC;
 
@@ -4126,16 +4504,12 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 					(u_long)lsnp->file, (u_long)lsnp->offset);
 				goto err;
 			}
-			LOGCOPY_32(&rectype, data_dbt.data);
-			fileid =
-				(int)file_id_for_recovery_record(dbenv, NULL,
-				rectype, &data_dbt);
-		} else {
-			LOGCOPY_32(&rectype, rp->lc.array[i].rec.data);
-			fileid =
-				(int)file_id_for_recovery_record(dbenv, NULL,
-				rectype, &rp->lc.array[i].rec);
-		}
+			dbtp = &data_dbt;
+		} else
+			dbtp = &rp->lc.array[i].rec;
+		LOGCOPY_32(&rectype, dbtp->data);
+		fileid = (int)file_id_for_recovery_record(dbenv, NULL,
+			rectype, dbtp);
 
 		if (fileid >= 0) {
 			last_fileid = fileid;
@@ -4150,6 +4524,20 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 			fileid = 0;
 		}
 
+		if (pa) {
+			rr = pool_getablk(rp->recpool);
+			if (rp->lc.array[i].rec.data)
+				rr->logdbt = rp->lc.array[i].rec;
+			else
+				rr->logdbt.data = NULL;
+			rr->lsn = *lsnp;
+			rr->fileid = fileid;
+			pgaff_add(pa, rr, fileid, pgnos,
+				pgnos_for_recovery_record(dbenv, rectype, dbtp,
+				pgnos));
+			continue;
+		}
+
 		if (fileid >= rp->num_fileids) {
 			rp->recovery_queues =
 				realloc(rp->recovery_queues,
@@ -4185,6 +4573,14 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 		listc_abl(&rp->recovery_queues[fileid]->records, rr);
 	}
 
+	if (pa) {
+		gbl_rep_trans_by_page++;
+		pgaff_run(pa);
+		pgaff_destroy(pa);
+		pa = NULL;
+		goto applied;
+	}
+
 	if ((dbenv->flags & DB_ENV_ROWLOCKS) && listc_size(&queues) > 1) {
 		gbl_rep_rowlocks_multifile++;
 	}
@@ -4253,6 +4649,7 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 		Pthread_mutex_unlock(&rp->lk);
 	}
 
+applied:
 
 #if 0
 	{
@@ -4340,6 +4737,9 @@ err:
 		}
 	}
 
+	if (pa)
+		pgaff_destroy(pa);
+
 	if (data_dbt.data)
 		free(data_dbt.data);
 
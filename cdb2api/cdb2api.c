@@ -89,6 +89,11 @@ static int MAX_RETRIES = MAX_RETRIES_DEFAULT; /* We are looping each node twice.
 #define MIN_RETRIES_DEFAULT 3
 static int MIN_RETRIES = MIN_RETRIES_DEFAULT;
 
+/* Submitted statements whose results have not been read.  The server stops
+   reading requests while its replies are unread, so an unbounded pipeline
+   would leave both sides blocked writing to each other. */
+#define MAX_SUBMITTED_DEFAULT 32
+
 #define CDB2_CONNECT_TIMEOUT_DEFAULT 100
 static int CDB2_CONNECT_TIMEOUT = CDB2_CONNECT_TIMEOUT_DEFAULT;
 
@@ -1007,6 +1012,9 @@ struct cdb2_hndl {
     unsigned long long rows_read;
     int read_intrans_results;
     int first_record_read;
+    int n_submitted; /* sent by cdb2_submit_statement, results not read */
+    int submit_lost; /* submitted statements lost to a disconnect */
+    int max_submitted;
     char **commands;
     int ack;
     int is_hasql;
@@ -1136,6 +1144,13 @@ void cdb2_hndl_set_max_retries(cdb2_hndl_tp *hndl, int max_retries)
     }
 }
 
+void cdb2_hndl_set_max_submitted(cdb2_hndl_tp *hndl, int max_submitted)
+{
+    if (max_submitted > 0) {
+        hndl->max_submitted = max_submitted;
+    }
+}
+
 void cdb2_set_comdb2db_config(const char *cfg_file)
 {
     pthread_mutex_lock(&cdb2_cfg_lock);
@@ -2355,7 +2370,12 @@ static void newsql_disconnect(cdb2_hndl_tp *hndl, SBUF2 *sb, int line)
     int fd = sbuf2fileno(sb);
 
     int timeoutms = 10 * 1000;
-    if (hndl->is_admin ||
+    if (hndl->n_submitted) {
+        /* responses to submitted statements are still in flight */
+        hndl->submit_lost += hndl->n_submitted;
+        hndl->n_submitted = 0;
+        sbuf2close(sb);
+    } else if (hndl->is_admin ||
         (hndl->firstresponse &&
          (!hndl->lastresponse ||
           (hndl->lastresponse->response_type != RESPONSE_TYPE__LAST_ROW))) ||
@@ -4127,6 +4147,11 @@ static int cdb2_run_statement_typed_int(cdb2_hndl_tp *hndl, const char *sql,
 
     debugprint("running '%s' from line %d\n", sql, line);
 
+    if (hndl->n_submitted || hndl->submit_lost) {
+        sprintf(hndl->errstr, "%s: Submitted statements are pending", __func__);
+        PRINT_AND_RETURN(CDB2ERR_BADSTATE);
+    }
+
     consume_previous_query(hndl);
     if (!sql)
         return 0;
@@ -4851,6 +4876,150 @@ after_callback:
     return rc;
 }
 
+int cdb2_submit_statement(cdb2_hndl_tp *hndl, const char *sql)
+{
+    int rc;
+
+    sql = cdb2_skipws(sql);
+    if (hndl->in_trans || hndl->is_hasql) {
+        sprintf(hndl->errstr, "%s: Can't submit in a transaction", __func__);
+        PRINT_AND_RETURN(CDB2ERR_BADSTATE);
+    }
+    if (strncasecmp(sql, "set", 3) == 0 || strncasecmp(sql, "begin", 5) == 0 ||
+        strncasecmp(sql, "commit", 6) == 0 ||
+        strncasecmp(sql, "rollback", 8) == 0) {
+        sprintf(hndl->errstr, "%s: Can't submit '%.20s'", __func__, sql);
+        PRINT_AND_RETURN(CDB2ERR_BADSTATE);
+    }
+    /* A new connection may still be redirected or upgraded to SSL by its
+       first response, so only pipeline on an established one. */
+    if (!hndl->sb) {
+        sprintf(hndl->errstr, "%s: Run a statement to connect first",
+                __func__);
+        PRINT_AND_RETURN(CDB2ERR_NOTCONNECTED);
+    }
+    if (hndl->n_submitted + hndl->submit_lost >= hndl->max_submitted) {
+        sprintf(hndl->errstr,
+                "%s: %d statements pending, read results with "
+                "cdb2_next_statement first",
+                __func__, hndl->n_submitted + hndl->submit_lost);
+        PRINT_AND_RETURN(CDB2ERR_BADSTATE);
+    }
+
+    clear_snapshot_info(hndl, __LINE__);
+    if ((rc = next_cnonce(hndl)) != 0)
+        PRINT_AND_RETURN(rc);
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    hndl->timestampus = ((uint64_t)tv.tv_sec) * 1000000 + tv.tv_usec;
+
+    rc = cdb2_send_query(hndl, hndl, hndl->sb, hndl->dbname, (char *)sql,
+                         hndl->num_set_commands, hndl->num_set_commands_sent,
+                         hndl->commands, hndl->n_bindvars, hndl->bindvars, 0,
+                         NULL, 0, 0, 0, 0, __LINE__);
+    if (rc) {
+        sprintf(hndl->errstr, "%s: Can't send query to the db", __func__);
+        newsql_disconnect(hndl, hndl->sb, __LINE__);
+        PRINT_AND_RETURN(CDB2ERR_IO_ERROR);
+    }
+    hndl->n_submitted++;
+
+    if (log_calls)
+        fprintf(stderr, "%p> cdb2_submit_statement(%p, \"%s\") = %d\n",
+                (void *)pthread_self(), hndl, sql, hndl->n_submitted);
+
+    return 0;
+}
+
+int cdb2_next_statement(cdb2_hndl_tp *hndl)
+{
+    int rc;
+    int len;
+    int type = 0;
+
+    if (hndl->n_submitted == 0 && hndl->submit_lost == 0) {
+        sprintf(hndl->errstr, "%s: No statement submitted", __func__);
+        PRINT_AND_RETURN(CDB2ERR_NOSTATEMENT);
+    }
+
+    /* rows of the current statement come first on the wire */
+    consume_previous_query(hndl);
+    hndl->first_record_read = 0;
+    hndl->ntypes = 0;
+    hndl->types = NULL;
+
+    if (hndl->submit_lost) {
+        hndl->submit_lost--;
+        sprintf(hndl->errstr, "%s: Connection lost, statement not run",
+                __func__);
+        PRINT_AND_RETURN(CDB2ERR_IO_ERROR);
+    }
+    hndl->n_submitted--;
+
+    rc = cdb2_read_record(hndl, &hndl->first_buf, &len, &type);
+    if (rc || hndl->first_buf == NULL ||
+        type == RESPONSE_HEADER__DBINFO_RESPONSE) {
+        /* a redirect also drops whatever was pipelined behind it */
+        free(hndl->first_buf);
+        hndl->first_buf = NULL;
+        newsql_disconnect(hndl, hndl->sb, __LINE__);
+        sprintf(hndl->errstr, "%s: Can't read response from the db", __func__);
+        PRINT_AND_RETURN(CDB2ERR_IO_ERROR);
+    }
+
+    hndl->firstresponse = cdb2__sqlresponse__unpack(NULL, len, hndl->first_buf);
+    if (hndl->firstresponse == NULL ||
+        hndl->firstresponse->response_type != RESPONSE_TYPE__COLUMN_NAMES) {
+        sprintf(hndl->errstr, "%s: Unexpected response from the db",
+                __func__);
+        newsql_disconnect(hndl, hndl->sb, __LINE__);
+        clear_responses(hndl);
+        PRINT_AND_RETURN(-1);
+    }
+
+    if (hndl->firstresponse->error_code)
+        PRINT_AND_RETURN(
+            cdb2_convert_error_code(hndl->firstresponse->error_code));
+
+    rc = cdb2_next_record_int(hndl, 0);
+    if (rc == CDB2_OK || rc == CDB2_OK_DONE)
+        PRINT_AND_RETURN(0);
+
+    PRINT_AND_RETURN(cdb2_convert_error_code(rc));
+}
+
+int cdb2_poll_statement(cdb2_hndl_tp *hndl, int timeoutms)
+{
+    struct pollfd pfd;
+    int rc;
+
+    if (hndl->submit_lost)
+        return 1;
+    if (hndl->n_submitted == 0)
+        return CDB2ERR_NOSTATEMENT;
+    if (sbuf2pending(hndl->sb) > 0)
+        return 1;
+
+    pfd.fd = sbuf2fileno(hndl->sb);
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    rc = poll(&pfd, 1, timeoutms);
+    if (rc < 0)
+        return (errno == EINTR) ? 0 : CDB2ERR_IO_ERROR;
+    return rc > 0;
+}
+
+int cdb2_submitted(cdb2_hndl_tp *hndl)
+{
+    return hndl->n_submitted + hndl->submit_lost;
+}
+
+int cdb2_get_fd(cdb2_hndl_tp *hndl)
+{
+    return hndl->sb ? sbuf2fileno(hndl->sb) : -1;
+}
+
 int cdb2_numcolumns(cdb2_hndl_tp *hndl)
 {
     int rc;
@@ -6333,6 +6502,7 @@ int cdb2_open(cdb2_hndl_tp **handle, const char *dbname, const char *type,
 
     hndl->max_retries = MAX_RETRIES;
     hndl->min_retries = MIN_RETRIES;
+    hndl->max_submitted = MAX_SUBMITTED_DEFAULT;
 
     hndl->env_tz = getenv("COMDB2TZ");
     hndl->is_admin = (flags & CDB2_ADMIN);
@@ -209,6 +209,25 @@ int cdb2_run_statement(cdb2_hndl_tp *hndl, const char *sql);
 int cdb2_run_statement_typed(cdb2_hndl_tp *hndl, const char *sql, int ntypes,
                              int *types);
 
+/* Pipelined statements: cdb2_submit_statement() sends a statement without
+   waiting for its results; cdb2_next_statement() makes the oldest submitted
+   statement current, returning what cdb2_run_statement() would, after which
+   its rows are read with cdb2_next_record().  cdb2_poll_statement() waits up
+   to timeoutms for results (1 ready, 0 timeout), and cdb2_get_fd() exposes
+   the socket for event loops.  Submitted statements are not retried, and
+   cdb2_run_statement() fails until all of them have been read.
+   At most 32 statements (see cdb2_hndl_set_max_submitted()) may be pending;
+   past that cdb2_submit_statement() fails with CDB2ERR_BADSTATE until results
+   are read.  The server does not read further requests while its replies go
+   unread, so the pending statements' text should also stay well below the
+   socket buffer size, or submit can block forever. */
+int cdb2_submit_statement(cdb2_hndl_tp *hndl, const char *sql);
+int cdb2_next_statement(cdb2_hndl_tp *hndl);
+int cdb2_poll_statement(cdb2_hndl_tp *hndl, int timeoutms);
+int cdb2_submitted(cdb2_hndl_tp *hndl);
+int cdb2_get_fd(cdb2_hndl_tp *hndl);
+void cdb2_hndl_set_max_submitted(cdb2_hndl_tp *hndl, int max_submitted);
+
 int cdb2_numcolumns(cdb2_hndl_tp *hndl);
 const char *cdb2_column_name(cdb2_hndl_tp *hndl, int col);
 int cdb2_column_type(cdb2_hndl_tp *hndl, int col);
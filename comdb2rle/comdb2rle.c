@@ -26,6 +26,10 @@
 #   error "BYTE_ORDER not defined"
 #endif
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #ifdef CRLE_VERBOSE
 static void print_hex(uint8_t *b, unsigned l)
 {
@@ -181,6 +185,114 @@ static uint8_t varint_need(uint32_t i)
         o |= *i++;                                                             \
     } while (0)
 
+/* Run detection reduces to comparing the input against itself shifted by the
+ * pattern size: a pattern of size s repeats r times iff the first r * s bytes
+ * each equal the byte s after them.  These kernels return the length of the
+ * common prefix (suffix for _rev) of a[0..n) and b[0..n). */
+typedef size_t (*mismatch_t)(const uint8_t *a, const uint8_t *b, size_t n);
+
+static size_t mismatch_scalar(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        if (x != y)
+            break;
+    }
+    while (i < n && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+static size_t mismatch_rev_scalar(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = n;
+    while (i && a[i - 1] == b[i - 1])
+        --i;
+    return n - i;
+}
+
+#ifdef __x86_64__
+/* SSE2 is part of the x86_64 baseline */
+static size_t mismatch_sse2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        if (m != 0xffff)
+            return i + __builtin_ctz(~m);
+    }
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+static size_t mismatch_rev_sse2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = n;
+    for (; i >= 16; i -= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i - 16));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i - 16));
+        unsigned m = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xffff;
+        if (m)
+            return n - i + (__builtin_clz(m) - 16);
+    }
+    return n - i + mismatch_rev_scalar(a, b, i);
+}
+
+__attribute__((target("avx2")))
+static size_t mismatch_avx2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        unsigned m = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (m != 0xffffffff)
+            return i + __builtin_ctz(~m);
+    }
+    return i + mismatch_sse2(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t mismatch_rev_avx2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = n;
+    for (; i >= 32; i -= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i - 32));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i - 32));
+        unsigned m = ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (m)
+            return n - i + __builtin_clz(m);
+    }
+    return n - i + mismatch_rev_sse2(a, b, i);
+}
+
+static mismatch_t mismatch = mismatch_sse2;
+static mismatch_t mismatch_rev = mismatch_rev_sse2;
+static const char *mismatch_name = "sse2";
+#else
+static mismatch_t mismatch = mismatch_scalar;
+static mismatch_t mismatch_rev = mismatch_rev_scalar;
+static const char *mismatch_name = "scalar";
+#endif
+
+/* Select the widest run-detection kernel this cpu supports */
+const char *comdb2rle_init(void)
+{
+#ifdef __x86_64__
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        mismatch = mismatch_avx2;
+        mismatch_rev = mismatch_rev_avx2;
+        mismatch_name = "avx2";
+    }
+#endif
+    return mismatch_name;
+}
+
 /* p:ointer to pattern
  * s:ize of pattern
  * r:epeat pattern these many times
@@ -241,56 +353,9 @@ static uint32_t repeats(Data in, uint32_t sz, uint32_t *r_)
     r = *r_ = 0;
     if (in.sz < (sz * 2))
         return 0;
-    uint8_t *bp, *bx, bt;
-    uint16_t *wp, word;
-    switch (sz) {
-    case 1:
-        bt = *in.dt;        // 1st byte
-        bp = in.dt + sz;    // byte ptr
-        bx = in.dt + in.sz; // byte ptr max
-#ifndef _SUN_SOURCE
-        if (in.sz > 16) {
-            size_t qz = in.sz - in.sz % 8; // # of quads
-            uint64_t qw;
-            memset(&qw, bt, sizeof(qw));             // 1st quad
-            uint64_t *qp = (uint64_t *)in.dt;        // quad ptr
-            uint64_t *qx = (uint64_t *)(in.dt + qz); // quad ptr max
-            while (qp < qx && *qp == qw)
-                ++qp;
-            if ((uint8_t *)qp != in.dt) {
-                if (qp < qx) // last quad != 1st
-                    --qp;
-                bp = (uint8_t *)qp;
-            }
-        }
-#endif
-        // check remainder byte at a time
-        while (bp < bx && *bp == bt)
-            ++bp;
-        r = bp - in.dt - 1;
-        break;
-#ifndef _SUN_SOURCE
-    case 2:
-        word = *(uint16_t *)in.dt;
-        wp = (uint16_t *)(in.dt + sz);
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0 && word == *wp) {
-            ++wp;
-            ++r;
-        }
-        break;
-#endif
-    default:
-        bp = in.dt + sz;
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0) {
-            if (memcmp(in.dt, bp, sz))
-                break;
-            bp += sz;
-            ++r;
-        }
-        break;
-    }
+    // every whole pattern after the first must match the one before it
+    size_t n = in.sz - in.sz % sz - sz;
+    r = mismatch(in.dt, in.dt + sz, n) / sz;
     *r_ = r;
     return r;
 }
@@ -300,7 +365,7 @@ static int well_known(uint8_t *d, uint32_t s, uint32_t *w)
 {
     *w = MAXPAT;
     for (uint32_t i = 0; i < MAXPAT; ++i) {
-        if (s == psizes[i])
+        if (s == psizes[i] && *d == *patterns[i])
             if (memcmp(d, patterns[i], psizes[i]) == 0) {
                 *w = i;
                 return 1;
@@ -536,6 +601,18 @@ int decompressComdb2RLE(Comdb2RLE *d)
             memset(output.dt, *p, r);
             output.dt += r;
             output.sz -= r;
+        } else if (r >= 4) {
+            // long runs: double the copied prefix so libc's vector memcpy
+            // does the work
+            memcpy(output.dt, p, s);
+            size_t done = s;
+            while (done < reqd) {
+                size_t n = done < reqd - done ? done : reqd - done;
+                memcpy(output.dt + done, output.dt, n);
+                done += n;
+            }
+            output.dt += reqd;
+            output.sz -= reqd;
         } else
             for (uint32_t i = 0; i <= r; ++i) {
                 switch (s) {
@@ -571,13 +648,8 @@ int decompressComdb2RLE(Comdb2RLE *d)
  * r: output param */
 static int repeats_rev(const Data *input, uint32_t sz, uint32_t *r)
 {
-    uint8_t *first = input->dt - 1; //sentinal -- one before first
-    uint8_t *last = first + sz;
-    uint8_t b = *last--;
-    uint32_t dups = 0;
-    while (last != first && b == *last--) {
-        ++dups;
-    }
+    // trailing bytes equal to the one after them
+    uint32_t dups = sz ? mismatch_rev(input->dt, input->dt + 1, sz - 1) : 0;
     *r = dups;
     return dups;
 }
@@ -33,4 +33,8 @@ int compressComdb2RLE(Comdb2RLE *);
 int compressComdb2RLE_hints(Comdb2RLE *, uint16_t *);
 int decompressComdb2RLE(Comdb2RLE *);
 
+/* Pick the run-detection kernels for this cpu; returns their name.  Safe to
+** skip: the portable kernels are used until it is called. */
+const char *comdb2rle_init(void);
+
 #endif
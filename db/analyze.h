@@ -67,6 +67,14 @@ int64_t analyze_get_sampled_nrecs(const char *dbname, int ixnum);
 int analyze_table(char *table, SBUF2 *sb, int scale, int override_llmeta,
                   int bypass_auth);
 
+/**
+ * Like analyze_table, but only refresh the stats of the indexes whose bit is
+ * set in ixmask (all of them if ixmask is 0).  The other indexes keep their
+ * current stats.
+ */
+int analyze_table_indexes(char *table, SBUF2 *sb, int scale,
+                          int override_llmeta, int bypass_auth, uint64_t ixmask);
+
 /**
  * Scale and analyze all tables in the database.  Write the results to
  * sqlite_stat1.
@@ -31,6 +31,10 @@
 #include "comdb2_atomic.h"
 #include "perf.h"
 
+#include <sys/socket.h>
+#include <event2/event.h>
+#include <event2/thread.h>
+
 #ifdef DEBUG
 // was crashing because of the small stack size when debug was on
 #define GBL_APPSOCK_THDPOOL_STCKSZ 512 * 1024
@@ -69,6 +73,26 @@ static unsigned long long total_appsock_rejections = 0;
 static void appsock_thd_start(struct thdpool *pool, void *thddata);
 static void appsock_thd_end(struct thdpool *pool, void *thddata);
 
+/* Idle connections can be parked on an event loop instead of holding an
+ * appsock thread blocked in read() between requests. */
+int gbl_appsock_park_idle = 0;
+int gbl_appsock_park_loops = 2;
+
+typedef struct appsock_park_args {
+    struct event *ev;
+    int fd;
+    int admin;
+    appsock_park_fn *fn;
+    void *arg;
+} appsock_park_args_t;
+
+static pthread_once_t park_once = PTHREAD_ONCE_INIT;
+static struct event_base **park_base;
+static int park_nbase;
+static unsigned park_next;
+static int64_t parked_conns;
+static uint64_t total_parked;
+
 void close_appsock(SBUF2 *sb)
 {
     if (sb != NULL) {
@@ -128,6 +152,12 @@ void appsock_stat(void)
     logmsg(LOGMSG_USER, "bad appsock commands    %llu\n", num_bad_toks);
     logmsg(LOGMSG_USER, "rejected appsock conns  %llu\n",
            total_appsock_rejections);
+    if (gbl_appsock_park_idle) {
+        logmsg(LOGMSG_USER, "parked appsock conns    %" PRId64 "\n",
+               ATOMIC_LOAD64(parked_conns));
+        logmsg(LOGMSG_USER, "total appsock parks     %" PRIu64 "\n",
+               total_parked);
+    }
 
     for (rec = hash_first(gbl_appsock_hash, &ent, &bkt); rec;
          rec = hash_next(gbl_appsock_hash, &ent, &bkt)) {
@@ -296,6 +326,116 @@ static void appsock_work_pp(struct thdpool *pool, void *work, void *thddata,
     free(w);
 }
 
+static void park_nop(int fd, short what, void *arg)
+{
+}
+
+static void *park_loop(void *arg)
+{
+    struct event_base *base = arg;
+    struct event *ev = event_new(base, -1, EV_PERSIST, park_nop, NULL);
+    struct timeval ten = {10, 0};
+    event_add(ev, &ten);
+    event_base_dispatch(base);
+    event_free(ev);
+    return NULL;
+}
+
+static void park_init(void)
+{
+    pthread_t t;
+    evthread_use_pthreads();
+    park_nbase = gbl_appsock_park_loops > 0 ? gbl_appsock_park_loops : 1;
+    park_base = calloc(park_nbase, sizeof(struct event_base *));
+    for (int i = 0; i < park_nbase; ++i) {
+        park_base[i] = event_base_new();
+        Pthread_create(&t, NULL, park_loop, park_base[i]);
+        Pthread_detach(t);
+    }
+    logmsg(LOGMSG_INFO, "%s: %d appsock park loops (%s)\n", __func__,
+           park_nbase, event_base_get_method(park_base[0]));
+}
+
+static void appsock_unpark_pp(struct thdpool *pool, void *work, void *thddata,
+                              int op)
+{
+    appsock_park_args_t *p = work;
+    struct appsock_thd_state *state = thddata;
+
+    switch (op) {
+    case THD_RUN:
+        thrman_setfd(state->thr_self, p->fd);
+        p->fn(p->arg, state->thr_self);
+        thrman_setfd(state->thr_self, -1);
+        thrman_where(state->thr_self, NULL);
+        if (thrman_get_type(state->thr_self) != THRTYPE_APPSOCK_POOL)
+            thrman_change_type(state->thr_self, THRTYPE_APPSOCK_POOL);
+        break;
+
+    case THD_FREE:
+        p->fn(p->arg, NULL);
+        break;
+
+    default:
+        abort();
+    }
+    free(p);
+}
+
+static void appsock_unpark(int fd, short what, void *arg)
+{
+    appsock_park_args_t *p = arg;
+    event_free(p->ev);
+    p->ev = NULL;
+    ATOMIC_ADD64(parked_conns, -1);
+    if (what & EV_TIMEOUT) {
+        /* same as the net watchlist does for a blocked reader; the resumed
+         * handler sees EOF and cleans up */
+        logmsg(LOGMSG_INFO, "timing out parked session, closing fd %d\n", fd);
+        shutdown(fd, 2);
+    }
+    uint32_t flags = p->admin ? THDPOOL_FORCE_DISPATCH : 0;
+    if (thdpool_enqueue(gbl_appsock_thdpool, appsock_unpark_pp, p, 0, NULL,
+                        flags) != 0) {
+        logmsg(LOGMSG_ERROR, "%s:thdpool_enqueue error fd:%d\n", __func__, fd);
+        p->fn(p->arg, NULL);
+        free(p);
+    }
+}
+
+/* Hand an idle connection to an event loop.  fn(arg, thr_self) is called from
+ * an appsock thread once sb is readable (data or EOF), or after idle_secs (if
+ * non-zero) with the socket shut down; if it cannot be rescheduled fn is
+ * called with a NULL thr_self and must just clean up.  Returns non-zero if the
+ * connection was not parked and the caller still owns it. */
+int appsock_park(SBUF2 *sb, int admin, int idle_secs, appsock_park_fn *fn,
+                 void *arg)
+{
+    if (!gbl_appsock_park_idle || db_is_exiting() || gbl_exit)
+        return -1;
+    pthread_once(&park_once, park_init);
+
+    appsock_park_args_t *p = malloc(sizeof(*p));
+    p->fd = sbuf2fileno(sb);
+    p->admin = admin;
+    p->fn = fn;
+    p->arg = arg;
+    struct event_base *base = park_base[park_next++ % park_nbase];
+    p->ev = event_new(base, p->fd, EV_READ, appsock_unpark, p);
+    ATOMIC_ADD64(parked_conns, 1);
+    total_parked++;
+    /* may fire on the loop thread before event_add even returns */
+    struct timeval idle = {idle_secs, 0};
+    if (p->ev == NULL || event_add(p->ev, idle_secs > 0 ? &idle : NULL) != 0) {
+        ATOMIC_ADD64(parked_conns, -1);
+        if (p->ev)
+            event_free(p->ev);
+        free(p);
+        return -1;
+    }
+    return 0;
+}
+
 int gbl_appsock_connection_warn_threshold = 80;
 
 void dump_appsock_threads(void)
@@ -38,6 +38,23 @@ const char *aa_lastepoch_str = "autoanalyze_lastepoch";
 static volatile int auto_analyze_running = 0;
 int gbl_debug_aa;
 
+/* caller holds the bdb readlock if counters are saved to llmeta */
+static void reset_aa_counter_int(struct dbtable *tbl, int save_freq)
+{
+    XCHANGE32(tbl->aa_saved_counter, 0);
+    tbl->aa_lastepoch = time(NULL);
+
+    if (save_freq > 0 && thedb->master == gbl_myhostname) {
+        // save updated counter
+        const char *str = "0";
+        bdb_set_table_parameter(NULL, tbl->tablename, aa_counter_str, str);
+
+        char epoch[30] = {0};
+        sprintf(epoch, "%d", (int)tbl->aa_lastepoch);
+        bdb_set_table_parameter(NULL, tbl->tablename, aa_lastepoch_str, epoch);
+    }
+}
+
 /* reset autoanalyze counters to zero
  */
 void reset_aa_counter(char *tblname)
@@ -53,18 +70,7 @@ void reset_aa_counter(char *tblname)
         return;
     }
 
-    XCHANGE32(tbl->aa_saved_counter, 0);
-    tbl->aa_lastepoch = time(NULL);
-
-    if (save_freq > 0 && thedb->master == gbl_myhostname) {
-        // save updated counter
-        const char *str = "0";
-        bdb_set_table_parameter(NULL, tblname, aa_counter_str, str);
-
-        char epoch[30] = {0};
-        sprintf(epoch, "%d", (int)tbl->aa_lastepoch);
-        bdb_set_table_parameter(NULL, tblname, aa_lastepoch_str, epoch);
-    }
+    reset_aa_counter_int(tbl, save_freq);
 
     BDB_RELLOCK();
 
@@ -84,12 +90,15 @@ static inline void loc_print_date(const time_t *timep)
     logmsg(LOGMSG_USER, "%s", outresult);
 }
 
-/* auto_analyze_table() will be passed a copy of the table name,
- * and it will free it.
- */
-void *auto_analyze_table(void *arg)
+/* auto_analyze_indexes() request: a copy of the table name and the indexes
+ * to analyze, both freed by the thread */
+struct aa_indexes {
+    char *tblname;
+    uint64_t ixmask;
+};
+
+static void *auto_analyze_table_int(char *tblname, uint64_t ixmask)
 {
-    char *tblname = (char *)arg;
     if (is_sqlite_stat(tblname)) {
         free(tblname);
         return NULL;
@@ -108,7 +117,7 @@ void *auto_analyze_table(void *arg)
     int percent = bdb_attr_get(thedb->bdb_attr, 
                                BDB_ATTR_DEFAULT_ANALYZE_PERCENT);
 
-    if ((rc = analyze_table(tblname, sb, percent, 0, 1)) == 0) {
+    if ((rc = analyze_table_indexes(tblname, sb, percent, 0, 1, ixmask)) == 0) {
         reset_aa_counter(tblname);
     } else {
         logmsg(LOGMSG_ERROR, "%s: analyze_table %s failed rc:%d\n", __func__,
@@ -128,6 +137,52 @@ void *auto_analyze_table(void *arg)
     return NULL;
 }
 
+/* auto_analyze_table() will be passed a copy of the table name,
+ * and it will free it.
+ */
+void *auto_analyze_table(void *arg)
+{
+    return auto_analyze_table_int((char *)arg, 0);
+}
+
+static void *auto_analyze_indexes(void *arg)
+{
+    struct aa_indexes *req = arg;
+    char *tblname = req->tblname;
+    uint64_t ixmask = req->ixmask;
+    free(req);
+    return auto_analyze_table_int(tblname, ixmask);
+}
+
+/* With aa_incremental, pick the indexes whose own key changes are at least
+ * aa_incremental_min_percent of the table's counted operations.  Sets
+ * *nchanged to how many there are; returns 0 if they are all of them.
+ * The per-index counts live in memory only, so if part of the counter was
+ * restored from llmeta they cannot say which indexes it touched: analyze
+ * them all. */
+static uint64_t aa_changed_indexes(struct dbtable *tbl, unsigned counter,
+                                   int *nchanged)
+{
+    unsigned min_pct =
+        bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_INCREMENTAL_MIN_PERCENT);
+    uint64_t ixmask = 0;
+
+    if (ATOMIC_LOAD32(tbl->aa_uncounted) > 0) {
+        *nchanged = tbl->nix;
+        return 0;
+    }
+
+    *nchanged = 0;
+    for (int i = 0; i < tbl->nix; i++) {
+        uint64_t changes = ATOMIC_LOAD32(tbl->ix_write_count[i]);
+        if (changes > 0 && changes * 100 >= (uint64_t)counter * min_pct) {
+            ixmask |= 1ULL << i;
+            (*nchanged)++;
+        }
+    }
+    return (*nchanged == tbl->nix) ? 0 : ixmask;
+}
+
 static void get_saved_counter_epoch(char *tblname, unsigned *aa_counter,
                                     time_t *aa_lastepoch)
 {
@@ -167,6 +222,11 @@ int load_auto_analyze_counters(void)
             unsigned int saved_counter = 0;
             get_saved_counter_epoch(tbl->tablename, &saved_counter, &tbl->aa_lastepoch);
             XCHANGE32(tbl->aa_saved_counter, saved_counter);
+            // whatever this node counted per index while it was last master
+            // is stale; the restored ops are not attributed to any index
+            for (int ix = 0; ix < tbl->nix; ix++)
+                XCHANGE32(tbl->ix_write_count[ix], 0);
+            XCHANGE32(tbl->aa_uncounted, saved_counter);
 
             char my_buf[30];
             ctrace("AUTOANALYZE: Loading table %s, count %d, last run time %s",
@@ -273,6 +333,10 @@ void stat_auto_analyze(void)
            bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_LLMETA_SAVE_FREQ));
     logmsg(LOGMSG_USER, "REQUEST MODE: %s\n",
            YESNO(bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_REQUEST_MODE)));
+    int incremental = bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_INCREMENTAL);
+    logmsg(LOGMSG_USER, "INCREMENTAL: %s (min %d%% of changes per index)\n",
+           YESNO(incremental),
+           bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_INCREMENTAL_MIN_PERCENT));
     int include_updates = bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_COUNT_UPD);
 
     if (NULL == get_dbtable_by_name("sqlite_stat1")) {
@@ -308,6 +372,12 @@ void stat_auto_analyze(void)
                delta, (new_aa_percnt > 100 ? 100 : new_aa_percnt));
         loc_print_date(&tbl->aa_lastepoch);
         logmsg(LOGMSG_USER, "\n");
+        if (!incremental)
+            continue;
+        for (int ix = 0; ix < tbl->nix; ix++) {
+            logmsg(LOGMSG_USER, "    index %d: %u key changes\n", ix,
+                   ATOMIC_LOAD32(tbl->ix_write_count[ix]));
+        }
     }
 }
 
@@ -396,6 +466,31 @@ void *auto_analyze_main(void *unused)
                        tbl->tablename, newautoanalyze_counter, ctime_r(&tbl->aa_lastepoch, my_buf));
 
                 logmsg(LOGMSG_USER, "AUTOANALYZE: Requesting analyze be run for table: %s\n", tbl->tablename);
+            } else if (bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_INCREMENTAL) &&
+                       tbl->nix > 0) {
+                int nchanged;
+                uint64_t ixmask = aa_changed_indexes(tbl, newautoanalyze_counter, &nchanged);
+                if (nchanged == 0) {
+                    // the writes did not move any index's keys enough to
+                    // matter; start counting again.  Nothing was analyzed,
+                    // so leave aa_lastepoch and the llmeta counter alone:
+                    // after a restart the saved counter forces a full run
+                    ctrace("AUTOANALYZE: Table %s, counter (%d), no index changed enough, skipping\n",
+                           tbl->tablename, newautoanalyze_counter);
+                    XCHANGE32(tbl->aa_saved_counter, 0);
+                    continue;
+                }
+                ctrace("AUTOANALYZE: Analyzing %d of %d indexes of Table %s, counter (%d); last run time %s\n",
+                       nchanged, tbl->nix, tbl->tablename, newautoanalyze_counter,
+                       ctime_r(&tbl->aa_lastepoch, my_buf));
+                auto_analyze_running = 1; // will be reset by
+                                          // auto_analyze_table_int()
+                pthread_t analyze;
+                // will be freed in auto_analyze_indexes()
+                struct aa_indexes *req = malloc(sizeof(struct aa_indexes));
+                req->tblname = strdup(tbl->tablename);
+                req->ixmask = ixmask;
+                Pthread_create(&analyze, &gbl_pthread_attr_detached, auto_analyze_indexes, req);
             } else {
                 ctrace(
                     "AUTOANALYZE: Analyzing Table %s, counter (%d); last run time %s\n",
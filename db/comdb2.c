@@ -102,6 +102,7 @@ void berk_memp_sync_alarm_ms(int);
 #include <cdb2_constants.h>
 
 #include <crc32c.h>
+#include <comdb2rle.h>
 
 #include "fdb_fend.h"
 #include "fdb_bend.h"
@@ -234,6 +235,8 @@ int gbl_net_max_queue = 25000;
 int gbl_net_max_mem = 0;
 int gbl_net_poll = 100;
 int gbl_net_throttle_percent = 50;
+int gbl_net_compress = 0;
+int gbl_net_compress_min_bytes = 1024;
 int gbl_osql_net_poll = 100;
 int gbl_osql_max_queue = 10000;
 int gbl_osql_net_portmux_register_interval = 600;
@@ -488,6 +491,9 @@ int gbl_parallel_recovery_threads = 0;
 
 int gbl_fdb_resolve_local = 0;
 int gbl_fdb_allow_cross_classes = 0;
+int gbl_fdb_push_columns = 1;
+int gbl_fdb_push_count = 1;
+int gbl_fdb_stream_batch_bytes = 65536;
 
 /*---COUNTS---*/
 long n_qtrap;
@@ -1493,6 +1499,7 @@ static void free_sqlite_table(struct dbenv *dbenv)
         delete_schema(tbl->tablename); // tags hash
         delete_db(tbl->tablename);     // will free db
         bdb_cleanup_fld_hints(tbl->handle);
+        bdb_cleanup_compr_dicts(tbl->handle);
         freedb(tbl);
     }
     free(dbenv->dbs);
@@ -4438,6 +4445,10 @@ static int init(int argc, char **argv)
                                  gbl_net_throttle_percent);
     }
 
+    net_set_compress(thedb->handle_sibling,
+                     gbl_net_compress ? NET_COMPRESS_LZ4 : NET_COMPRESS_NONE,
+                     gbl_net_compress_min_bytes);
+
     if (gbl_net_portmux_register_interval) {
         net_set_portmux_register_interval(thedb->handle_sibling,
                                           gbl_net_portmux_register_interval);
@@ -5648,6 +5659,7 @@ static void goodbye()
 #define TOOL(x) #x,
 
 #define TOOLS           \
+   TOOL(cdb2_bench)     \
    TOOL(cdb2_dump)      \
    TOOL(cdb2_load)      \
    TOOL(cdb2_printlog)  \
@@ -5749,6 +5761,7 @@ int main(int argc, char **argv)
     setvbuf(stdout, 0, _IOLBF, 0);
 
     crc32c_init(0);
+    comdb2rle_init();
 
     adjust_ulimits();
     sqlite3_tunables_init();
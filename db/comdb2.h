@@ -655,6 +655,8 @@ typedef struct dbtable {
     unsigned deadlock_count;
     unsigned saved_deadlock_count;
     unsigned aa_saved_counter; // zeroed out at autoanalyze
+    unsigned ix_write_count[MAXINDEX]; // key adds+dels since last analyze
+    unsigned aa_uncounted; // ops loaded from llmeta, not in ix_write_count
     time_t aa_lastepoch;
     unsigned aa_counter_upd;   // counter which includes updates
     unsigned aa_counter_noupd; // does not include updates
@@ -1713,6 +1715,8 @@ extern int gbl_prefault_toblock_local;
 
 extern int gbl_appsock_pooling;
 extern struct thdpool *gbl_appsock_thdpool;
+extern int gbl_appsock_park_idle;
+extern int gbl_appsock_park_loops;
 extern struct thdpool *gbl_osqlpfault_thdpool;
 extern struct thdpool *gbl_udppfault_thdpool;
 
@@ -1793,6 +1797,8 @@ extern int gbl_dohsql_disable;
 extern int gbl_dohsql_verbose;
 extern int gbl_dohast_disable;
 extern int gbl_dohast_verbose;
+extern int gbl_dohsql_scan_split;
+extern int gbl_dohsql_scan_split_min_rows;
 extern int gbl_dohsql_max_queued_kb_highwm;
 extern int gbl_dohsql_full_queue_poll_msec;
 extern int gbl_dohsql_max_threads;
@@ -1839,6 +1845,9 @@ int a2req(const char *s);
 void appsock_handler_start(struct dbenv *dbenv, SBUF2 *sb, int is_admin);
 void appsock_coalesce(struct dbenv *dbenv);
 void close_appsock(SBUF2 *sb);
+typedef void appsock_park_fn(void *arg, struct thr_handle *thr_self);
+int appsock_park(SBUF2 *sb, int admin, int idle_secs, appsock_park_fn *fn,
+                 void *arg);
 void thd_stats(void);
 void thd_dbinfo2_stats(struct db_info2_stats *stats);
 void thd_coalesce(struct dbenv *dbenv);
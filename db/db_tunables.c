@@ -47,6 +47,9 @@ extern int gbl_berkdb_epochms_repts;
 extern int gbl_pmux_route_enabled;
 extern int gbl_allow_user_schema;
 extern int gbl_test_badwrite_intvl;
+extern int gbl_pgtrack;
+extern int gbl_deadlock_detect_local;
+extern int gbl_deadlock_detect_local_max;
 extern int gbl_broken_max_rec_sz;
 extern int gbl_broken_num_parser;
 extern int gbl_crc32c;
@@ -69,6 +72,9 @@ extern int gbl_forbid_ulonglong;
 extern int gbl_force_highslot;
 extern int gbl_fdb_allow_cross_classes;
 extern int gbl_fdb_resolve_local;
+extern int gbl_fdb_push_columns;
+extern int gbl_fdb_push_count;
+extern int gbl_fdb_stream_batch_bytes;
 extern int gbl_goslow;
 extern int gbl_heartbeat_send;
 extern int gbl_keycompr;
@@ -81,11 +87,14 @@ extern int gbl_master_swing_sock_restart_sleep;
 extern int gbl_max_lua_instructions;
 extern int gbl_max_sqlcache;
 extern int __gbl_max_mpalloc_sleeptime;
+extern int gbl_mpool_policy;
 extern int gbl_mem_nice;
 extern int gbl_netbufsz;
 extern int gbl_net_lmt_upd_incoherent_nodes;
 extern int gbl_net_max_mem;
 extern int gbl_net_throttle_percent;
+extern int gbl_net_compress;
+extern int gbl_net_compress_min_bytes;
 extern int gbl_nice;
 extern int gbl_notimeouts;
 extern int gbl_watchdog_disable_at_start;
@@ -122,6 +131,8 @@ extern int gbl_toblock_random_deadlock_trans;
 extern int diffstat_thresh;
 extern int reqltruncate;
 extern int analyze_max_comp_threads;
+extern int gbl_analyze_streaming;
+extern int gbl_analyze_streaming_max_mb;
 extern int analyze_max_table_threads;
 extern int gbl_block_set_commit_genid_trace;
 extern int gbl_abort_on_unset_ha_flag;
@@ -201,6 +212,7 @@ extern int gbl_rep_wait_release_ms;
 extern int gbl_rep_wait_core_ms;
 extern int gbl_random_get_curtran_failures;
 extern int gbl_random_thdpool_work_timeout;
+extern int gbl_thdpool_affinity_scan;
 extern int gbl_thdpool_queue_only;
 extern int gbl_random_sql_work_delayed;
 extern int gbl_random_sql_work_rejected;
@@ -213,6 +225,7 @@ extern int gbl_physrep_exit_on_invalid_logstream;
 extern int gbl_blocking_physrep;
 extern int gbl_verbose_set_sc_in_progress;
 extern int gbl_send_failed_dispatch_message;
+extern int gbl_newsql_stream_rows;
 extern int gbl_physrep_reconnect_penalty;
 extern int gbl_physrep_register_interval;
 extern int gbl_logdelete_lock_trace;
@@ -473,6 +486,50 @@ static void *enable_sql_stmt_caching_value(void *context)
     return "unknown";
 }
 
+/* Codes match MPOOL_POLICY_* in berkdb/dbinc/mp.h. */
+struct bufferpool_policy_st {
+    const char *name;
+    int code;
+} bufferpool_policy_vals[] = {{"LRU", 0}, {"2Q", 1}};
+
+static int bufferpool_policy_update(void *context, void *value)
+{
+    comdb2_tunable *tunable;
+    char *tok;
+    int st = 0;
+    int ltok;
+    int len;
+
+    tunable = (comdb2_tunable *)context;
+    len = strlen(value);
+
+    tok = segtok(value, len, &st, &ltok);
+
+    for (int i = 0; i < (sizeof(bufferpool_policy_vals) /
+                         sizeof(struct bufferpool_policy_st));
+         i++) {
+        if (tokcmp(tok, ltok, bufferpool_policy_vals[i].name) == 0) {
+            *(int *)tunable->var = bufferpool_policy_vals[i].code;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void *bufferpool_policy_value(void *context)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+
+    for (int i = 0; i < (sizeof(bufferpool_policy_vals) /
+                         sizeof(struct bufferpool_policy_st));
+         i++) {
+        if (bufferpool_policy_vals[i].code == *(int *)tunable->var) {
+            return (void *)bufferpool_policy_vals[i].name;
+        }
+    }
+    return "unknown";
+}
+
 struct checkctags_st {
     const char *name;
     int code;
@@ -622,6 +679,18 @@ static int lk_verify(void *context, void *value)
     return 0;
 }
 
+static int deadlock_detect_local_max_verify(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+
+    if ((*(int *)value < 0) || (*(int *)value > 1024)) {
+        logmsg(LOGMSG_ERROR, "Invalid value for '%s'. (range: 0-1024)\n",
+               tunable->name);
+        return 1;
+    }
+    return 0;
+}
+
 static int memnice_update(void *context, void *value)
 {
     int nicerc;
@@ -747,6 +816,18 @@ static int broken_max_rec_sz_update(void *context, void *value)
     return 0;
 }
 
+static int net_compress_update(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    *(int *)tunable->var = *(int *)value;
+    if (thedb && thedb->handle_sibling) {
+        net_set_compress(thedb->handle_sibling,
+                         gbl_net_compress ? NET_COMPRESS_LZ4 : NET_COMPRESS_NONE,
+                         gbl_net_compress_min_bytes);
+    }
+    return 0;
+}
+
 static int netconndumptime_update(void *context, void *value)
 {
     int val = *(int *)value;
@@ -63,6 +63,17 @@ REGISTER_TUNABLE("analyze_comp_threshold",
                  "scan the entire index. (Default: 104857600)",
                  TUNABLE_INTEGER, &sampling_threshold, READONLY, NULL, NULL,
                  analyze_set_sampling_threshold, NULL);
+REGISTER_TUNABLE("analyze_streaming",
+                 "Sample indexes in a single pass, keeping the sample in "
+                 "memory and counting distinct key prefixes with "
+                 "HyperLogLog. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_analyze_streaming, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("analyze_streaming_max_mb",
+                 "Most memory a streaming analyze may use for the sample of "
+                 "one index. (Default: 64)",
+                 TUNABLE_INTEGER, &gbl_analyze_streaming_max_mb, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("analyze_tbl_threads",
                  "Number of threads to go through generated samples when "
                  "generating index statistics. (Default: 5)",
@@ -90,6 +101,11 @@ REGISTER_TUNABLE("broken_max_rec_sz", NULL, TUNABLE_INTEGER,
 REGISTER_TUNABLE("broken_num_parser", NULL, TUNABLE_BOOLEAN,
                  &gbl_broken_num_parser, READONLY | NOARG | READEARLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("bufferpool_policy",
+                 "Buffer pool replacement policy: LRU, or the scan resistant "
+                 "2Q. (Default: LRU)",
+                 TUNABLE_ENUM, &gbl_mpool_policy, 0, bufferpool_policy_value,
+                 NULL, bufferpool_policy_update, NULL);
 REGISTER_TUNABLE("buffers_per_context", NULL, TUNABLE_INTEGER,
                  &gbl_buffers_per_context, READONLY | NOZERO, NULL, NULL, NULL,
                  NULL);
@@ -105,6 +121,11 @@ REGISTER_TUNABLE("cachekbmax", NULL, TUNABLE_INTEGER, &db->cacheszkbmax,
                  READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("cachekbmin", NULL, TUNABLE_INTEGER, &db->cacheszkbmin,
                  READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("changed_page_tracking",
+                 "Track the pages written to each file so incremental "
+                 "backups can copy just those. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_pgtrack, READONLY, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("checkctags", NULL, TUNABLE_ENUM, &gbl_check_client_tags,
                  READONLY, checkctags_value, NULL, checkctags_update, NULL);
 REGISTER_TUNABLE("chkpoint_alarm_time",
@@ -156,6 +177,18 @@ REGISTER_TUNABLE(
 REGISTER_TUNABLE("deadlock_policy_override", NULL, TUNABLE_INTEGER,
                  &gbl_deadlock_policy_override, READONLY, NULL, NULL,
                  deadlock_policy_override_update, NULL);
+REGISTER_TUNABLE("deadlock_detect_local",
+                 "Before blocking, search the waits-for graph from the new "
+                 "waiter and only run the full deadlock detector if a cycle "
+                 "may pass through it. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_deadlock_detect_local, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("deadlock_detect_local_max",
+                 "Number of waiting lockers the local deadlock search may "
+                 "visit before falling back to the full detector, at most "
+                 "1024. (Default: 128)",
+                 TUNABLE_INTEGER, &gbl_deadlock_detect_local_max, 0, NULL,
+                 deadlock_detect_local_max_verify, NULL, NULL);
 /*
 REGISTER_TUNABLE("decimal_rounding", NULL, TUNABLE_INTEGER,
                  &gbl_decimal_rounding, READONLY, NULL, NULL, NULL, NULL);
@@ -473,6 +506,21 @@ REGISTER_TUNABLE("foreign_db_allow_cross_class", NULL, TUNABLE_BOOLEAN,
 REGISTER_TUNABLE("foreign_db_resolve_local", NULL, TUNABLE_BOOLEAN,
                  &gbl_fdb_resolve_local, READONLY | NOARG | READEARLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("foreign_db_push_columns",
+                 "Fetch only the columns a query uses from remote tables. "
+                 "(Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_push_columns, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("foreign_db_push_count",
+                 "Compute count(*) of remote tables on the remote database. "
+                 "(Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_push_count, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("foreign_db_stream_batch_bytes",
+                 "Coalesce rows streamed to a remote reader into writes of up "
+                 "to this many bytes; 0 flushes every row. (Default: 65536)",
+                 TUNABLE_INTEGER, &gbl_fdb_stream_batch_bytes, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("fullrecovery", "Attempt to run database "
                                  "recovery from the beginning of "
                                  "available logs. (Default : off)",
@@ -740,6 +788,17 @@ REGISTER_TUNABLE(
     "Produce a stack dump for long network flushes. (Default: off)",
     TUNABLE_BOOLEAN, &explicit_flush_trace, READONLY | NOARG, NULL, NULL, NULL,
     NULL);
+REGISTER_TUNABLE("net_compress",
+                 "Batch each flush of the replication stream into LZ4 "
+                 "compressed frames, for replicants that support it. "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_net_compress, 0, NULL, NULL,
+                 net_compress_update, NULL);
+REGISTER_TUNABLE("net_compress_min_bytes",
+                 "Send replication frames smaller than this uncompressed. "
+                 "(Default: 1024)",
+                 TUNABLE_INTEGER, &gbl_net_compress_min_bytes, 0, NULL, NULL,
+                 net_compress_update, NULL);
 REGISTER_TUNABLE("net_lmt_upd_incoherent_nodes", NULL, TUNABLE_INTEGER,
                  &gbl_net_lmt_upd_incoherent_nodes, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("net_max_mem",
@@ -1641,6 +1700,13 @@ REGISTER_TUNABLE("random_thdpool_work_timeout",
                  TUNABLE_INTEGER, &gbl_random_thdpool_work_timeout,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("thdpool_affinity_scan",
+                 "Number of most recently idle threads a thread pool inspects "
+                 "for one that suits a work item, such as an sql thread that "
+                 "already has the query prepared; 0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_thdpool_affinity_scan, 0, NULL, NULL,
+                 NULL, NULL);
+
 REGISTER_TUNABLE("dohsql_disable",
                  "Disable running queries in distributed mode", TUNABLE_BOOLEAN,
                  &gbl_dohsql_disable, 0, NULL, NULL, NULL, NULL);
@@ -1678,6 +1744,19 @@ REGISTER_TUNABLE(
     " (if 0, defaults to 1).",
     TUNABLE_INTEGER, &gbl_dohsql_pool_thr_slack, NOZERO, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("dohsql_scan_split",
+                 "Split a single table scan into up to this many key ranges "
+                 "run in parallel, using the analyze samples of the table; "
+                 "0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_dohsql_scan_split, 0, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("dohsql_scan_split_min_rows",
+                 "Only split scans of tables estimated to have at least this "
+                 "many rows.  (Default: 1000000)",
+                 TUNABLE_INTEGER, &gbl_dohsql_scan_split_min_rows, 0, NULL,
+                 NULL, NULL, NULL);
+
 REGISTER_TUNABLE(
     "dohsql_full_queue_poll_msec",
     "Poll milliseconds while waiting for coordinator to consume from queue.",
@@ -1773,6 +1852,12 @@ REGISTER_TUNABLE("send_failed_dispatch_message",
                  TUNABLE_BOOLEAN, &gbl_send_failed_dispatch_message,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("newsql_stream_rows",
+                 "Encode newsql result rows directly into the client buffer "
+                 "instead of packing a protobuf response.  (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_newsql_stream_rows, 0, NULL, NULL, NULL,
+                 NULL);
+
 REGISTER_TUNABLE("legacy_schema", "Only allow legacy compatible csc2 schema",
                  TUNABLE_BOOLEAN, &gbl_legacy_schema,
                  EXPERIMENTAL | INTERNAL | READEARLY, NULL, NULL, NULL, NULL);
@@ -1992,6 +2077,19 @@ REGISTER_TUNABLE("cached_output_buffer_max_bytes",
                  TUNABLE_INTEGER, &gbl_cached_output_buffer_max_bytes, 0, NULL,
                  NULL, NULL, NULL);
 
+REGISTER_TUNABLE("appsock_park_idle",
+                 "Park idle newsql connections on an event loop between "
+                 "requests instead of holding an appsock thread.  "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_appsock_park_idle, 0, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("appsock_park_loops",
+                 "Number of event loops watching parked connections.  "
+                 "(Default: 2)",
+                 TUNABLE_INTEGER, &gbl_appsock_park_loops, READONLY, NULL,
+                 NULL, NULL, NULL);
+
 REGISTER_TUNABLE("debug_queuedb",
                  "Enable debug-trace for queuedb.  "
                  "(Default: off)",
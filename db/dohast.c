@@ -14,6 +14,8 @@
    limitations under the License.
  */
 
+#include <math.h>
+
 #include "comdb2.h"
 #include "sqliteInt.h"
 #include "vdbeInt.h"
@@ -23,6 +25,8 @@
 
 int gbl_dohast_disable = 0;
 int gbl_dohast_verbose = 0;
+int gbl_dohsql_scan_split = 0;
+int gbl_dohsql_scan_split_min_rows = 1000000;
 
 static void node_free(dohsql_node_t **pnode, sqlite3 *db);
 static void _save_params(Parse *pParse, dohsql_node_t *node);
@@ -123,8 +127,9 @@ static char *describeExprList(Vdbe *v, const ExprList *lst, int *order_size,
 }
 
 char *sqlite_struct_to_string(Vdbe *v, Select *p, Expr *extraRows,
-                              int *order_size, int **order_dir,
-                              struct params_info **pParamsOut, int is_union)
+                              const char *range, int *order_size,
+                              int **order_dir, struct params_info **pParamsOut,
+                              int is_union)
 {
     char *cols = NULL;
     char *tbl = NULL;
@@ -155,6 +160,16 @@ char *sqlite_struct_to_string(Vdbe *v, Select *p, Expr *extraRows,
             return NULL;
     }
 
+    if (range) {
+        /* key range of a split scan, see gen_split() */
+        char *tmp = (where) ? sqlite3_mprintf("(%s) aND %s", where, range)
+                            : sqlite3_mprintf("%s", range);
+        sqlite3_free(where);
+        where = tmp;
+        if (!where)
+            return NULL;
+    }
+
     if (p->pOrderBy) {
         orderby = describeExprList(v, p->pOrderBy, order_size, order_dir,
                                    pParamsOut, is_union);
@@ -328,8 +343,8 @@ void ast_destroy(ast_t **past, sqlite3 *db)
 }
 
 static dohsql_node_t *gen_oneselect(Vdbe *v, Select *p, Expr *extraRows,
-                                    int *order_size, int **order_dir,
-                                    int is_union)
+                                    const char *range, int *order_size,
+                                    int **order_dir, int is_union)
 {
     dohsql_node_t *node;
     Select *prior = p->pPrior;
@@ -348,8 +363,8 @@ static dohsql_node_t *gen_oneselect(Vdbe *v, Select *p, Expr *extraRows,
 
     node->type = AST_TYPE_SELECT;
     p->pPrior = p->pNext = NULL;
-    node->sql = sqlite_struct_to_string(v, p, extraRows, order_size, order_dir,
-                                        &node->params, is_union);
+    node->sql = sqlite_struct_to_string(v, p, extraRows, range, order_size,
+                                        order_dir, &node->params, is_union);
     p->pPrior = prior;
     p->pNext = next;
 
@@ -457,7 +472,7 @@ static dohsql_node_t *gen_union(Vdbe *v, Select *p, int span)
     while (crt) {
         assert(crt == p || !crt->pOrderBy); /* can "restore" to NULL? */
         crt->pOrderBy = p->pOrderBy;
-        *psub = gen_oneselect(v, crt, pOffset, &node->order_size,
+        *psub = gen_oneselect(v, crt, pOffset, NULL, &node->order_size,
                               &node->order_dir, 1);
         crt->pLimit = NULL;
         if (crt != p)
@@ -529,6 +544,213 @@ static int skip_tables(Select *p)
     return 0;
 }
 
+/* Render the leading field of an analyze sample as an sql literal; only
+   types that compare the same way as literals are accepted */
+static char *_sample_literal(UnpackedRecord *r, IndexSample *sample)
+{
+    Mem *m = &r->aMem[0];
+    char *ret = NULL;
+
+    r->nField = r->pKeyInfo->nKeyField + 1;
+    sqlite3VdbeRecordUnpack(r->pKeyInfo, sample->n, sample->p, r);
+    if (r->nField < 1)
+        return NULL;
+
+    switch (sqlite3_value_type(m)) {
+    case SQLITE_INTEGER:
+        ret = sqlite3_mprintf("%lld", m->u.i);
+        break;
+    case SQLITE_FLOAT:
+        if (!isnan(m->u.r) && !isinf(m->u.r))
+            ret = sqlite3_mprintf("%!.17g", m->u.r);
+        break;
+    case SQLITE_TEXT:
+        ret = sqlite3_mprintf("'%.*q'", m->n, m->z);
+        break;
+    case SQLITE_BLOB: {
+        static const char hex[] = "0123456789abcdef";
+        int i;
+        ret = sqlite3_malloc(2 * m->n + 4);
+        if (!ret)
+            break;
+        ret[0] = 'x';
+        ret[1] = '\'';
+        for (i = 0; i < m->n; i++) {
+            ret[2 + 2 * i] = hex[((u8)m->z[i]) >> 4];
+            ret[3 + 2 * i] = hex[((u8)m->z[i]) & 0x0f];
+        }
+        ret[2 + 2 * m->n] = '\'';
+        ret[3 + 2 * m->n] = '\0';
+        break;
+    }
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+/* Split a single table scan into key ranges, one shard per range.  The
+   boundaries are the analyze samples of the first index that has enough of
+   them, picked so each range holds about the same number of rows.  Returns
+   NULL if the select cannot be split. */
+static dohsql_node_t *gen_split(Vdbe *v, Select *p)
+{
+    Table *pTab;
+    Index *pIdx;
+    IndexSample *aSample;
+    KeyInfo *pKeyInfo = NULL;
+    UnpackedRecord *r = NULL;
+    dohsql_node_t *node = NULL;
+    char **bounds = NULL;
+    char *range;
+    const char *col;
+    u64 nrows;
+    int nsplit;
+    int nbounds = 0;
+    int last = -1;
+    int i, k;
+
+    nsplit = gbl_dohsql_scan_split;
+    if (gbl_dohsql_max_threads && nsplit > gbl_dohsql_max_threads)
+        nsplit = gbl_dohsql_max_threads;
+    if (nsplit < 2)
+        return NULL;
+
+    /* limits would need to be re-applied across shards */
+    if (p->pLimit || p->pPrior || p->pSrc->nSrc != 1)
+        return NULL;
+
+    /* distinct, aggregates and windows need every row in one place */
+    if ((p->selFlags & (SF_Distinct | SF_Aggregate | SF_HasAgg)) ||
+        p->pGroupBy || p->pHaving || p->pWin)
+        return NULL;
+
+    pTab = p->pSrc->a[0].pTab;
+    if (!pTab || IsVirtual(pTab) || pTab->pSelect || pTab->iDb > 1)
+        return NULL;
+
+    nrows = sqlite3LogEstToInt(pTab->nRowLogEst);
+    if (nrows < nsplit || nrows < gbl_dohsql_scan_split_min_rows)
+        return NULL;
+
+    /* shards are merged on result columns only */
+    if (p->pOrderBy) {
+        for (i = 0; i < p->pOrderBy->nExpr; i++) {
+            if (p->pOrderBy->a[i].u.x.iOrderByCol == 0)
+                return NULL;
+        }
+    }
+
+    /* samples of a descending index come highest first, and the ranges
+       below assume ascending bounds */
+    for (pIdx = pTab->pIndex; pIdx; pIdx = pIdx->pNext) {
+        if (pIdx->nSample >= nsplit && pIdx->aiColumn[0] >= 0 &&
+            pIdx->aSortOrder[0] == SQLITE_SO_ASC && !pIdx->pPartIdxWhere)
+            break;
+    }
+    if (!pIdx)
+        return NULL;
+    aSample = pIdx->aSample;
+
+    bounds = calloc(nsplit - 1, sizeof(char *));
+    if (!bounds)
+        return NULL;
+    pKeyInfo = sqlite3KeyInfoAlloc(v->db, 1, 0);
+    if (!pKeyInfo || !(r = sqlite3VdbeAllocUnpackedRecord(pKeyInfo)))
+        goto done;
+
+    for (k = 1; k < nsplit; k++) {
+        tRowcnt target = nrows * k / nsplit;
+
+        /* samples sharing a leading value have the same anLt[0] */
+        for (i = last + 1; i < pIdx->nSample; i++) {
+            if (aSample[i].anLt[0] >= target &&
+                (last < 0 || aSample[i].anLt[0] > aSample[last].anLt[0]))
+                break;
+        }
+        if (i >= pIdx->nSample)
+            break;
+        if (!(bounds[nbounds] = _sample_literal(r, &aSample[i])))
+            goto done;
+        nbounds++;
+        last = i;
+    }
+    if (nbounds == 0)
+        goto done;
+
+    node = (dohsql_node_t *)calloc(1, sizeof(dohsql_node_t) +
+                                          (nbounds + 1) * sizeof(void *));
+    if (!node)
+        goto done;
+    node->type = AST_TYPE_UNION;
+    node->nodes = (dohsql_node_t **)(node + 1);
+    node->nnodes = nbounds + 1;
+    node->ncols = p->pEList->nExpr;
+
+    col = pTab->aCol[pIdx->aiColumn[0]].zName;
+    for (i = 0; i <= nbounds; i++) {
+        int order_size = 0;
+        int *order_dir = NULL;
+
+        if (i == 0)
+            range = sqlite3_mprintf("(\"%w\" < %s oR \"%w\" iS NuLL)", col,
+                                    bounds[0], col);
+        else if (i == nbounds)
+            range = sqlite3_mprintf("\"%w\" >= %s", col, bounds[i - 1]);
+        else
+            range = sqlite3_mprintf("(\"%w\" >= %s aND \"%w\" < %s)", col,
+                                    bounds[i - 1], col, bounds[i]);
+        if (!range) {
+            node_free(&node, v->db);
+            goto done;
+        }
+
+        node->nodes[i] =
+            gen_oneselect(v, p, NULL, range, &order_size, &order_dir, 1);
+        sqlite3_free(range);
+        if (!node->nodes[i]) {
+            free(order_dir);
+            node_free(&node, v->db);
+            goto done;
+        }
+        if (i == 0) {
+            node->order_size = order_size;
+            node->order_dir = order_dir;
+        } else {
+            free(order_dir);
+        }
+
+        if (i > 0) {
+            char *tmp = sqlite3_mprintf("%s uNioN aLL %s", node->sql,
+                                        node->nodes[i]->sql);
+            sqlite3_free(node->sql);
+            node->sql = tmp;
+        } else {
+            node->sql = sqlite3_mprintf("%s", node->nodes[i]->sql);
+        }
+        if (!node->sql) {
+            node_free(&node, v->db);
+            goto done;
+        }
+    }
+
+    if (gbl_dohast_verbose)
+        logmsg(LOGMSG_USER, "%p Split scan of \"%s\" on \"%s\" in %d ranges\n",
+               (void *)pthread_self(), pTab->zName, col, node->nnodes);
+
+done:
+    for (i = 0; i < nbounds; i++)
+        sqlite3_free(bounds[i]);
+    free(bounds);
+    if (r)
+        sqlite3DbFree(v->db, r);
+    if (pKeyInfo)
+        sqlite3KeyInfoUnref(pKeyInfo);
+
+    return node;
+}
+
 static dohsql_node_t *gen_select(Vdbe *v, Select *p)
 {
     Select *crt;
@@ -560,9 +782,11 @@ static dohsql_node_t *gen_select(Vdbe *v, Select *p)
     )
         return NULL;
 
-    if (p->op == TK_SELECT)
-        ret = gen_oneselect(v, p, NULL, NULL, NULL, 0);
-    else
+    if (p->op == TK_SELECT) {
+        if (span == 1 && (ret = gen_split(v, p)) != NULL)
+            return ret;
+        ret = gen_oneselect(v, p, NULL, NULL, NULL, NULL, 0);
+    } else
         ret = gen_union(v, p, span);
 
     return ret;
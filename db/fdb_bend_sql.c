@@ -94,7 +94,7 @@ int fdb_svc_cursor_open_sql(char *tid, char *cid, int code_release, int version,
  *
  */
 int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int ret,
-                    int isuuid)
+                    int isuuid, int flush)
 {
     /* NOTE: we assume everything required is embedded in the sqlite row
        including genid and datacopy fields - as generated by select
@@ -109,7 +109,7 @@ int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int ret,
     }
 
     rc = fdb_bend_send_row(sb, NULL, cid, genid, row, rowlen, NULL, 0, ret,
-                           isuuid);
+                           isuuid, flush);
 
     return rc;
 }
@@ -58,6 +58,7 @@
 
 extern int gbl_fdb_resolve_local;
 extern int gbl_fdb_allow_cross_classes;
+extern int gbl_fdb_push_columns;
 extern int gbl_partial_indexes;
 extern int gbl_expressions_indexes;
 
@@ -238,6 +239,7 @@ static int fdb_cursor_find_last(BtCursor *pCur, Mem *key, int nfields,
 static int fdb_cursor_set_hint(BtCursor *pCur, void *hint);
 static void *fdb_cursor_get_hint(BtCursor *pCur);
 static int fdb_cursor_set_sql(BtCursor *pCur, const char *sql);
+static int fdb_cursor_count(BtCursor *pCur);
 static char *fdb_cursor_name(BtCursor *pCur);
 static char *fdb_cursor_tblname(BtCursor *pCur);
 static int fdb_cursor_table_has_partidx(BtCursor *pCur);
@@ -2423,6 +2425,7 @@ static fdb_cursor_if_t *_fdb_cursor_open_remote(struct sqlclntstate *clnt,
     fdbc_if->set_hint = fdb_cursor_set_hint;
     fdbc_if->get_hint = fdb_cursor_get_hint;
     fdbc_if->set_sql = fdb_cursor_set_sql;
+    fdbc_if->count = fdb_cursor_count;
     fdbc_if->name = fdb_cursor_name;
     fdbc_if->tblname = fdb_cursor_tblname;
     fdbc_if->tbl_has_partidx = fdb_cursor_table_has_partidx;
@@ -2645,6 +2648,51 @@ static int fdb_cursor_close(BtCursor *pCur)
     return FDB_NOERR;
 }
 
+/**
+ * Column list for a table cursor which only asks for the columns sqlite will
+ * read; the others are sent as NULL so the row keeps its layout.
+ * Returns NULL if every column is needed, or we cannot tell which.
+ *
+ */
+static char *_build_table_columns(BtCursor *pCur)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    unsigned long long mask = pCur->col_mask;
+    Table *pTab;
+    char *cols = NULL, *tmp;
+    int i;
+
+    /* no mask means OP_ColumnsUsed was not issued for this cursor */
+    if (!gbl_fdb_push_columns || !mask || pCur->writeTransaction)
+        return NULL;
+
+    pTab = sqlite3FindTable(pCur->sqlite, fdbc->ent->name,
+                            fdbc->ent->tbl->fdb->dbname);
+    if (!pTab)
+        return NULL;
+
+    for (i = 0; i < pTab->nCol; i++) {
+        if (IsHiddenColumn(&pTab->aCol[i]))
+            break;
+        if (i >= 63 ? (mask & (1ULL << 63)) : (mask & (1ULL << i)))
+            tmp = sqlite3_mprintf("%s%s\"%w\"", cols ? cols : "",
+                                  cols ? ", " : "", pTab->aCol[i].zName);
+        else
+            tmp = sqlite3_mprintf("%s%sNULL", cols ? cols : "",
+                                  cols ? ", " : "");
+        sqlite3_free(cols);
+        if ((cols = tmp) == NULL)
+            return NULL;
+    }
+    if (i < pTab->nCol) {
+        /* "*" skips hidden columns, keep it simple */
+        sqlite3_free(cols);
+        return NULL;
+    }
+
+    return cols;
+}
+
 static char *_build_run_sql_from_hint(BtCursor *pCur, Mem *m, int ncols,
                                       int bias, int *p_sqllen, int *error)
 {
@@ -2681,6 +2729,7 @@ static char *_build_run_sql_from_hint(BtCursor *pCur, Mem *m, int ncols,
             using_col_filter = 1;
         } else {
             tableName = fdbc->ent->name;
+            columnsDesc = _build_table_columns(pCur);
         }
     }
 
@@ -3257,9 +3306,12 @@ static int fdb_cursor_find_sql_common(BtCursor *pCur, Mem *key, int nfields,
                 abort();
             }
 
-            sql = sqlite3_mprintf("select *, rowid from \"%w\" "
+            char *cols = _build_table_columns(pCur);
+            sql = sqlite3_mprintf("select %s, rowid from \"%w\" "
                                   "where rowid = %lld",
-                                  fdbc->ent->tbl->name, key->u.i);
+                                  cols ? cols : "*", fdbc->ent->tbl->name,
+                                  key->u.i);
+            sqlite3_free(cols);
             sqllen = strlen(sql) + 1;
         } else {
             if (fdbc->sql_hint) {
@@ -3488,6 +3540,37 @@ static int fdb_cursor_set_sql(BtCursor *pCur, const char *sql)
     return 0;
 }
 
+/**
+ * Have the remote count the table rows instead of streaming them all here;
+ * on IX_FND the cursor data is a row whose first column is the count.
+ * Returns FDB_ERR_UNSUPPORTED if this cursor cannot do it
+ *
+ */
+static int fdb_cursor_count(BtCursor *pCur)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    char *sql;
+    int rc;
+
+    if (!fdbc->ent || fdbc->sql_hint)
+        return FDB_ERR_UNSUPPORTED;
+
+    /* the remote takes the genid from the last 8 bytes of each row */
+    sql = sqlite3_mprintf("select count(*), zeroblob(8) from \"%w\"",
+                          fdbc->ent->tbl->name);
+    if (!sql)
+        return FDB_ERR_MALLOC;
+
+    fdbc->sql_hint = sql;
+    rc = pCur->fdbc->move(pCur, CFIRST);
+    /* move can reopen the cursor */
+    if (pCur->fdbc)
+        pCur->fdbc->impl->sql_hint = NULL;
+    sqlite3_free(sql);
+
+    return rc == IX_FNDMORE ? IX_FND : rc;
+}
+
 static char *fdb_cursor_name(BtCursor *pCur)
 {
     assert(pCur->fdbc);
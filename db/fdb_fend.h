@@ -212,6 +212,7 @@ typedef struct fdb_cursor_if {
     void *(*get_hint)(BtCursor *pCur);
 
     int (*set_sql)(BtCursor *pCur, const char *sql);
+    int (*count)(BtCursor *pCur); /* row with the remote count(*) */
     char *(*name)(BtCursor *pCur);
     char *(*tblname)(BtCursor *pCur);
     int (*tbl_has_partidx)(BtCursor *pCur);
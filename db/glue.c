@@ -94,6 +94,7 @@
 #include "schemachange.h"
 #include "db_access.h" /* gbl_check_access_controls */
 #include "txn_properties.h"
+#include "comdb2_atomic.h"
 
 int (*comdb2_ipc_master_set)(char *host) = 0;
 
@@ -929,8 +930,11 @@ int ix_addk_auxdb(int auxdb, struct ireq *iq, void *trans, void *key, int ixnum,
                                dtalen, isnull,
                                &bdberr);
     iq->gluewhere = "bdb_prim_addkey done";
-    if (rc == 0)
+    if (rc == 0) {
+        if (auxdb == AUXDB_NONE)
+            ATOMIC_ADD32(iq->usedb->ix_write_count[ixnum], 1);
         return 0;
+    }
 
     /*translate engine rcodes */
     switch (bdberr) {
@@ -1007,8 +1011,11 @@ int ix_delk_auxdb(int auxdb, struct ireq *iq, void *trans, void *key, int ixnum,
     rc = bdb_prim_delkey_genid(bdb_handle, trans, key, ixnum, rrn, genid,
                                isnull, &bdberr);
     iq->gluewhere = "bdb_prim_delkey done";
-    if (rc == 0)
+    if (rc == 0) {
+        if (auxdb == AUXDB_NONE)
+            ATOMIC_ADD32(iq->usedb->ix_write_count[ixnum], 1);
         return 0;
+    }
     /*translate engine rcodes */
     switch (bdberr) {
     case BDBERR_DEADLOCK:
@@ -4062,6 +4069,13 @@ int backend_open_tran(struct dbenv *dbenv, tran_type *tran, uint32_t flags)
         set_bdb_option_flags(tbl, tbl->odh, tbl->inplace_updates,
                              tbl->instant_schema_change, tbl->schema_version,
                              compress, compress_blobs, datacopy_odh);
+        /* older records may use a dictionary even if the table no longer
+         * compresses with one */
+        if (bdb_load_compr_dicts(tbl->handle, tran) != 0) {
+            logmsg(LOGMSG_ERROR, "failed to load dictionaries for %s\n",
+                   tbl->tablename);
+            return -1;
+        }
 
         ctrace("Table %s  "
                "ver %d  "
@@ -5574,6 +5588,11 @@ void compr_print_stats()
                bdb_algo2compr(blob_compr), db->inplace_updates ? "yes" : "no",
                db->instant_schema_change ? "yes" : "no");
 
+        int dictlen, dictver = bdb_get_compr_dict_info(db->handle, &dictlen);
+        if (dictver)
+            logmsg(LOGMSG_USER, "  dictionary: v%d %d bytes", dictver,
+                   dictlen);
+
         logmsg(LOGMSG_USER, "\n");
     }
 }
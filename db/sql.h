@@ -257,6 +257,8 @@ typedef struct {
     int sampling_pct;
     unsigned long long n_recs;
     unsigned long long n_sampled_recs;
+    int nprefix;          /* streaming analyze: number of key columns */
+    uint64_t *ndistinct;  /* streaming analyze: distinct values per prefix */
 } sampled_idx_t;
 
 typedef struct sqlclntstate_fdb {
@@ -986,6 +988,7 @@ struct BtCursor {
     blob_status_t blobs;
 
     bdb_cursor_ifn_t *bdbcur;
+    bdb_cursor_batch_t *batch; /* rows buffered for sequential table scans */
 
     int nmove, nfind, nwrite;
     int nblobs;
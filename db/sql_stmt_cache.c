@@ -16,6 +16,7 @@
 
 #include <sqliteInt.h>
 #include "sql_stmt_cache.h"
+#include "comdb2_atomic.h"
 #include "sql.h"
 #include "lrucache.h"
 #include "dohsql.h" // dohsql_wait_for_master()
@@ -90,6 +91,9 @@ stmt_cache_t *stmt_cache_new(stmt_cache_t *in_stmt_cache)
                offsetof(stmt_cache_entry_t, lnk));
     listc_init(&(stmt_cache->noparam_stmt_list),
                offsetof(stmt_cache_entry_t, lnk));
+    for (int i = 0; i < STMT_CACHE_RECENT; i++)
+        XCHANGE32(stmt_cache->recent[i], 0);
+    stmt_cache->nrecent = 0;
     return stmt_cache;
 }
 
@@ -129,6 +133,10 @@ static int stmt_cache_requeue_entry(stmt_cache_t *stmt_cache,
     void *list = GET_STMT_LIST(stmt_cache, entry->stmt);
     listc_atl(list, entry);
 
+    unsigned hash = strhashfunc_stmt((u_char *)entry->sql, 0);
+    XCHANGE32(stmt_cache->recent[stmt_cache->nrecent++ % STMT_CACHE_RECENT],
+              hash ? hash : 1);
+
     return 0;
 }
 
@@ -443,6 +451,42 @@ void sql_dump_hints(void)
     Pthread_mutex_unlock(&gbl_sql_lock);
 }
 
+/* Hash sql the way it would be keyed in a stmt_cache (by its cache hint if
+ * it has one); 0 if it can't be cached. */
+unsigned stmt_cache_sql_hash(const char *sql)
+{
+    char hint[HINT_LEN];
+    unsigned hash;
+
+    if (sql == NULL)
+        return 0;
+
+    if (extract_sqlcache_hint(sql, hint, HINT_LEN))
+        sql = hint;
+
+    if (strlen(sql) >= MAX_HASH_SQL_LENGTH)
+        return 0;
+
+    hash = strhashfunc_stmt((u_char *)sql, 0);
+    return hash ? hash : 1;
+}
+
+/* Returns non-zero if a statement with this hash was recently put back in
+ * stmt_cache, and so is likely still cached.  Safe to call from any thread:
+ * only the published hashes are read, never the cache itself.  A collision
+ * or an evicted statement costs a prepare, nothing more. */
+int stmt_cache_recent_sql(stmt_cache_t *stmt_cache, unsigned hash)
+{
+    if (stmt_cache == NULL || hash == 0)
+        return 0;
+
+    for (int i = 0; i < STMT_CACHE_RECENT; i++) {
+        if (ATOMIC_LOAD32(stmt_cache->recent[i]) == hash)
+            return 1;
+    }
+    return 0;
+}
+
 int stmt_cache_get(struct sqlthdstate *thd, struct sqlclntstate *clnt,
                    struct sql_state *rec, int prepFlags)
 {
@@ -26,6 +26,7 @@
 
 #define MAX_HASH_SQL_LENGTH 8192
 #define HINT_LEN 127
+#define STMT_CACHE_RECENT 16
 
 enum STMT_CACHE_FLAGS {
     STMT_CACHE_NONE = 0,  /* disable statement caching */
@@ -73,6 +74,10 @@ typedef struct stmt_cache {
       lists is freed. */
     LISTC_T(stmt_cache_entry_t) param_stmt_list;
     LISTC_T(stmt_cache_entry_t) noparam_stmt_list;
+    /* Hashes of the statements last put back in the cache, published for
+      other threads; see stmt_cache_recent_sql(). */
+    unsigned recent[STMT_CACHE_RECENT];
+    unsigned nrecent;
 } stmt_cache_t;
 
 struct sql_state {
@@ -96,6 +101,8 @@ int stmt_cache_put_distributed(struct sqlthdstate *, struct sqlclntstate *,
                                struct sql_state *, int, int);
 int stmt_cache_find_entry(stmt_cache_t *stmt_cache, const char *sql,
                           stmt_cache_entry_t **entry);
+unsigned stmt_cache_sql_hash(const char *sql);
+int stmt_cache_recent_sql(stmt_cache_t *stmt_cache, unsigned hash);
 int stmt_cache_add_entry(stmt_cache_t *stmt_cache, const char *sql,
                          const char *actual_sql, sqlite3_stmt *stmt,
                          struct sqlclntstate *clnt);
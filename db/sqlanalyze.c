@@ -37,6 +37,7 @@
 #include <ctrace.h>
 #include <logmsg.h>
 #include "str0.h"
+#include "strbuf.h"
 #include "sc_util.h"
 #include "debug_switches.h"
 
@@ -57,6 +58,12 @@ static int sampled_tables_enabled = 1;
 /* sampling threshold defaults to 100 Mb */
 long long sampling_threshold = 104857600;
 
+/* sample in one pass into memory, with sketch-based distinct counts */
+int gbl_analyze_streaming = 0;
+
+/* per-index memory budget of a streaming sample */
+int gbl_analyze_streaming_max_mb = 64;
+
 /* hard-maximum number of analyze-table threads */
 static int analyze_hard_max_table_threads = 15;
 
@@ -124,6 +131,7 @@ typedef struct table_descriptor {
     SBUF2 *sb;
     int scale;
     int override_llmeta;
+    uint64_t ixmask; /* indexes to analyze; 0 means all of them */
     index_descriptor_t index[MAXINDEX];
     struct user current_user;
 } table_descriptor_t;
@@ -266,9 +274,31 @@ static int sample_index_int(index_descriptor_t *ix_des)
     /* cache the tablename for sqlglue */
     strncpy0(s_ix->name, tbl->tablename, sizeof(s_ix->name));
 
-    /* ask bdb to put a summary of this into a temp-table */
-    rc = bdb_summarize_table(tbl->handle, ix, sampling_pct, &sampler,
-                             &n_sampled_recs, &n_recs, &bdberr);
+    if (gbl_analyze_streaming) {
+        /* ondisk keys are fixed width, so column prefixes are byte prefixes */
+        struct schema *sc = tbl->ixschema[ix];
+        int *prefixlen = malloc(sc->nmembers * sizeof(int));
+        s_ix->ndistinct = calloc(sc->nmembers, sizeof(uint64_t));
+        if (prefixlen == NULL || s_ix->ndistinct == NULL) {
+            free(prefixlen);
+            logmsg(LOGMSG_ERROR, "%s: out of memory\n", __func__);
+            return -1;
+        }
+        for (int i = 0; i < sc->nmembers; i++)
+            prefixlen[i] = sc->member[i].offset + sc->member[i].len;
+        s_ix->nprefix = sc->nmembers;
+
+        rc = bdb_summarize_table_streaming(
+            tbl->handle, ix, sampling_pct,
+            (size_t)gbl_analyze_streaming_max_mb << 20, sc->nmembers,
+            prefixlen, s_ix->ndistinct, &sampler, &n_sampled_recs, &n_recs,
+            &bdberr);
+        free(prefixlen);
+    } else {
+        /* ask bdb to put a summary of this into a temp-table */
+        rc = bdb_summarize_table(tbl->handle, ix, sampling_pct, &sampler,
+                                 &n_sampled_recs, &n_recs, &bdberr);
+    }
 
     /* failed */
     if (rc) {
@@ -397,6 +427,11 @@ static int sample_indicies(table_descriptor_t *td, struct sqlclntstate *client,
         ix_des->ix = i;
         ix_des->sampling_pct = sampling_pct;
 
+        if (td->ixmask && !(td->ixmask & (1ULL << i))) {
+            ix_des->comp_state = SAMPLING_COMPLETE;
+            continue;
+        }
+
         /* start an index sampling thread */
         int rc = dispatch_sample_index_thread(ix_des);
         if (0 != rc) {
@@ -428,6 +463,8 @@ static int cleanup_sampled_indicies(struct sqlclntstate *client, struct dbtable
         sampled_idx_t *s_ix = &client->sampled_idx_tbl[i];
         if (!s_ix)
             continue;
+        free(s_ix->ndistinct);
+        s_ix->ndistinct = NULL;
     }
 
     /* free & zero struct */
@@ -704,6 +741,87 @@ int update_sav(sqlite3 *sqldb, struct sqlclntstate *client, SBUF2 *sb,
     return 0;
 }
 
+/* Move the table's stats for this stat table aside as 'cdb2.<table>.sav' so
+ * that they can be backed out.  When only the indexes in ixlist are being
+ * analyzed, the other indexes keep their rows, so those are copied instead:
+ * the .sav rows must always be a complete set for backout_stats_frm_tbl. */
+static int save_stats(struct sqlclntstate *clnt, int stattbl, const char *cols,
+                      const char *table, const char *ixlist, char *zErrTab,
+                      size_t errlen)
+{
+    char *sql;
+    int rc;
+
+    sql = sqlite3_mprintf("delete from sqlite_stat%d where tbl='cdb2.%q.sav'",
+                          stattbl, table);
+    assert(sql != NULL);
+    rc = run_internal_sql_clnt(clnt, sql);
+    if (rc) strncpy0(zErrTab, sql, errlen);
+    sqlite3_free(sql);
+    if (rc)
+        return rc;
+
+    if (ixlist) {
+        sql = sqlite3_mprintf("insert into sqlite_stat%d select 'cdb2.%q.sav', "
+                              "%s from sqlite_stat%d where tbl='%q' and idx "
+                              "not in (%s)",
+                              stattbl, table, cols, stattbl, table, ixlist);
+        assert(sql != NULL);
+        rc = run_internal_sql_clnt(clnt, sql);
+        if (rc) strncpy0(zErrTab, sql, errlen);
+        sqlite3_free(sql);
+        if (rc)
+            return rc;
+    }
+
+    sql = sqlite3_mprintf("update sqlite_stat%d set tbl='cdb2.%q.sav' where "
+                          "tbl='%q'%s%s%s",
+                          stattbl, table, table, ixlist ? " and idx in (" : "",
+                          ixlist ? ixlist : "", ixlist ? ")" : "");
+    assert(sql != NULL);
+    rc = run_internal_sql_clnt(clnt, sql);
+    if (rc) strncpy0(zErrTab, sql, errlen);
+    sqlite3_free(sql);
+    return rc;
+}
+
+/* sqlite derives stat1 from the sample, which undercounts distinct values
+ * of selective prefixes; replace them with the sketch estimates taken over
+ * the whole index by a streaming sample */
+static int update_stat1_from_sketches(struct sqlclntstate *clnt,
+                                      struct dbtable *tbl, char *zErrTab,
+                                      size_t errlen)
+{
+    int rc = 0;
+
+    for (int i = 0; i < clnt->n_cmp_idx && rc == 0; i++) {
+        sampled_idx_t *s_ix = &clnt->sampled_idx_tbl[i];
+        if (s_ix->ndistinct == NULL || s_ix->nprefix <= 0)
+            continue;
+
+        unsigned long long nrow = s_ix->n_recs > 0 ? s_ix->n_recs : 1;
+        strbuf *stat = strbuf_new();
+        strbuf_appendf(stat, "%llu", nrow);
+        for (int j = 0; j < s_ix->nprefix; j++) {
+            unsigned long long nd = s_ix->ndistinct[j];
+            strbuf_appendf(stat, " %llu", (nrow + nd - 1) / nd);
+        }
+
+        /* only touch rows with the shape we expect */
+        char *sql = sqlite3_mprintf(
+            "update sqlite_stat1 set stat='%q' where tbl='%q' and idx='%q' "
+            "and length(stat)-length(replace(stat,' ',''))=%d",
+            strbuf_buf(stat), tbl->tablename, tbl->ixschema[i]->sqlitetag,
+            s_ix->nprefix);
+        assert(sql != NULL);
+        rc = run_internal_sql_clnt(clnt, sql);
+        if (rc) strncpy0(zErrTab, sql, errlen);
+        sqlite3_free(sql);
+        strbuf_free(stat);
+    }
+    return rc;
+}
+
 static int analyze_table_int(table_descriptor_t *td,
                              struct thr_handle *thr_self)
 {
@@ -734,6 +852,7 @@ static int analyze_table_int(table_descriptor_t *td,
     start_internal_sql_clnt(&clnt);
     clnt.osql_max_trans = 0; // allow large transactions
     int sampled_table = 0;
+    char *ixlist = NULL;
 
     clnt.current_user = td->current_user;
 
@@ -746,73 +865,27 @@ static int analyze_table_int(table_descriptor_t *td,
     }
 
     char *sql = NULL;
-    sql = sqlite3_mprintf(
-             "delete from sqlite_stat1 where tbl='cdb2.%q.sav'", td->table);
-    assert(sql != NULL);
-    rc = run_internal_sql_clnt(&clnt, sql);
-    if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
-    sqlite3_free(sql); sql = NULL;
-
-    if (rc)
-        goto error;
-
-    sql = sqlite3_mprintf(
-             "update sqlite_stat1 set tbl='cdb2.%q.sav' where tbl='%q'",
-             td->table, td->table);
-    assert(sql != NULL);
-    rc = run_internal_sql_clnt(&clnt, sql);
-    if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
-    sqlite3_free(sql); sql = NULL;
+    if (td->ixmask) {
+        for (int i = 0; i < tbl->nix; i++) {
+            if (td->ixmask & (1ULL << i))
+                ixlist = sqlite3_mprintf("%z%s%Q", ixlist, ixlist ? "," : "",
+                                         tbl->ixschema[i]->sqlitetag);
+        }
+        if (ixlist == NULL) // the indexes are gone; analyze what is there
+            td->ixmask = 0;
+    }
 
+    rc = save_stats(&clnt, 1, "idx,stat", td->table, ixlist, zErrTab,
+                    sizeof(zErrTab));
+    if (rc == 0 && get_dbtable_by_name("sqlite_stat2"))
+        rc = save_stats(&clnt, 2, "idx,sampleno,sample", td->table, ixlist,
+                        zErrTab, sizeof(zErrTab));
+    if (rc == 0 && get_dbtable_by_name("sqlite_stat4"))
+        rc = save_stats(&clnt, 4, "idx,neq,nlt,ndlt,sample", td->table,
+                        ixlist, zErrTab, sizeof(zErrTab));
     if (rc)
         goto error;
 
-    if (get_dbtable_by_name("sqlite_stat2")) {
-        sql = sqlite3_mprintf(
-                 "delete from sqlite_stat2 where tbl='cdb2.%q.sav'", td->table);
-        assert(sql != NULL);
-        rc = run_internal_sql_clnt(&clnt, sql);
-        if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
-        sqlite3_free(sql); sql = NULL;
-
-        if (rc)
-            goto error;
-
-        sql = sqlite3_mprintf(
-                 "update sqlite_stat2 set tbl='cdb2.%q.sav' where tbl='%q'",
-                 td->table, td->table);
-        assert(sql != NULL);
-        rc = run_internal_sql_clnt(&clnt, sql);
-        if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
-        sqlite3_free(sql); sql = NULL;
-
-        if (rc)
-            goto error;
-    }
-
-    if (get_dbtable_by_name("sqlite_stat4")) {
-        sql = sqlite3_mprintf(
-                 "delete from sqlite_stat4 where tbl='cdb2.%q.sav'", td->table);
-        assert(sql != NULL);
-        rc = run_internal_sql_clnt(&clnt, sql);
-        if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
-        sqlite3_free(sql); sql = NULL;
-
-        if (rc)
-            goto error;
-
-        sql = sqlite3_mprintf(
-                 "update sqlite_stat4 set tbl='cdb2.%q.sav' where tbl='%q'",
-                 td->table, td->table);
-        assert(sql != NULL);
-        rc = run_internal_sql_clnt(&clnt, sql);
-        if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
-        sqlite3_free(sql); sql = NULL;
-
-        if (rc)
-            goto error;
-    }
-
     /* grab the size of the table */
     int64_t totsiz = calc_table_size(tbl, 1);
 
@@ -832,17 +905,29 @@ static int analyze_table_int(table_descriptor_t *td,
 
     clnt.is_analyze = 1;
 
-    /* run analyze as sql query */
-    sql = sqlite3_mprintf("analyzesqlite main.\"%w\"", td->table);
-    assert(sql != NULL);
-    rc = run_internal_sql_clnt(&clnt, sql);
-    if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
-    sqlite3_free(sql); sql = NULL;
+    /* run analyze as sql query; sqlite accepts an index name in place of
+     * the table to analyze just that index */
+    for (int i = 0; i < (ixlist ? tbl->nix : 1) && rc == 0; i++) {
+        if (ixlist && !(td->ixmask & (1ULL << i)))
+            continue;
+        sql = sqlite3_mprintf("analyzesqlite main.\"%w\"",
+                              ixlist ? tbl->ixschema[i]->sqlitetag : td->table);
+        assert(sql != NULL);
+        rc = run_internal_sql_clnt(&clnt, sql);
+        if (rc) strncpy(zErrTab, sql, sizeof(zErrTab));
+        sqlite3_free(sql); sql = NULL;
+    }
 
     clnt.is_analyze = 0;
     if (rc)
         goto error;
 
+    if (sampled_table && gbl_analyze_streaming) {
+        rc = update_stat1_from_sketches(&clnt, tbl, zErrTab, sizeof(zErrTab));
+        if (rc)
+            goto error;
+    }
+
     if (debug_switch_test_delay_analyze_commit())
         sleep(10);
 
@@ -854,6 +939,13 @@ static int analyze_table_int(table_descriptor_t *td,
         */
         osql_unregister_sqlthr(&clnt);
         snprintf(zErrTab, sizeof(zErrTab), "COMMIT");
+    } else {
+        for (int i = 0; i < tbl->nix; i++) {
+            if (td->ixmask == 0 || (td->ixmask & (1ULL << i)))
+                XCHANGE32(tbl->ix_write_count[i], 0);
+        }
+        if (td->ixmask == 0)
+            XCHANGE32(tbl->aa_uncounted, 0);
     }
 
 cleanup:
@@ -869,6 +961,7 @@ cleanup:
     if (sampled_table) {
         cleanup_sampled_indicies(&clnt, tbl);
     }
+    sqlite3_free(ixlist);
 
     return rc;
 
@@ -1038,6 +1131,13 @@ int get_analyze_abort_requested()
 /* analyze 'table' */
 int analyze_table(char *table, SBUF2 *sb, int scale, int override_llmeta,
                   int bypass_auth)
+{
+    return analyze_table_indexes(table, sb, scale, override_llmeta, bypass_auth,
+                                 0);
+}
+
+int analyze_table_indexes(char *table, SBUF2 *sb, int scale,
+                          int override_llmeta, int bypass_auth, uint64_t ixmask)
 {
     if (check_stat1(sb))
         return -1;
@@ -1058,6 +1158,7 @@ int analyze_table(char *table, SBUF2 *sb, int scale, int override_llmeta,
     td.sb = sb;
     td.scale = scale;
     td.override_llmeta = override_llmeta;
+    td.ixmask = ixmask;
     strncpy0(td.table, table, sizeof(td.table));
 
     struct sql_thread *thd = pthread_getspecific(query_info_key);
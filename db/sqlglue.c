@@ -148,6 +148,7 @@ extern int sqldbgflag;
 extern int gbl_notimeouts;
 extern int gbl_move_deadlk_max_attempt;
 extern int gbl_fdb_track;
+extern int gbl_fdb_push_count;
 extern int gbl_selectv_rangechk;
 
 unsigned long long gbl_sql_deadlock_reconstructions = 0;
@@ -2417,6 +2418,33 @@ static int get_matching_genid(BtCursor *cur, int rrn, unsigned long long *genid)
     return 0;
 }
 
+/* Give a table cursor that keeps stepping forward a batch to buffer rows
+ * in; bdb will then hand out several rows per leaf visit. */
+static void cursor_attach_batch(BtCursor *pCur)
+{
+    bdb_cursor_batch_t *batch;
+    int maxrows, arenasz;
+
+    maxrows = bdb_attr_get(thedb->bdb_attr, BDB_ATTR_SQL_BATCH_SCAN_ROWS);
+    if (maxrows <= 1)
+        return;
+    arenasz = maxrows * ((getdatsize(pCur->db) + 7) & ~7);
+
+    batch = malloc(sizeof(bdb_cursor_batch_t) +
+                   maxrows * sizeof(bdb_cursor_batch_row_t) + arenasz);
+    if (!batch) {
+        logmsg(LOGMSG_ERROR, "%s: malloc %d rows failed\n", __func__, maxrows);
+        return;
+    }
+    batch->rows = (bdb_cursor_batch_row_t *)(batch + 1);
+    batch->maxrows = maxrows;
+    batch->arena = (char *)(batch->rows + maxrows);
+    batch->arenasz = arenasz;
+
+    pCur->batch = batch;
+    pCur->bdbcur->set_batch(pCur->bdbcur, batch);
+}
+
 static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
 {
     struct sql_thread *thd = pCur->thd;
@@ -2451,8 +2479,19 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
     if (thd)
         thd->nmove++;
 
+    if (how == CNEXT && !pCur->batch &&
+        ++pCur->num_nexts ==
+            bdb_attr_get(thedb->bdb_attr, BDB_ATTR_SQL_BATCH_SCAN_THRESHOLD) &&
+        bdb_attr_get(thedb->bdb_attr, BDB_ATTR_SQL_BATCH_SCAN))
+        cursor_attach_batch(pCur);
+
     bdberr = 0;
-    rc = ddguard_bdb_cursor_move(thd, pCur, 0, &bdberr, how, NULL, 0);
+    if (how == CNEXT && pCur->bdbcur->batched(pCur->bdbcur)) {
+        /* buffered rows are already copied out; no locks, no deadlocks */
+        rc = pCur->bdbcur->next(pCur->bdbcur, &bdberr);
+    } else {
+        rc = ddguard_bdb_cursor_move(thd, pCur, 0, &bdberr, how, NULL, 0);
+    }
     switch(bdberr) {
     case BDBERR_NOT_DURABLE: return SQLITE_CLIENT_CHANGENODE;
     case BDBERR_TRANTOOCOMPLEX: return SQLITE_TRANTOOCOMPLEX;
@@ -2966,6 +3005,44 @@ static int cursor_move_remote(BtCursor *pCur, int *pRes, int how)
     return SQLITE_OK;
 }
 
+/* count(*) over a remote table, computed remotely if the remote cursor can */
+static int cursor_count_remote(BtCursor *pCur, i64 *count)
+{
+    i64 cnt = 0;
+    int res;
+    int rc;
+
+    if (authenticate_cursor(pCur, AUTHENTICATE_READ) != 0)
+        return SQLITE_ACCESS;
+
+    assert(pCur->fdbc != NULL);
+
+    if (pCur->fdbc->count && pCur->fdbc->count(pCur) == IX_FND) {
+        unsigned char *row = (unsigned char *)pCur->fdbc->data(pCur);
+        u32 hdrsz, type;
+        Mem m;
+
+        sqlite3GetVarint32(row, &hdrsz);
+        sqlite3GetVarint32(row + 1, &type);
+        sqlite3VdbeSerialGet(row + hdrsz, type, &m);
+        *count = m.u.i;
+        return SQLITE_OK;
+    }
+
+    if (!pCur->fdbc)
+        return SQLITE_INTERNAL;
+
+    /* walk the rows; this also reports any remote error the proper way */
+    rc = cursor_move_remote(pCur, &res, CFIRST);
+    while (rc == SQLITE_OK && res == 0) {
+        ++cnt;
+        rc = cursor_move_remote(pCur, &res, CNEXT);
+    }
+    if (rc == SQLITE_OK)
+        *count = cnt;
+    return rc;
+}
+
 static inline int sqlite3VdbeCompareRecordPacked(KeyInfo *pKeyInfo, int k1len,
                                                  const void *key1, int k2len,
                                                  const void *key2)
@@ -6377,6 +6454,8 @@ skip:
                 rc = SQLITE_DEADLOCK;
             }
         }
+        free(pCur->batch);
+        pCur->batch = NULL;
         if (rc) {
             logmsg(LOGMSG_ERROR, "bdb_cursor_close: rc %d\n", bdberr);
             rc = SQLITE_INTERNAL;
@@ -7813,6 +7892,8 @@ sqlite3BtreeCursor_remote(Btree *pBt,      /* The btree */
 
     cur->cursor_class = CURSORCLASS_REMOTE;
     cur->cursor_move = cursor_move_remote;
+    if (gbl_fdb_push_count)
+        cur->cursor_count = cursor_count_remote;
 
     /* Reset previous fdb error (if any). */
     clnt->fdb_state.xerr.errval = 0;
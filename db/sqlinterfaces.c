@@ -137,6 +137,7 @@ extern unsigned long long gbl_sql_deadlock_failures;
 extern int gbl_allow_pragma;
 extern int g_osql_max_trans;
 extern int gbl_fdb_track;
+extern int gbl_fdb_stream_batch_bytes;
 extern int gbl_stable_rootpages_test;
 extern int gbl_verbose_normalized_queries;
 extern int gbl_group_concat_mem_limit;
@@ -192,7 +193,7 @@ int gbl_random_sql_work_rejected = 0;
 
 comdb2_query_preparer_t *query_preparer_plugin;
 
-void rcache_init(size_t, size_t);
+void rcache_init(size_t, size_t, int);
 void rcache_destroy(void);
 void sql_reset_sqlthread(struct sql_thread *thd);
 int blockproc2sql_error(int rc, const char *func, int line);
@@ -5730,6 +5731,8 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
     int rc = 0;
     int tmp;
     int sent;
+    int batch;
+    int unflushed = 0;
 
     if (!clnt->fdb_state.remote_sql_sb) {
         while ((ret = next_row(clnt, stmt)) == SQLITE_ROW)
@@ -5742,6 +5745,13 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
         else
             cid = (char *)&clnt->osql.rqid;
 
+        /* coalesce streamed rows into larger writes, unless the reader can
+           interleave its own updates with the stream (recom and serial) */
+        batch = gbl_fdb_stream_batch_bytes;
+        if (clnt->dbtran.mode == TRANLEVEL_RECOM ||
+            clnt->dbtran.mode == TRANLEVEL_SERIAL)
+            batch = 0;
+
         sent = 0;
         while (1) {
             /* NOTE: in the recom and serial mode, the cursors look at the
@@ -5768,9 +5778,13 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
 
             if (res.z) {
                 /* now we have the packed sqlite row in Mem->z */
+                unflushed += res.n;
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_FNDMORE,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID,
+                                     unflushed >= batch);
+                if (unflushed >= batch)
+                    unflushed = 0;
                 if (rc) {
                     /*
                     fprintf(stderr, "%s: failed to send back sql row\n",
@@ -5810,11 +5824,11 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
             if (sent == 1) {
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_FND,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID, 1);
             } else {
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_EMPTY,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID, 1);
             }
             if (rc) {
                 /*
@@ -5918,7 +5932,7 @@ done:
         tmp = tmp ? tmp : "error string not set";
         rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, (char *)tmp,
                              strlen(tmp) + 1, errstat_get_rc(&clnt->osql.xerr),
-                             clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                             clnt->osql.rqid == OSQL_RQID_USE_UUID, 1);
         if (rc) {
             logmsg(LOGMSG_ERROR,
                    "%s failed to send back error rc=%d errstr=%s\n", __func__,
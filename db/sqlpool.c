@@ -22,7 +22,7 @@
 
 extern int gbl_use_appsock_as_sqlthread;
 
-extern void rcache_init(size_t, size_t);
+extern void rcache_init(size_t, size_t, int);
 extern void rcache_destroy(void);
 
 typedef struct pool_foreach_data {
@@ -56,7 +56,8 @@ void sqlengine_thd_start(struct thdpool *pool, struct sqlthdstate *thd,
 
     thd->sqlthd = pthread_getspecific(query_info_key);
     rcache_init(bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_COUNT),
-                bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_PGSZ));
+                bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_PGSZ),
+                bdb_attr_get(thedb->bdb_attr, BDB_ATTR_RCACHE_LEVELS));
 }
 
 void sqlengine_thd_end(struct thdpool *pool, struct sqlthdstate *thd)
@@ -108,6 +109,26 @@ static void thdpool_sqlengine_dque(struct thdpool *pool, struct workitem *item,
                     comdb2_time_epochms() - item->queue_time_ms);
 }
 
+static unsigned thdpool_sqlengine_affinity_key(struct thdpool *pool,
+                                               void *work)
+{
+    struct sqlclntstate *clnt = work;
+    return stmt_cache_sql_hash(clnt->sql);
+}
+
+/* Prefer an idle sql thread that recently ran this query against the
+ * current schema, rather than preparing it again on another thread. */
+static int thdpool_sqlengine_affinity(struct thdpool *pool, unsigned key,
+                                      void *thddata)
+{
+    struct sqlthdstate *thd = thddata;
+
+    if (thd->dbopen_gen != bdb_get_dbopen_gen() ||
+        thd->analyze_gen != gbl_analyze_gen || thd->views_gen != gbl_views_gen)
+        return 0;
+    return stmt_cache_recent_sql(thd->stmt_cache, key);
+}
+
 static void clnt_queued_event(void *p)
 {
     struct sqlclntstate *clnt = (struct sqlclntstate *)p;
@@ -130,6 +151,8 @@ static struct thdpool *create_sql_pool(const char *zName, int nThreads)
     thdpool_set_delt_fn(pool, thdpool_sqlengine_end);
     thdpool_set_dque_fn(pool, thdpool_sqlengine_dque);
     thdpool_set_queued_callback(pool, clnt_queued_event);
+    thdpool_set_affinity_fn(pool, thdpool_sqlengine_affinity_key,
+                            thdpool_sqlengine_affinity);
 
     if (zName != NULL) {
         /* TODO: *TUNING* Defaults for non-default pools. */
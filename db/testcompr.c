@@ -81,6 +81,7 @@ typedef struct {
     SizeEst zlib;
     SizeEst crle;
     SizeEst lz4;
+    SizeEst lz4dict;
     char just_crle;
 } CompStruct;
 
@@ -229,6 +230,14 @@ static int test_compress(CompStruct *comp)
         comp->lz4.dtasz += rc;
     }
 
+    /* LZ4 with the table's trained dictionary, if it has one */
+    if ((rc = bdb_lz4dict_compress(comp->db->handle, comp->fnddta,
+                                   comp->fndlen, buf)) <= 0) {
+        comp->lz4dict.dtasz += comp->fndlen;
+    } else {
+        comp->lz4dict.dtasz += rc;
+    }
+
 blob:
     rc = 0;
     if (comp->db->numblobs) {
@@ -278,6 +287,12 @@ static void compr_stat(CompStruct *comp)
     print_compr_stat(comp, "RLE8", &comp->rle);
     print_compr_stat(comp, "zlib", &comp->zlib);
     print_compr_stat(comp, " LZ4", &comp->lz4);
+    int dictlen;
+    if (bdb_get_compr_dict_info(comp->db->handle, &dictlen)) {
+        /* blobs are never compressed with the dictionary */
+        comp->lz4dict.blobsz = comp->lz4.blobsz;
+        print_compr_stat(comp, "LZ4D", &comp->lz4dict);
+    }
 }
 
 static void *handle_comptest_thd(void *_arg)
@@ -334,6 +349,7 @@ static void *handle_comptest_thd(void *_arg)
         bzero(&comp.rle, sizeof(comp.rle));
         bzero(&comp.zlib, sizeof(comp.zlib));
         bzero(&comp.lz4, sizeof(comp.lz4));
+        bzero(&comp.lz4dict, sizeof(comp.lz4dict));
 
         iq.dbenv = thedb;
         iq.is_fake = 1;
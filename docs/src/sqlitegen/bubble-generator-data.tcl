@@ -358,7 +358,7 @@ set all_graphs {
       {line IPU OFF}
       {line ISC OFF}
       {line REBUILD}
-      {line REC {or NONE CRLE LZ4 RLE ZLIB}}
+      {line REC {or NONE CRLE LZ4 LZ4DICT RLE ZLIB}}
       {line BLOBFIELD {or NONE LZ4 RLE ZLIB}}
     } ,} 
   }
@@ -3136,10 +3136,88 @@ static int get_func_by_name(Lua L, const char *func, char **err)
     return 0;
 }
 
-static int process_src(Lua L, const char *src, char **err)
+/*
+** Compiled procedures, shared by all lua vms. Entries are keyed by sp name
+** and only used when the source matches, so a replaced procedure is simply
+** recompiled. The whole cache is dropped whenever gbl_lua_version moves.
+*/
+struct sp_chunk {
+    char spname[MAX_SPNAME];
+    char *src;
+    char *code;
+    size_t len;
+};
+static hash_t *sp_chunks;
+static int sp_chunks_version;
+static pthread_mutex_t sp_chunks_lk = PTHREAD_MUTEX_INITIALIZER;
+
+static int free_sp_chunk(void *obj, void *arg)
 {
-    int rc;
-    if ((rc = luaL_dostring(L, src)) != 0) {
+    struct sp_chunk *c = obj;
+    free(c->src);
+    free(c->code);
+    free(c);
+    return 0;
+}
+
+static int sp_chunk_writer(Lua L, const void *p, size_t sz, void *ud)
+{
+    struct sp_chunk *c = ud;
+    char *code = realloc(c->code, c->len + sz);
+    if (code == NULL) return 1;
+    memcpy(code + c->len, p, sz);
+    c->code = code;
+    c->len += sz;
+    return 0;
+}
+
+// Push compiled src; bytecode from the cache if we have it
+static int load_sp_chunk(Lua L, const char *spname, const char *src, char **err)
+{
+    struct sp_chunk *c;
+    int rc = -1;
+    Pthread_mutex_lock(&sp_chunks_lk);
+    if (sp_chunks == NULL) {
+        sp_chunks = hash_init_str(offsetof(struct sp_chunk, spname));
+    }
+    if (sp_chunks_version != gbl_lua_version) {
+        hash_for(sp_chunks, free_sp_chunk, NULL);
+        hash_clear(sp_chunks);
+        sp_chunks_version = gbl_lua_version;
+    }
+    c = hash_find(sp_chunks, spname);
+    if (c && strcmp(c->src, src) == 0) {
+        rc = luaL_loadbuffer(L, c->code, c->len, src);
+        if (rc) lua_pop(L, 1);
+    }
+    Pthread_mutex_unlock(&sp_chunks_lk);
+    if (rc == 0) return 0;
+
+    if (luaL_loadstring(L, src) != 0) {
+        *err = strdup(lua_tostring(L, -1));
+        return -1;
+    }
+    if (strlen(spname) >= MAX_SPNAME) return 0;
+    struct sp_chunk *n = calloc(1, sizeof(struct sp_chunk));
+    strcpy(n->spname, spname);
+    if (lua_dump(L, sp_chunk_writer, n) != 0 || (n->src = strdup(src)) == NULL) {
+        free_sp_chunk(n, NULL);
+        return 0;
+    }
+    Pthread_mutex_lock(&sp_chunks_lk);
+    if ((c = hash_find(sp_chunks, spname)) != NULL) {
+        hash_del(sp_chunks, c);
+        free_sp_chunk(c, NULL);
+    }
+    hash_add(sp_chunks, n);
+    Pthread_mutex_unlock(&sp_chunks_lk);
+    return 0;
+}
+
+static int process_src(Lua L, const char *spname, const char *src, char **err)
+{
+    if (load_sp_chunk(L, spname, src, err) != 0) return -1;
+    if (lua_pcall(L, 0, LUA_MULTRET, 0) != 0) {
         *err = strdup(lua_tostring(L, -1));
         return -1;
     }
@@ -3148,6 +3226,31 @@ static int process_src(Lua L, const char *src, char **err)
     return 0;
 }
 
+// Like process_src, but compile sp->src at most once per lua vm
+static int process_sp_src(SP sp, char **err)
+{
+    Lua L = sp->lua;
+    if (sp->src_ref == LUA_NOREF) {
+        if (load_sp_chunk(L, sp->spname, sp->src, err) != 0) return -1;
+        sp->src_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    lua_rawgeti(L, LUA_REGISTRYINDEX, sp->src_ref);
+    if (lua_pcall(L, 0, LUA_MULTRET, 0) != 0) {
+        *err = strdup(lua_tostring(L, -1));
+        return -1;
+    }
+    lua_settop(L, 0);
+    return 0;
+}
+
+static void drop_src_ref(SP sp)
+{
+    if (sp->lua && sp->src_ref != LUA_NOREF) {
+        luaL_unref(sp->lua, LUA_REGISTRYINDEX, sp->src_ref);
+    }
+    sp->src_ref = LUA_NOREF;
+}
+
 static void drop_temp_tables(SP sp)
 {
     int expire = 0;
@@ -3288,7 +3391,7 @@ static int db_create_thread_int(Lua lua, const char *funcname)
     newsp->parent_thd = thd;
     newsp->parent_sqlthd = sp->thd;
 
-    if (process_src(newlua, sp->src, &err) != 0) goto bad;
+    if (process_src(newlua, sp->spname, sp->src, &err) != 0) goto bad;
 
     if ((rc = get_func_by_name(newlua, funcname, &err)) != 0) {
         goto bad;
@@ -5194,6 +5297,7 @@ static int create_sp_int(SP sp, char **err)
     lua_atpanic(lua, l_panic);
 
     sp->lua = lua;
+    sp->src_ref = LUA_NOREF;
     sp->max_num_instructions = gbl_max_lua_instructions;
     LIST_INIT(&sp->dbstmts);
     LIST_INIT(&sp->tmptbls);
@@ -6202,6 +6306,7 @@ static int setup_sp(char *spname, struct sqlthdstate *thd,
             rdlock_schema_lk();
             locked = 1;
         }
+        drop_src_ref(sp);
         sp->src = load_src(spname, &sp->spversion, 1, err);
         sp->lua_version = gbl_lua_version;
         if (locked)
@@ -6894,7 +6999,7 @@ static int lua_step_int(char *spname, char **err, struct sqlthdstate *thd,
         remove_emit(L);
         remove_consumer(L);
         remove_tran_funcs(L);
-        if ((rc = process_src(L, sp->src, err)) != 0) return rc;
+        if ((rc = process_sp_src(sp, err)) != 0) return rc;
     }
     if ((rc = get_func_by_name(L, "step", err)) != 0) return rc;
     if ((rc = sqlite_to_lua(L, clnt->tzname, argc, argv)) != 0) return rc;
@@ -6913,7 +7018,7 @@ static int lua_func_int(char *spname, char **err, struct sqlthdstate *thd,
     remove_emit(L);
     remove_consumer(L);
     remove_tran_funcs(L);
-    if ((rc = process_src(L, sp->src, err)) != 0) return rc;
+    if ((rc = process_sp_src(sp, err)) != 0) return rc;
     if ((rc = get_func_by_name(L, spname, err)) != 0) return rc;
     if ((rc = sqlite_to_lua(L, clnt->tzname, argc, argv)) != 0) return rc;
     sp->num_instructions = 0;
@@ -6966,7 +7071,7 @@ static int exec_procedure_int(struct sqlthdstate *thd,
     SP sp = clnt->sp;
     Lua L = sp->lua;
 
-    if ((rc = process_src(L, sp->src, err)) != 0) return rc;
+    if ((rc = process_sp_src(sp, err)) != 0) return rc;
 
     if ((rc = get_func_by_name(L, "main", err)) != 0) return rc;
 
@@ -7004,7 +7109,7 @@ static int setup_sp_for_trigger(trigger_reg_t *reg, char **err,
     Lua L = sp->lua;
 
     if (new_vm) {
-        if ((rc = process_src(L, sp->src, err)) != 0) return rc;
+        if ((rc = process_sp_src(sp, err)) != 0) return rc;
     }
 
     if ((rc = get_func_by_name(L, "main", err)) != 0) return rc;
@@ -7101,7 +7206,7 @@ void lua_step(sqlite3_context *context, int argc, sqlite3_value **argv)
             if (strcmp(clnt->sp->spname, spname) == 0) {
                 // first call and have cached lua vm.
                 // reset it by parsing again.
-                process_src(clnt->sp->lua, clnt->sp->src, &err);
+                process_sp_src(clnt->sp, &err);
             }
         }
     }
@@ -43,6 +43,7 @@ struct stored_proc {
     char spname[MAX_SPNAME];
     struct spversion_t spversion;
     char *src;
+    int src_ref; // registry ref to compiled src
     struct sqlclntstate *clnt;
     struct sqlclntstate *debug_clnt;
     struct sqlthdstate *thd;
@@ -36,6 +36,8 @@
 #include <event2/thread.h>
 #include <event2/util.h>
 
+#include <lz4.h>
+
 #include <akbufferevent.h>
 #include <akq.h>
 #include <bb_oscompat.h>
@@ -53,6 +55,10 @@
 #include <portmuxapi.h>
 
 #define MB(x) ((x) * 1024 * 1024)
+#define KB(x) ((x) * 1024)
+
+/* LZ4 only looks back 64K, so larger frames buy little ratio */
+#define NET_FRAME_MAX KB(256)
 #define TCP_BUFSZ MB(8)
 #define MAX_DISTRESS_COUNT 10
 #define hprintf_lvl LOGMSG_USER
@@ -348,6 +354,7 @@ struct event_info {
     int distressed;
     int decomissioned;
     int got_hello;
+    int peer_caps; /* NET_CAP_* from the peer's hello */
 
     struct akbufferevent *flush_buf;
 
@@ -355,6 +362,7 @@ struct event_info {
     pthread_mutex_t wr_lk;
     struct evbuffer *wr_buf;
     int wr_full;
+    int wr_framed; /* sent WIRE_HEADER_COMPRESSED; flushes go out as frames */
 
     /* Read ops happen on read base */
     struct evbuffer *rd_evbuf;
@@ -364,6 +372,8 @@ struct event_info {
     uint64_t need;
     uint64_t rd_size; /* data enqueued in akq */
     int rd_full;
+    int rd_framed;
+    struct evbuffer *rd_plain; /* inflated frames */
     int state;
     wire_header_type hdr;
     net_send_message_header msg;
@@ -946,6 +956,8 @@ static void disable_write(int dummyfd, short what, void *data)
         e->wr_buf = NULL;
     }
     e->got_hello = 0;
+    e->peer_caps = 0;
+    e->wr_framed = 0;
 
 
     if (e->fd != -1) {
@@ -965,6 +977,11 @@ static void do_disable_read(struct event_info *e)
         e->rd_evbuf= NULL;
         event_del(&e->rd_event);
     }
+    if (e->rd_plain) {
+        evbuffer_free(e->rd_plain);
+        e->rd_plain = NULL;
+    }
+    e->rd_framed = 0;
 }
 
 static int truncate_func(void *work, void *arg)
@@ -1327,6 +1344,7 @@ static void hello_hdr_common(struct event_info *e, uint8_t *payload)
 
 static void hello_msg(struct event_info *e, uint8_t *payload)
 {
+    uint8_t *end = payload + e->need;
     uint32_t n;
     memcpy(&n, payload, sizeof(uint32_t));
     n = htonl(n);
@@ -1370,6 +1388,11 @@ static void hello_msg(struct event_info *e, uint8_t *payload)
             add_host(newhost);
         }
     }
+    uint32_t caps[2] = {0};
+    if ((uint8_t *)long_hosts + sizeof(caps) <= end) {
+        memcpy(caps, long_hosts, sizeof(caps));
+    }
+    e->peer_caps = ntohl(caps[0]) == NET_HELLO_CAPS_MAGIC ? ntohl(caps[1]) : 0;
     set_hello_message(e);
     int count = e->distress_count;
     /* Need to clear before we can print */
@@ -1497,6 +1520,62 @@ static void process_decom_hostname(struct event_info *e, uint8_t *payload)
     decom((char *)payload);
 }
 
+static int process_compressed(struct event_info *e, uint8_t *payload)
+{
+    uint32_t algo;
+    memcpy(&algo, payload, sizeof(uint32_t));
+    algo = ntohl(algo);
+    if (algo != NET_COMPRESS_LZ4) {
+        hprintf("UNKNOWN COMPRESSION:%u\n", algo);
+        return -1;
+    }
+    if (!e->rd_plain && (e->rd_plain = evbuffer_new()) == NULL) {
+        return -1;
+    }
+    e->rd_framed = 1;
+    message_done(e);
+    return 0;
+}
+
+/* Move every complete frame from the socket buffer to rd_plain */
+static int inflate_frames(struct event_info *e)
+{
+    struct evbuffer *input = e->rd_evbuf;
+    uint32_t hdr[2];
+    while (evbuffer_copyout(input, hdr, sizeof(hdr)) == sizeof(hdr)) {
+        uint32_t rawlen = ntohl(hdr[0]);
+        uint32_t cmplen = ntohl(hdr[1]);
+        if (rawlen > NET_FRAME_MAX || cmplen > rawlen) {
+            hprintf("BAD FRAME raw:%u cmp:%u\n", rawlen, cmplen);
+            return -1;
+        }
+        if (evbuffer_get_length(input) < sizeof(hdr) + cmplen) {
+            break;
+        }
+        evbuffer_drain(input, sizeof(hdr));
+        if (cmplen == rawlen) {
+            if (evbuffer_remove_buffer(input, e->rd_plain, rawlen) != rawlen) {
+                return -1;
+            }
+            continue;
+        }
+        struct iovec v[1];
+        uint8_t *src = evbuffer_pullup(input, cmplen);
+        if (src == NULL || evbuffer_reserve_space(e->rd_plain, rawlen, v, 1) != 1) {
+            return -1;
+        }
+        int n = LZ4_decompress_safe((char *)src, v[0].iov_base, cmplen, rawlen);
+        if (n != rawlen) {
+            hprintf("BAD FRAME raw:%u cmp:%u rc:%d\n", rawlen, cmplen, n);
+            return -1;
+        }
+        v[0].iov_len = rawlen;
+        evbuffer_commit_space(e->rd_plain, v, 1);
+        evbuffer_drain(input, cmplen);
+    }
+    return 0;
+}
+
 static int process_hdr(struct event_info *e, uint8_t *buf)
 {
     wire_header_type tmp;
@@ -1528,6 +1607,9 @@ static int process_hdr(struct event_info *e, uint8_t *buf)
     case WIRE_HEADER_ACK_PAYLOAD:
         e->need = NET_ACK_MESSAGE_PAYLOAD_TYPE_LEN;
         break;
+    case WIRE_HEADER_COMPRESSED:
+        e->need = sizeof(uint32_t);
+        break;
     default:
         hprintf("UNKNOWN HDR:%d\n", tmp.type);
         abort();
@@ -1560,6 +1642,8 @@ static int process_payload(struct event_info *e, uint8_t *payload)
     case WIRE_HEADER_ACK_PAYLOAD:
         process_ack_with_payload(e, payload);
         break;
+    case WIRE_HEADER_COMPRESSED:
+        return process_compressed(e, payload);
     default:
         hprintf("UNKNOWN HDR:%d\n", e->hdr.type);
         abort();
@@ -1607,6 +1691,12 @@ static void readcb(int fd, short what, void *data)
         n = 0;
     }
     evbuffer_commit_space(input, v, nv);
+    if (e->rd_framed) {
+        if (inflate_frames(e) != 0) {
+            DISABLE_AND_RECONNECT();
+        }
+        input = e->rd_plain;
+    }
     while (evbuffer_get_length(input) >= e->need) {
         if (e->need > e->rdbuf_sz) {
             if (e->rdbuf) {
@@ -1633,6 +1723,13 @@ static void readcb(int fd, short what, void *data)
         if (rc) {
             DISABLE_AND_RECONNECT();
         }
+        if (e->rd_framed && input == e->rd_evbuf) {
+            /* rest of the stream is framed */
+            if (inflate_frames(e) != 0) {
+                DISABLE_AND_RECONNECT();
+            }
+            input = e->rd_plain;
+        }
     }
 }
 
@@ -2560,8 +2657,70 @@ static void check_wr_full(struct event_info *e)
     }
 }
 
+/* Pack everything pending into frames of at most NET_FRAME_MAX. The first
+ * time, switch the peer over with WIRE_HEADER_COMPRESSED. */
+static void frame_evbuffer(struct event_info *e)
+{
+    netinfo_type *netinfo_ptr = e->net_info->netinfo_ptr;
+    stats_type *stats = &e->host_node_ptr->stats;
+    struct evbuffer *out = evbuffer_new();
+    if (out == NULL) {
+        reconnect(e);
+        return;
+    }
+    if (!e->wr_framed) {
+        uint32_t algo = htonl(NET_COMPRESS_LZ4);
+        evbuffer_add(out, e->wirehdr[WIRE_HEADER_COMPRESSED], e->wirehdr_len);
+        evbuffer_add(out, &algo, sizeof(algo));
+        e->wr_framed = 1;
+        hputs("SENDING COMPRESSED FRAMES\n");
+    }
+    size_t len;
+    while ((len = evbuffer_get_length(e->wr_buf)) != 0) {
+        if (len > NET_FRAME_MAX) {
+            len = NET_FRAME_MAX;
+        }
+        uint32_t hdr[2];
+        if (netinfo_ptr->compress == NET_COMPRESS_LZ4 &&
+            len >= netinfo_ptr->compress_min_bytes) {
+            struct iovec v[1];
+            int bound = LZ4_compressBound(len);
+            uint8_t *src = evbuffer_pullup(e->wr_buf, len);
+            if (src == NULL || evbuffer_reserve_space(out, sizeof(hdr) + bound, v, 1) != 1) {
+                break;
+            }
+            char *dst = (char *)v[0].iov_base + sizeof(hdr);
+            int cmplen = LZ4_compress_default((char *)src, dst, len, bound);
+            if (cmplen > 0 && cmplen < len) {
+                hdr[0] = htonl(len);
+                hdr[1] = htonl(cmplen);
+                memcpy(v[0].iov_base, hdr, sizeof(hdr));
+                v[0].iov_len = sizeof(hdr) + cmplen;
+                evbuffer_commit_space(out, v, 1);
+                evbuffer_drain(e->wr_buf, len);
+                stats->frame_raw += len;
+                stats->frame_bytes += v[0].iov_len;
+                continue;
+            }
+            /* incompressible - store it */
+        }
+        hdr[0] = hdr[1] = htonl(len);
+        evbuffer_add(out, hdr, sizeof(hdr));
+        evbuffer_remove_buffer(e->wr_buf, out, len);
+        stats->frame_raw += len;
+        stats->frame_bytes += sizeof(hdr) + len;
+    }
+    akbufferevent_add_buffer(e->flush_buf, out);
+    evbuffer_free(out);
+}
+
 static void flush_evbuffer(struct event_info *e)
 {
+    if (e->wr_framed || (e->net_info->netinfo_ptr->compress != NET_COMPRESS_NONE &&
+                         (e->peer_caps & NET_CAP_FRAMES))) {
+        frame_evbuffer(e);
+        return;
+    }
     akbufferevent_add_buffer(e->flush_buf, e->wr_buf);
 }
 
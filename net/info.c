@@ -83,6 +83,11 @@ static void basic_node_data(struct host_node_tag *ptr)
     logmsg(LOGMSG_USER, "  enque bytes %-5u peak %-5u at %s\n",
            ptr->enque_bytes, ptr->peak_enque_bytes,
            fmt_time(&t, ptr->peak_enque_bytes_time));
+
+    if (ptr->stats.frame_raw)
+        logmsg(LOGMSG_USER, "  frames raw %llu wire %llu (%.2fx)\n",
+               ptr->stats.frame_raw, ptr->stats.frame_bytes,
+               (double)ptr->stats.frame_raw / ptr->stats.frame_bytes);
 }
 
 static void basic_stat(netinfo_type *netinfo_ptr)
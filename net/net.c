@@ -1301,6 +1301,10 @@ static int write_hello_int(netinfo_type *netinfo_ptr, host_node_type *host_node_
         if (tmp_host_ptr->hostname_len > HOSTNAME_LEN)
             datasz += tmp_host_ptr->hostname_len;
     }
+
+    /* only the libevent reader understands compressed frames */
+    if (gbl_libevent)
+        datasz += sizeof(int) + sizeof(int); /* magic, caps */
     data = HOST_MALLOC(host_node_ptr, datasz);
     memset(data, 0, datasz);
 
@@ -1349,6 +1353,12 @@ static int write_hello_int(netinfo_type *netinfo_ptr, host_node_type *host_node_
                                p_buf, p_buf_end);
         }
     }
+    if (gbl_libevent) {
+        int magic = NET_HELLO_CAPS_MAGIC;
+        int caps = NET_CAP_FRAMES;
+        p_buf = buf_put(&magic, sizeof(int), p_buf, p_buf_end);
+        p_buf = buf_put(&caps, sizeof(int), p_buf, p_buf_end);
+    }
 
     Pthread_rwlock_unlock(&(netinfo_ptr->lock));
 
@@ -6033,6 +6043,13 @@ int net_set_max_bytes(netinfo_type *netinfo_ptr, uint64_t x)
     return 0;
 }
 
+int net_set_compress(netinfo_type *netinfo_ptr, int algo, int min_bytes)
+{
+    netinfo_ptr->compress_min_bytes = min_bytes;
+    netinfo_ptr->compress = algo;
+    return 0;
+}
+
 int net_sanctioned_list_ok(netinfo_type *netinfo_ptr)
 {
     sanc_node_type *sanc_node_ptr;
@@ -347,6 +347,11 @@ void net_cmd(netinfo_type *netinfo_ptr, char *line, int lline, int st, int op1);
 int net_set_max_queue(netinfo_type *netinfo_ptr, int x);
 int net_set_max_bytes(netinfo_type *netinfo_ptr, uint64_t x);
 
+enum { NET_COMPRESS_NONE = 0, NET_COMPRESS_LZ4 = 1 };
+/* Batch each flush into frames, compressing those of at least min_bytes.
+ * Only applies to peers which advertise support in their hello. */
+int net_set_compress(netinfo_type *netinfo_ptr, int algo, int min_bytes);
+
 int net_get_host_network_usage(netinfo_type *netinfo_ptr, const char *host,
                                unsigned long long *written,
                                unsigned long long *read,
@@ -63,6 +63,13 @@ enum { NET_WIRE_HEADER_TYPE_LEN = 16 + 4 + 4 + 16 + 4 + 4 + 4 };
 BB_COMPILE_TIME_ASSERT(net_write_header_type,
                        sizeof(wire_header_type) == NET_WIRE_HEADER_TYPE_LEN);
 
+/* Optional trailer on hello messages: magic followed by NET_CAP_* bits.
+ * Older nodes stop parsing after the host list and never see it. */
+#define NET_HELLO_CAPS_MAGIC 0x4e434150 /* "NCAP" */
+enum {
+    NET_CAP_FRAMES = 1 /* understands WIRE_HEADER_COMPRESSED */
+};
+
 /* We can't change the on-wire protocol easily.  So it
  * retains node numbers, but they're unused for now */
 /* type 0 is internal connect message.
@@ -147,6 +154,8 @@ typedef struct {
     unsigned long long bytes_read;
     unsigned long long throttle_waits;
     unsigned long long reorders;
+    unsigned long long frame_raw;   /* bytes packed into compressed frames */
+    unsigned long long frame_bytes; /* and what they took on the wire */
 } stats_type;
 
 typedef struct net_send_message_header {
@@ -357,6 +366,8 @@ struct netinfo_struct {
     int offload;
     uint32_t max_queue;
     uint64_t max_bytes;
+    int compress; /* NET_COMPRESS_* */
+    int compress_min_bytes;
     int exiting;
     int trace;
 
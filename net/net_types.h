@@ -39,6 +39,16 @@ net_send_message_payload_ack.
 WIRE_HEADER_HELLO, WIRE_HEADER_HELLO_REPLY, WIRE_HEADER_DECOM,
 WIRE_HEADER_DECOM_NAME do not have a struct defining the payload.
 Would be nice to have this.
+
+If wire_header_type.type == WIRE_HEADER_COMPRESSED, then payload is a
+uint32_t compression algorithm (NET_COMPRESS_*). It is only sent to peers
+whose hello advertised NET_CAP_FRAMES. Every byte that follows it on the
+connection is a sequence of frames:
+
+    uint32_t rawlen, uint32_t cmplen, cmplen bytes
+
+where cmplen == rawlen means the frame is stored uncompressed. The inflated
+frames form an ordinary message stream; a message may span frames.
 #endif
 
 enum {
@@ -51,6 +61,7 @@ enum {
     WIRE_HEADER_HELLO_REPLY = 7,
     WIRE_HEADER_DECOM_NAME = 8,
     WIRE_HEADER_ACK_PAYLOAD = 9,
+    WIRE_HEADER_COMPRESSED = 10,
     WIRE_HEADER_MAX
 };
 
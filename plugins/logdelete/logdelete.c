@@ -28,7 +28,7 @@ static int handle_logdelete_request(comdb2_appsock_arg_t *arg)
     struct log_delete_state log_delete_state;
     char recovery_command[200] = {0};
     char recovery_lsn[100] = {0};
-    char line[128] = {0};
+    char line[PATH_MAX] = {0};
     int before_master;
     int after_master;
     int before_sc;
@@ -115,6 +115,43 @@ static int handle_logdelete_request(comdb2_appsock_arg_t *arg)
                    recovery_command);
             sbuf2printf(sb, "%s\n", recovery_command);
             sbuf2flush(sb);
+        } else if (strcmp(tok, "pgtrack_rotate") == 0) {
+            unsigned long long epoch, acked;
+            if (bdb_pgtrack_rotate(&epoch, &acked) == 0) {
+                sbuf2printf(sb, "pgtrack %llu %llu\n", epoch, acked);
+            } else {
+                sbuf2printf(sb, "pgtrack off\n");
+            }
+            sbuf2flush(sb);
+        } else if (strcmp(tok, "pgtrack_pages") == 0) {
+            unsigned *pgnos = NULL, npgnos = 0, ii, first;
+            tok = strtok_r(NULL, delims, &lasts);
+            if (!tok || bdb_pgtrack_pages(tok, &pgnos, &npgnos) != 0) {
+                sbuf2printf(sb, "unknown\n");
+                sbuf2flush(sb);
+                continue;
+            }
+            /* one "first count" line per run of pages */
+            for (ii = 0; ii < npgnos; ii = first) {
+                for (first = ii + 1;
+                     first < npgnos && pgnos[first] == pgnos[first - 1] + 1;
+                     ++first)
+                    ;
+                sbuf2printf(sb, "%u %u\n", pgnos[ii], first - ii);
+            }
+            sbuf2printf(sb, ".\n");
+            sbuf2flush(sb);
+            free(pgnos);
+        } else if (strcmp(tok, "pgtrack_ack") == 0) {
+            unsigned long long epoch;
+            tok = strtok_r(NULL, delims, &lasts);
+            if (tok && (epoch = strtoull(tok, NULL, 10)) != 0 &&
+                bdb_pgtrack_ack(epoch) == 0) {
+                sbuf2printf(sb, "ok\n");
+            } else {
+                sbuf2printf(sb, "failed\n");
+            }
+            sbuf2flush(sb);
         } else {
             logmsg(LOGMSG_ERROR, "logdelete2 thread got unknown token <%s>\n",
                    tok);
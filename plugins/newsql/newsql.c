@@ -228,6 +228,7 @@ static inline char *skipws(char *str)
 }
 
 int gbl_abort_on_unset_ha_flag = 0;
+int gbl_newsql_stream_rows = 1;
 static int is_snap_uid_retry(struct sqlclntstate *clnt)
 {
     // Retries happen with a 'begin'.  This can't be a retry if we are already
@@ -631,8 +632,7 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
         if (!sqlite3_can_get_column_type_and_data(clnt, stmt) ||
                 column_type(clnt, stmt, i) == SQLITE_NULL) {
             newsql_null(cols, i);
-            if (clnt->flat_col_vals)
-                isnulls[i] = cols[i].has_isnull ? cols[i].isnull : 0;
+            isnulls[i] = 1;
             continue;
         }
         int type = appdata->type[i];
@@ -702,9 +702,24 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
             return -1;
         }
 
-        if (clnt->flat_col_vals)
-            bd[i] = cols[i].value;
+        bd[i] = cols[i].value;
     }
+
+    /* Stream the values straight to the client, without packing a
+     * CDB2SQLRESPONSE.  Postponed rows are kept in packed form. */
+    if (!postpone && gbl_newsql_stream_rows && appdata->write_row_impl) {
+        struct newsql_row_data row = {.ncols = ncols,
+                                      .flat = clnt->flat_col_vals,
+                                      .has_row_id = clnt->num_retry != 0,
+                                      .row_id = arg->row_id,
+                                      .values = bd,
+                                      .isnulls = isnulls};
+        if (arg->pingpong) {
+            return appdata->write_row_impl(clnt, RESPONSE_HEADER__SQL_RESPONSE_PING, &row, 1);
+        }
+        return appdata->write_row_impl(clnt, RESPONSE_HEADER__SQL_RESPONSE, &row, !clnt->rowbuffer);
+    }
+
     CDB2SQLRESPONSE r = CDB2__SQLRESPONSE__INIT;
     r.response_type = RESPONSE_TYPE__COLUMN_VALUES;
     if (clnt->flat_col_vals) {
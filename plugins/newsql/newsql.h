@@ -41,6 +41,16 @@ struct newsqlheader {
     int length;      /*  length of response */
 };
 
+/* One result row, encoded by write_row_impl as a COLUMN_VALUES response. */
+struct newsql_row_data {
+    int ncols;
+    int flat;       /* use CDB2SQLRESPONSE.values/isnulls, not nested columns */
+    int has_row_id;
+    uint64_t row_id;
+    const ProtobufCBinaryData *values;
+    const protobuf_c_boolean *isnulls;
+};
+
 struct newsql_postponed_data {
     size_t len;
     struct newsqlheader hdr;
@@ -62,6 +72,7 @@ struct newsql_appdata {
     int (*write_impl)(struct sqlclntstate *, int type, int state, const CDB2SQLRESPONSE *, int flush);
     int (*write_hdr_impl)(struct sqlclntstate *, int type, int state);
     int (*write_postponed_impl)(struct sqlclntstate *);
+    int (*write_row_impl)(struct sqlclntstate *, int type, const struct newsql_row_data *, int flush);
 
     struct sbuf2 *sb; /* Leaving here for now - until newsql_appdata_sbuf exists */
     CDB2QUERY *query;
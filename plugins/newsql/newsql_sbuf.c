@@ -132,6 +132,148 @@ out:unlock_client_write_lock(clnt);
     return rc;
 }
 
+/*
+** Hand-rolled encoder for COLUMN_VALUES responses. It emits the same bytes
+** protobuf-c would for the CDB2SQLRESPONSE newsql_row used to build, but
+** sizes the message arithmetically and writes column values from the
+** sqlite cells straight into the SBUF2 buffer. Tags and lengths are staged
+** in a small buffer so each column costs at most two sbuf2write calls.
+*/
+#define PB_TAG(field, wiretype) (((field) << 3) | (wiretype))
+#define PB_VARINT 0
+#define PB_LENDELIM 2
+
+struct pb_row_writer {
+    SBUF2 *sb;
+    int nbytes; /* bytes written */
+    int nstaged;
+    uint8_t staged[128];
+};
+
+static inline size_t pb_varint_size(uint64_t v)
+{
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+static inline void pb_row_flush(struct pb_row_writer *w)
+{
+    if (w->nstaged) {
+        w->nbytes += sbuf2write((char *)w->staged, w->nstaged, w->sb);
+        w->nstaged = 0;
+    }
+}
+
+static inline void pb_row_varint(struct pb_row_writer *w, uint64_t v)
+{
+    if (w->nstaged + 10 > sizeof(w->staged))
+        pb_row_flush(w);
+    while (v >= 0x80) {
+        w->staged[w->nstaged++] = (v & 0x7f) | 0x80;
+        v >>= 7;
+    }
+    w->staged[w->nstaged++] = v;
+}
+
+static inline void pb_row_bytes(struct pb_row_writer *w, int field, const ProtobufCBinaryData *v)
+{
+    pb_row_varint(w, PB_TAG(field, PB_LENDELIM));
+    pb_row_varint(w, v->len);
+    if (v->len == 0)
+        return;
+    if (v->len <= sizeof(w->staged) - w->nstaged) {
+        memcpy(w->staged + w->nstaged, v->data, v->len);
+        w->nstaged += v->len;
+        return;
+    }
+    pb_row_flush(w);
+    w->nbytes += sbuf2write((char *)v->data, v->len, w->sb);
+}
+
+/* CDB2SQLRESPONSE.column: value = 2, isnull = 3 (only when set) */
+static inline size_t pb_column_size(const ProtobufCBinaryData *v, int isnull)
+{
+    return 1 + pb_varint_size(v->len) + v->len + (isnull ? 2 : 0);
+}
+
+static size_t pb_row_size(const struct newsql_row_data *row)
+{
+    size_t len = 4; /* response_type = 1, error_code = 4 */
+    for (int i = 0; i < row->ncols; ++i) {
+        const ProtobufCBinaryData *v = &row->values[i];
+        if (row->flat) {
+            len += 1 + pb_varint_size(v->len) + v->len + 2; /* values = 12, isnulls = 13 */
+        } else {
+            size_t col = pb_column_size(v, row->isnulls[i]);
+            len += 1 + pb_varint_size(col) + col; /* value = 2 */
+        }
+    }
+    if (row->has_row_id)
+        len += 1 + pb_varint_size(row->row_id); /* row_id = 8 */
+    if (row->flat)
+        len += 2; /* flat_col_vals = 11 */
+    return len;
+}
+
+static int newsql_write_row_sbuf(struct sqlclntstate *clnt, int t,
+                                 const struct newsql_row_data *row, int flush)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    struct pb_row_writer w = {.sb = appdata->sb};
+    size_t len = pb_row_size(row);
+    struct newsqlheader hdr = {0};
+    hdr.type = htonl(t);
+    hdr.length = htonl(len);
+    int rc;
+    lock_client_write_lock(clnt);
+    if ((rc = sbuf2write((char *)&hdr, sizeof(hdr), appdata->sb)) != sizeof(hdr))
+        goto out;
+
+    /* Fields go out in field number order, as protobuf-c packs them. */
+    pb_row_varint(&w, PB_TAG(1, PB_VARINT));
+    pb_row_varint(&w, RESPONSE_TYPE__COLUMN_VALUES);
+    if (!row->flat) {
+        for (int i = 0; i < row->ncols; ++i) {
+            const ProtobufCBinaryData *v = &row->values[i];
+            pb_row_varint(&w, PB_TAG(2, PB_LENDELIM));
+            pb_row_varint(&w, pb_column_size(v, row->isnulls[i]));
+            pb_row_bytes(&w, 2, v);
+            if (row->isnulls[i]) {
+                pb_row_varint(&w, PB_TAG(3, PB_VARINT));
+                pb_row_varint(&w, 1);
+            }
+        }
+    }
+    pb_row_varint(&w, PB_TAG(4, PB_VARINT));
+    pb_row_varint(&w, 0);
+    if (row->has_row_id) {
+        pb_row_varint(&w, PB_TAG(8, PB_VARINT));
+        pb_row_varint(&w, row->row_id);
+    }
+    if (row->flat) {
+        pb_row_varint(&w, PB_TAG(11, PB_VARINT));
+        pb_row_varint(&w, 1);
+        for (int i = 0; i < row->ncols; ++i)
+            pb_row_bytes(&w, 12, &row->values[i]);
+        for (int i = 0; i < row->ncols; ++i) {
+            pb_row_varint(&w, PB_TAG(13, PB_VARINT));
+            pb_row_varint(&w, row->isnulls[i] ? 1 : 0);
+        }
+    }
+    pb_row_flush(&w);
+    if ((rc = w.nbytes) != len)
+        goto out;
+    if (flush && (rc = sbuf2flush(appdata->sb)) < 0)
+        goto out;
+    rc = 0;
+out:unlock_client_write_lock(clnt);
+    return rc;
+}
+
 static int newsql_write_hdr_sbuf(struct sqlclntstate *clnt, int h, int state)
 {
     struct newsql_appdata *appdata = clnt->appdata;
@@ -286,6 +428,7 @@ static void setup_newsql_clnt_sbuf(struct sqlclntstate *clnt, SBUF2 *sb)
     appdata->write_impl = newsql_write_sbuf;
     appdata->write_hdr_impl = newsql_write_hdr_sbuf;
     appdata->write_postponed_impl = newsql_write_postponed_sbuf;
+    appdata->write_row_impl = newsql_write_row_sbuf;
     appdata->has_ssl_impl = newsql_has_ssl_sbuf;
     appdata->has_x509_impl = newsql_has_x509_sbuf;
     appdata->get_x509_attr_impl = newsql_get_x509_attr_sbuf;
@@ -611,12 +754,73 @@ static void free_newsql_appdata(struct sqlclntstate *clnt)
 }
 
 
-#define APPDATA ((struct newsql_appdata *)(clnt.appdata))
+#define APPDATA ((struct newsql_appdata *)(clnt->appdata))
+static void newsql_done(struct sqlclntstate *clnt, CDB2QUERY *query)
+{
+    SBUF2 *sb = APPDATA->sb;
+
+    sbuf2setclnt(sb, NULL);
+    clnt_unregister(clnt);
+
+    if (clnt->ctrl_sqlengine == SQLENG_INTRANS_STATE) {
+        handle_sql_intrans_unrecoverable_error(clnt);
+    }
+
+    if (clnt->rawnodestats) {
+        release_node_stats(clnt->argv0, clnt->stack, clnt->origin);
+        clnt->rawnodestats = NULL;
+    }
+
+    if (clnt->argv0) {
+        free(clnt->argv0);
+        clnt->argv0 = NULL;
+    }
+
+    if (clnt->stack) {
+        free(clnt->stack);
+        clnt->stack = NULL;
+    }
+
+    close_sp(clnt);
+    osql_clean_sqlclntstate(clnt);
+
+    if (clnt->dbglog) {
+        sbuf2close(clnt->dbglog);
+        clnt->dbglog = NULL;
+    }
+
+    if (query) {
+        cdb2__query__free_unpacked(query, &APPDATA->newsql_protobuf_allocator.protobuf_allocator);
+    }
+
+    free_newsql_appdata(clnt);
+
+    /* XXX free logical tran?  */
+    close_appsock(sb);
+    cleanup_clnt(clnt);
+    free(clnt);
+}
+
+static int newsql_serve(struct sqlclntstate *, CDB2QUERY *,
+                        struct thr_handle *);
+
+/* Called from an appsock thread once a parked connection is readable again */
+static void newsql_resume(void *arg, struct thr_handle *thr_self)
+{
+    struct sqlclntstate *clnt = arg;
+    CDB2QUERY *query = NULL;
+
+    if (thr_self) {
+        thrman_change_type(thr_self, THRTYPE_APPSOCK_SQL);
+        query = read_newsql_query(thedb, clnt, APPDATA->sb);
+    }
+    newsql_serve(clnt, query, thr_self);
+}
+
 static int handle_newsql_request(comdb2_appsock_arg_t *arg)
 {
     CDB2QUERY *query = NULL;
-    int rc = 0;
-    struct sqlclntstate clnt;
+    struct sqlclntstate *clnt;
     struct thr_handle *thr_self;
     struct sbuf2 *sb;
     struct dbenv *dbenv;
@@ -665,29 +869,30 @@ static int handle_newsql_request(comdb2_appsock_arg_t *arg)
     */
     thrman_change_type(thr_self, THRTYPE_APPSOCK_SQL);
 
-    setup_newsql_clnt_sbuf(&clnt, sb);
+    clnt = malloc(sizeof(struct sqlclntstate));
+    setup_newsql_clnt_sbuf(clnt, sb);
 
     char *origin = get_origin_mach_by_buf(sb);
-    clnt.origin = origin ? origin : intern("???");
-    clnt.tzname[0] = '\0';
-    clnt.admin = arg->admin;
-    sbuf_set_timeout(&clnt, sb, gbl_sqlwrtimeoutms);
+    clnt->origin = origin ? origin : intern("???");
+    clnt->tzname[0] = '\0';
+    clnt->admin = arg->admin;
+    sbuf_set_timeout(clnt, sb, gbl_sqlwrtimeoutms);
 
-    clnt_register(&clnt);
+    clnt_register(clnt);
 
-    if (incoh_reject(clnt.admin, thedb->bdb_env)) {
+    if (incoh_reject(clnt->admin, thedb->bdb_env)) {
         logmsg(LOGMSG_ERROR,
                "%s:%d td %u new query on incoherent node, dropping socket\n",
                __func__, __LINE__, (uint32_t)pthread_self());
         goto done;
     }
 
-    query = read_newsql_query(dbenv, &clnt, sb);
+    query = read_newsql_query(dbenv, clnt, sb);
     if (query == NULL) {
         goto done;
     }
 
-    if (!clnt.admin && check_active_appsock_connections(&clnt)) {
+    if (!clnt->admin && check_active_appsock_connections(clnt)) {
         static time_t pr = 0;
         time_t now;
 
@@ -701,7 +906,7 @@ static int handle_newsql_request(comdb2_appsock_arg_t *arg)
             pr = now;
         }
 
-        write_response(&clnt, RESPONSE_ERROR, "Exhausted appsock connections.", CDB2__ERROR_CODE__APPSOCK_LIMIT);
+        write_response(clnt, RESPONSE_ERROR, "Exhausted appsock connections.", CDB2__ERROR_CODE__APPSOCK_LIMIT);
         goto done;
     }
 
@@ -718,29 +923,44 @@ static int handle_newsql_request(comdb2_appsock_arg_t *arg)
 
     for (int ii = 0; ii < sql_query->n_features; ++ii) {
         if (CDB2_CLIENT_FEATURES__FLAT_COL_VALS == sql_query->features[ii]) {
-            clnt.flat_col_vals = 1;
+            clnt->flat_col_vals = 1;
             break;
         }
     }
 
-    if (!clnt.admin && do_query_on_master_check(dbenv, &clnt, sql_query))
+    if (!clnt->admin && do_query_on_master_check(dbenv, clnt, sql_query))
         goto done;
 
     if (sql_query->client_info) {
-        clnt.conninfo.pid = sql_query->client_info->pid;
-        clnt.last_pid = sql_query->client_info->pid;
+        clnt->conninfo.pid = sql_query->client_info->pid;
+        clnt->last_pid = sql_query->client_info->pid;
     }
     else {
-        clnt.conninfo.pid = 0;
-        clnt.last_pid = 0;
+        clnt->conninfo.pid = 0;
+        clnt->last_pid = 0;
     }
-    clnt.osql.count_changes = 1;
-    clnt.dbtran.mode = tdef_to_tranlevel(gbl_sql_tranlevel_default);
-    clnt.plugin.clr_high_availability(&clnt);
+    clnt->osql.count_changes = 1;
+    clnt->dbtran.mode = tdef_to_tranlevel(gbl_sql_tranlevel_default);
+    clnt->plugin.clr_high_availability(clnt);
 
     sbuf2flush(sb);
     net_set_writefn(sb, sql_writer);
-    sbuf2setclnt(sb, &clnt);
+    sbuf2setclnt(sb, clnt);
+
+    return newsql_serve(clnt, query, thr_self);
+
+done:
+    newsql_done(clnt, query);
+    return APPSOCK_RETURN_OK;
+}
+
+static int newsql_serve(struct sqlclntstate *clnt, CDB2QUERY *query,
+                        struct thr_handle *thr_self)
+{
+    struct dbenv *dbenv = thedb;
+    SBUF2 *sb = APPDATA->sb;
+    CDB2SQLQUERY *sql_query;
+    int rc = 0;
 
     while (query) {
         sql_query = query->sqlquery;
@@ -754,23 +974,23 @@ static int handle_newsql_request(comdb2_appsock_arg_t *arg)
 #endif
         APPDATA->query = query;
         APPDATA->sqlquery = sql_query;
-        clnt.sql = sql_query->sql_query;
-        clnt.added_to_hist = 0;
-
-        if (!in_client_trans(&clnt)) {
-            bzero(&clnt.effects, sizeof(clnt.effects));
-            bzero(&clnt.log_effects, sizeof(clnt.log_effects));
-            clnt.had_errors = 0;
-            clnt.ctrl_sqlengine = SQLENG_NORMAL_PROCESS;
+        clnt->sql = sql_query->sql_query;
+        clnt->added_to_hist = 0;
+
+        if (!in_client_trans(clnt)) {
+            bzero(&clnt->effects, sizeof(clnt->effects));
+            bzero(&clnt->log_effects, sizeof(clnt->log_effects));
+            clnt->had_errors = 0;
+            clnt->ctrl_sqlengine = SQLENG_NORMAL_PROCESS;
         }
-        if (clnt.dbtran.mode < TRANLEVEL_SOSQL) {
-            clnt.dbtran.mode = TRANLEVEL_SOSQL;
+        if (clnt->dbtran.mode < TRANLEVEL_SOSQL) {
+            clnt->dbtran.mode = TRANLEVEL_SOSQL;
         }
-        clnt.osql.sent_column_data = 0;
-        clnt.stop_this_statement = 0;
+        clnt->osql.sent_column_data = 0;
+        clnt->stop_this_statement = 0;
 
-        if (clnt.tzname[0] == '\0' && sql_query->tzname)
-            strncpy0(clnt.tzname, sql_query->tzname, sizeof(clnt.tzname));
+        if (clnt->tzname[0] == '\0' && sql_query->tzname)
+            strncpy0(clnt->tzname, sql_query->tzname, sizeof(clnt->tzname));
 
         if (sql_query->dbname && dbenv->envname && strcasecmp(sql_query->dbname, dbenv->envname)) {
             char errstr[64 + (2 * MAX_DBNAME_LENGTH)];
@@ -778,166 +998,139 @@ static int handle_newsql_request(comdb2_appsock_arg_t *arg)
                      "DB name mismatch query:%s actual:%s", sql_query->dbname,
                      dbenv->envname);
             logmsg(LOGMSG_ERROR, "%s\n", errstr);
-            write_response(&clnt, RESPONSE_ERROR, errstr, CDB2__ERROR_CODE__WRONG_DB);
+            write_response(clnt, RESPONSE_ERROR, errstr, CDB2__ERROR_CODE__WRONG_DB);
             goto done;
         }
 
         if (sql_query->client_info) {
-            if (clnt.rawnodestats) {
-                release_node_stats(clnt.argv0, clnt.stack, clnt.origin);
-                clnt.rawnodestats = NULL;
+            if (clnt->rawnodestats) {
+                release_node_stats(clnt->argv0, clnt->stack, clnt->origin);
+                clnt->rawnodestats = NULL;
             }
-            if (clnt.conninfo.pid && clnt.conninfo.pid != sql_query->client_info->pid) {
+            if (clnt->conninfo.pid && clnt->conninfo.pid != sql_query->client_info->pid) {
                 /* Different pid is coming without reset. */
                 logmsg(LOGMSG_WARN,
                        "Multiple processes using same socket PID 1 %d PID 2 %d Host %.8x\n",
-                       clnt.conninfo.pid, sql_query->client_info->pid,
+                       clnt->conninfo.pid, sql_query->client_info->pid,
                        sql_query->client_info->host_id);
             }
-            clnt.conninfo.pid = sql_query->client_info->pid;
-            clnt.conninfo.node = sql_query->client_info->host_id;
-            if (clnt.argv0) {
-                free(clnt.argv0);
-                clnt.argv0 = NULL;
+            clnt->conninfo.pid = sql_query->client_info->pid;
+            clnt->conninfo.node = sql_query->client_info->host_id;
+            if (clnt->argv0) {
+                free(clnt->argv0);
+                clnt->argv0 = NULL;
             }
-            if (clnt.stack) {
-                free(clnt.stack);
-                clnt.stack = NULL;
+            if (clnt->stack) {
+                free(clnt->stack);
+                clnt->stack = NULL;
             }
             if (sql_query->client_info->argv0) {
-                clnt.argv0 = strdup(sql_query->client_info->argv0);
+                clnt->argv0 = strdup(sql_query->client_info->argv0);
             }
             if (sql_query->client_info->stack) {
-                clnt.stack = strdup(sql_query->client_info->stack);
+                clnt->stack = strdup(sql_query->client_info->stack);
             }
         }
 
-        if (clnt.rawnodestats == NULL) {
-            clnt.rawnodestats = get_raw_node_stats(
-                clnt.argv0, clnt.stack, clnt.origin, sbuf2fileno(sb));
+        if (clnt->rawnodestats == NULL) {
+            clnt->rawnodestats = get_raw_node_stats(
+                clnt->argv0, clnt->stack, clnt->origin, sbuf2fileno(sb));
         }
 
-        if (process_set_commands(&clnt, sql_query))
+        if (process_set_commands(clnt, sql_query))
             goto done;
 
-        if (gbl_rowlocks && clnt.dbtran.mode != TRANLEVEL_SERIAL)
-            clnt.dbtran.mode = TRANLEVEL_SNAPISOL;
+        if (gbl_rowlocks && clnt->dbtran.mode != TRANLEVEL_SERIAL)
+            clnt->dbtran.mode = TRANLEVEL_SNAPISOL;
 
         /* avoid new accepting new queries/transaction on opened connections
            if we are incoherent (and not in a transaction). */
-        if (incoh_reject(clnt.admin, thedb->bdb_env) &&
-            (clnt.ctrl_sqlengine == SQLENG_NORMAL_PROCESS)) {
+        if (incoh_reject(clnt->admin, thedb->bdb_env) &&
+            (clnt->ctrl_sqlengine == SQLENG_NORMAL_PROCESS)) {
             logmsg(LOGMSG_ERROR,
                    "%s line %d td %u new query on incoherent node, dropping socket\n",
                    __func__, __LINE__, (uint32_t)pthread_self());
             goto done;
         }
 
-        clnt.heartbeat = 1;
+        clnt->heartbeat = 1;
         ATOMIC_ADD32(gbl_nnewsql, 1);
 
-        int isCommitRollback = (strncasecmp(clnt.sql, "commit", 6) == 0 ||
-                                 strncasecmp(clnt.sql, "rollback", 8) == 0);
+        int isCommitRollback = (strncasecmp(clnt->sql, "commit", 6) == 0 ||
+                                 strncasecmp(clnt->sql, "rollback", 8) == 0);
 
-        if (!clnt.had_errors || isCommitRollback) {
+        if (!clnt->had_errors || isCommitRollback) {
             /* tell blobmem that I want my priority back
                when the sql thread is done */
             comdb2bma_pass_priority_back(blobmem);
-            rc = dispatch_sql_query(&clnt);
+            rc = dispatch_sql_query(clnt);
 
-            if (clnt.had_errors && isCommitRollback) {
+            if (clnt->had_errors && isCommitRollback) {
                 rc = -1;
             }
         }
-        clnt_change_state(&clnt, CONNECTION_IDLE);
+        clnt_change_state(clnt, CONNECTION_IDLE);
 
-        if (clnt.osql.replay == OSQL_RETRY_DO) {
-            if (clnt.dbtran.trans_has_sp) {
-                osql_set_replay(__FILE__, __LINE__, &clnt, OSQL_RETRY_NONE);
-                srs_tran_destroy(&clnt);
+        if (clnt->osql.replay == OSQL_RETRY_DO) {
+            if (clnt->dbtran.trans_has_sp) {
+                osql_set_replay(__FILE__, __LINE__, clnt, OSQL_RETRY_NONE);
+                srs_tran_destroy(clnt);
                 newsql_protobuf_reset_offset(&APPDATA->newsql_protobuf_allocator);
             } else {
-                rc = srs_tran_replay(&clnt, arg->thr_self);
+                rc = srs_tran_replay(clnt, thr_self);
             }
 
-            if (clnt.osql.history == NULL) {
+            if (clnt->osql.history == NULL) {
                 query = APPDATA->query = NULL;
             }
         } else {
             /* if this transaction is done (marked by SQLENG_NORMAL_PROCESS),
                clean transaction sql history
             */
-            if (clnt.osql.history && clnt.ctrl_sqlengine == SQLENG_NORMAL_PROCESS) {
-                srs_tran_destroy(&clnt);
+            if (clnt->osql.history && clnt->ctrl_sqlengine == SQLENG_NORMAL_PROCESS) {
+                srs_tran_destroy(clnt);
                 newsql_protobuf_reset_offset(&APPDATA->newsql_protobuf_allocator);
                 query = APPDATA->query = NULL;
             }
         }
 
-        if (!in_client_trans(&clnt)) {
+        if (!in_client_trans(clnt)) {
             newsql_protobuf_reset_offset(&APPDATA->newsql_protobuf_allocator);
             if (rc) {
                 goto done;
             }
         }
 
-        if (clnt.added_to_hist) {
-            clnt.added_to_hist = 0;
+        if (clnt->added_to_hist) {
+            clnt->added_to_hist = 0;
         } else if (APPDATA->query) {
             /* cleanup if we did not add to history (single stmt or select inside a tran) */
             cdb2__query__free_unpacked(APPDATA->query, &APPDATA->newsql_protobuf_allocator.protobuf_allocator);
             APPDATA->query = NULL;
-            /* clnt.sql points into the protobuf unpacked buffer, which becomes
+            /* clnt->sql points into the protobuf unpacked buffer, which becomes
              * invalid after cdb2__query__free_unpacked. Reset the pointer here.
              */
-            clnt.sql = NULL;
+            clnt->sql = NULL;
         }
 
-        query = read_newsql_query(dbenv, &clnt, sb);
-    }
-
-done:
-    sbuf2setclnt(sb, NULL);
-    clnt_unregister(&clnt);
-
-    if (clnt.ctrl_sqlengine == SQLENG_INTRANS_STATE) {
-        handle_sql_intrans_unrecoverable_error(&clnt);
-    }
-
-    if (clnt.rawnodestats) {
-        release_node_stats(clnt.argv0, clnt.stack, clnt.origin);
-        clnt.rawnodestats = NULL;
-    }
-
-    if (clnt.argv0) {
-        free(clnt.argv0);
-        clnt.argv0 = NULL;
-    }
-
-    if (clnt.stack) {
-        free(clnt.stack);
-        clnt.stack = NULL;
-    }
-
-    close_sp(&clnt);
-    osql_clean_sqlclntstate(&clnt);
+        /* Between requests, give the thread back rather than sit in read()
+           if nothing of the next request has arrived yet. Connections in a
+           transaction keep their thread. */
+        if (gbl_appsock_park_idle && !in_client_trans(clnt) &&
+            clnt->osql.history == NULL && sbuf2pending(sb) == 0) {
+            int idle = disable_server_sql_timeouts()
+                           ? 0
+                           : bdb_attr_get(dbenv->bdb_attr,
+                                          BDB_ATTR_MAX_SQL_IDLE_TIME);
+            if (appsock_park(sb, clnt->admin, idle, newsql_resume, clnt) == 0)
+                return APPSOCK_RETURN_OK;
+        }
 
-    if (clnt.dbglog) {
-        sbuf2close(clnt.dbglog);
-        clnt.dbglog = NULL;
+        query = read_newsql_query(dbenv, clnt, sb);
     }
 
-    if (query) {
-        cdb2__query__free_unpacked(query, &APPDATA->newsql_protobuf_allocator.protobuf_allocator);
-    }
-
-    free_newsql_appdata(&clnt);
-
-    /* XXX free logical tran?  */
-    close_appsock(sb);
-    arg->sb = NULL;
-    cleanup_clnt(&clnt);
-
+done:
+    newsql_done(clnt, query);
     return APPSOCK_RETURN_OK;
 }
 
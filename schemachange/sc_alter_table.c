@@ -663,6 +663,31 @@ int do_alter_table_normal(struct ireq *iq, struct schema_change_type *s,
                          newdb->instant_schema_change, newdb->schema_version,
                          s->compress, s->compress_blobs, datacopy_odh);
 
+    /* records are about to be rewritten, so train on the current ones first;
+     * a rebuild of an lz4dict table retrains.  if there is too little data
+     * the table uses plain lz4 until it is rebuilt again.  the dictionary
+     * stays pending until finalize makes it a version in its transaction, so
+     * a failed alter leaves no version behind. */
+    if (s->compress == BDB_COMPRESS_LZ4DICT) {
+        int dictver;
+        bdb_load_compr_dicts(newdb->handle, NULL);
+        if (s->resume) {
+            if (bdb_load_compr_dict_pending(newdb->handle, NULL) != 0) {
+                sc_errf(s, "failed loading pending compression dictionary\n");
+                delete_temp_table(iq, newdb);
+                change_schemas_recover(s->tablename);
+                return -1;
+            }
+        } else if (bdb_del_compr_dict_pending(NULL, db->tablename) == 0 &&
+                   (scinfo.olddb_compress != BDB_COMPRESS_LZ4DICT ||
+                    s->force_rebuild || s->force_dta_rebuild) &&
+                   bdb_train_compr_dict_pending(db->handle, newdb->handle,
+                                                &dictver, &bdberr) == 0) {
+            sc_printf(s, "Trained compression dictionary version %d\n",
+                      dictver);
+        }
+    }
+
     /* set sc_genids, 0 them if we are starting a new schema change, or
      * restore them to their previous values if we are resuming */
     if (init_sc_genids(newdb, s)) {
@@ -788,7 +813,7 @@ errout:
         backout_constraint_pointers(newdb, db);
         delete_temp_table(iq, newdb);
         change_schemas_recover(s->tablename);
-
+        bdb_del_compr_dict_pending(NULL, db->tablename);
 
         return rc;
     }
@@ -861,6 +886,7 @@ int finalize_alter_table(struct ireq *iq, struct schema_change_type *s,
     struct dbtable *newdb = s->newdb;
     void *old_bdb_handle, *new_bdb_handle;
     int olddb_bthashsz;
+    int dictver;
 
     iq->usedb = db;
 
@@ -1072,6 +1098,14 @@ int finalize_alter_table(struct ireq *iq, struct schema_change_type *s,
         sc_printf(s, "Reusing version %llu for same schema\n", db->tableversion);
     }    
 
+    /* the dictionary the new records were compressed with */
+    if (s->compress == BDB_COMPRESS_LZ4DICT &&
+        (rc = bdb_commit_compr_dict_pending(transac, db->tablename,
+                                            &dictver)) != 0) {
+        sc_errf(s, "Failed committing compression dictionary rc %d\n", rc);
+        goto failed;
+    }
+
     set_odh_options_tran(db, transac);
 
     if (olddb_bthashsz) {
@@ -117,6 +117,11 @@ int finalize_drop_table(struct ireq *iq, struct schema_change_type *s,
     bdberr = bdb_reset_csc2_version(tran, db->tablename, db->schema_version);
     if (bdberr != BDBERR_NOERROR) return -1;
 
+    if ((rc = bdb_del_compr_dicts(tran, db->tablename)) != 0) {
+        sc_errf(s, "Failed deleting compression dictionaries rc %d\n", rc);
+        return rc;
+    }
+
     if ((rc = bdb_del_file_versions(db->handle, tran, &bdberr))) {
         sc_errf(s, "%s: bdb_del_file_versions failed with rc: %d bdberr: "
                    "%d\n",
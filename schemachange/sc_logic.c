@@ -1444,6 +1444,7 @@ int delete_temp_table(struct ireq *iq, struct dbtable *newdb)
 int do_setcompr(struct ireq *iq, const char *rec, const char *blob)
 {
     int rc;
+    int dictver = 0, bdberr = 0;
     tran_type *tran = NULL;
     if ((rc = trans_start(iq, NULL, &tran)) != 0) {
         sbuf2printf(iq->sb, ">%s -- trans_start rc:%d\n", __func__, rc);
@@ -1458,6 +1459,14 @@ int do_setcompr(struct ireq *iq, const char *rec, const char *blob)
 
     if (rec) ra = bdb_compr2algo(rec);
     if (blob) ba = bdb_compr2algo(blob);
+
+    /* asking for lz4dict again retrains; older records keep their version */
+    if (rec && ra == BDB_COMPRESS_LZ4DICT &&
+        bdb_train_compr_dict(db->handle, tran, &dictver, &bdberr) != 0) {
+        sbuf2printf(iq->sb, ">%s -- no dictionary trained, bdberr:%d\n",
+                    __func__, bdberr);
+    }
+
     bdb_set_odh_options(db->handle, db->odh, ra, ba);
     if ((rc = put_db_compress(db, tran, ra)) != 0) goto out;
     if ((rc = put_db_compress_blobs(db, tran, ba)) != 0) goto out;
@@ -1466,13 +1475,20 @@ int do_setcompr(struct ireq *iq, const char *rec, const char *blob)
                __func__, db->tablename, bdb_algo2compr(ra), bdb_algo2compr(ba));
     } else {
         sbuf2printf(iq->sb, ">%s -- trans_commit rc:%d\n", __func__, rc);
+        dictver = 0;
     }
     tran = NULL;
 
-    int bdberr = 0;
+    bdberr = 0;
     if ((rc = bdb_llog_scdone(db->handle, setcompr, 1, &bdberr)) != 0) {
         logmsg(LOGMSG_ERROR, "%s -- bdb_llog_scdone rc:%d bdberr:%d\n",
                __func__, rc, bdberr);
+    } else if (dictver) {
+        /* only compress with the new dictionary once replicants have
+         * loaded it with the scdone */
+        bdb_load_compr_dicts(db->handle, NULL);
+        sbuf2printf(iq->sb, ">%s -- dictionary version %d\n", __func__,
+                    dictver);
     }
 
 out:
@@ -1060,6 +1060,13 @@ void set_odh_options_tran(struct dbtable *db, tran_type *tran)
                          db->instant_schema_change, db->schema_version, compr,
                          blob_compr, datacopy_odh);
 
+    /* pick up dictionaries trained since the table was opened; this is how
+     * replicants learn about them, before any record using them is read */
+    if (bdb_load_compr_dicts(db->handle, tran) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: failed to load dictionaries for %s\n",
+               __func__, db->tablename);
+    }
+
     /*
     if (db->schema_version < 0)
         return -1;
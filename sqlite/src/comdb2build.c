@@ -362,6 +362,8 @@ static void fillTableOption(struct schema_change_type* sc, int opt)
         sc->compress = BDB_COMPRESS_ZLIB;
     else if (OPT_ON(opt, REC_LZ4))
         sc->compress = BDB_COMPRESS_LZ4;
+    else if (OPT_ON(opt, REC_LZ4DICT))
+        sc->compress = BDB_COMPRESS_LZ4DICT;
 
     if (OPT_ON(opt, FORCE_REBUILD))
         sc->force_rebuild = 1;
@@ -3874,6 +3876,7 @@ static int retrieve_table_options(struct dbtable *table)
     case BDB_COMPRESS_CRLE: table_options |= REC_CRLE; break;
     case BDB_COMPRESS_ZLIB: table_options |= REC_ZLIB; break;
     case BDB_COMPRESS_LZ4: table_options |= REC_LZ4; break;
+    case BDB_COMPRESS_LZ4DICT: table_options |= REC_LZ4DICT; break;
     case BDB_COMPRESS_NONE: table_options |= REC_NONE; break;
     default: assert(0);
     }
@@ -3882,7 +3885,8 @@ static int retrieve_table_options(struct dbtable *table)
     case BDB_COMPRESS_RLE8: table_options |= BLOB_RLE; break;
     case BDB_COMPRESS_CRLE: table_options |= BLOB_CRLE; break;
     case BDB_COMPRESS_ZLIB: table_options |= BLOB_ZLIB; break;
-    case BDB_COMPRESS_LZ4: table_options |= BLOB_LZ4; break;
+    case BDB_COMPRESS_LZ4:
+    case BDB_COMPRESS_LZ4DICT: table_options |= BLOB_LZ4; break;
     case BDB_COMPRESS_NONE: table_options |= BLOB_NONE; break;
     default: assert(0);
     }
@@ -363,6 +363,7 @@ static Keyword aKeywordTable[] = {
   { "KW",               "TK_KW",             ALWAYS               },
   { "LUA",              "TK_LUA",            ALWAYS               },
   { "LZ4",              "TK_LZ4",            ALWAYS               },
+  { "LZ4DICT",          "TK_LZ4DICT",        ALWAYS               },
   { "NEXTSEQUENCE",     "TK_CTIME_KW",       ALWAYS               },
   { "NONE",             "TK_NONE",           ALWAYS               },
   { "OP",               "TK_OP",             ALWAYS               },
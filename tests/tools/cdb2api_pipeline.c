@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <cdb2api.h>
+
+#define NSTMTS 50
+
+static int fail(cdb2_hndl_tp *hndl, const char *what, int rc)
+{
+    fprintf(stderr, "%s: rc %d: %s\n", what, rc, cdb2_errstr(hndl));
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    cdb2_hndl_tp *hndl = NULL;
+    const char *conf = getenv("CDB2_CONFIG");
+    const char *db, *tier;
+    char sql[64];
+    int64_t val;
+    int i, rc, nrows;
+
+    if (argc < 2)
+        return 1;
+
+    db = argv[1];
+
+    if (argc > 2)
+        tier = argv[2];
+    else
+        tier = "default";
+
+    if (conf != NULL)
+        cdb2_set_comdb2db_config(conf);
+
+    rc = cdb2_open(&hndl, db, tier, 0);
+    if (rc != 0)
+        return fail(hndl, "cdb2_open", rc);
+
+    /* Pipelining needs an established connection */
+    if ((rc = cdb2_submit_statement(hndl, "SELECT 1")) != CDB2ERR_NOTCONNECTED)
+        return fail(hndl, "submit before connect", rc);
+    if ((rc = cdb2_run_statement(hndl, "SELECT 1")) != 0)
+        return fail(hndl, "connect", rc);
+    if (cdb2_get_fd(hndl) < 0)
+        return fail(hndl, "cdb2_get_fd", -1);
+
+    /* Submit everything, then read results back in order */
+    cdb2_hndl_set_max_submitted(hndl, NSTMTS);
+    for (i = 0; i < NSTMTS; i++) {
+        val = i;
+        cdb2_clearbindings(hndl);
+        cdb2_bind_param(hndl, "v", CDB2_INTEGER, &val, sizeof(val));
+        snprintf(sql, sizeof(sql), "SELECT value FROM generate_series(1, @v)");
+        if ((rc = cdb2_submit_statement(hndl, sql)) != 0)
+            return fail(hndl, "cdb2_submit_statement", rc);
+    }
+    cdb2_clearbindings(hndl);
+    if (cdb2_submitted(hndl) != NSTMTS)
+        return fail(hndl, "cdb2_submitted", cdb2_submitted(hndl));
+    if ((rc = cdb2_submit_statement(hndl, "SELECT 1")) != CDB2ERR_BADSTATE)
+        return fail(hndl, "submit past the limit", rc);
+
+    if ((rc = cdb2_run_statement(hndl, "SELECT 1")) != CDB2ERR_BADSTATE)
+        return fail(hndl, "run with pending statements", rc);
+
+    for (i = 0; i < NSTMTS; i++) {
+        while ((rc = cdb2_poll_statement(hndl, 1000)) == 0)
+            ;
+        if (rc != 1)
+            return fail(hndl, "cdb2_poll_statement", rc);
+        if ((rc = cdb2_next_statement(hndl)) != 0)
+            return fail(hndl, "cdb2_next_statement", rc);
+        /* leave every other result set unread; it is skipped */
+        if (i % 2)
+            continue;
+        nrows = 0;
+        while ((rc = cdb2_next_record(hndl)) == CDB2_OK) {
+            nrows++;
+            if (*(int64_t *)cdb2_column_value(hndl, 0) != nrows)
+                return fail(hndl, "unexpected value", nrows);
+        }
+        if (rc != CDB2_OK_DONE)
+            return fail(hndl, "cdb2_next_record", rc);
+        if (nrows != i)
+            return fail(hndl, "unexpected row count", nrows);
+    }
+
+    if ((rc = cdb2_next_statement(hndl)) != CDB2ERR_NOSTATEMENT)
+        return fail(hndl, "next with nothing submitted", rc);
+
+    /* Errors are reported by the statement that caused them */
+    if ((rc = cdb2_submit_statement(hndl, "SELECT * FROM no_such_table")) != 0)
+        return fail(hndl, "submit bad", rc);
+    if ((rc = cdb2_submit_statement(hndl, "SELECT 42")) != 0)
+        return fail(hndl, "submit good", rc);
+    if ((rc = cdb2_next_statement(hndl)) != CDB2ERR_PREPARE_ERROR)
+        return fail(hndl, "bad statement", rc);
+    if ((rc = cdb2_next_statement(hndl)) != 0)
+        return fail(hndl, "good statement", rc);
+    if ((rc = cdb2_next_record(hndl)) != CDB2_OK ||
+        *(int64_t *)cdb2_column_value(hndl, 0) != 42)
+        return fail(hndl, "good statement row", rc);
+
+    /* Back to synchronous use */
+    if ((rc = cdb2_run_statement(hndl, "SELECT 1")) != 0)
+        return fail(hndl, "synchronous after pipeline", rc);
+    while ((rc = cdb2_next_record(hndl)) == CDB2_OK)
+        ;
+
+    cdb2_close(hndl);
+    printf("Passed\n");
+    return 0;
+}
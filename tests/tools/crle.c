@@ -331,6 +331,88 @@ static void test_repeat_rev()
     fprintf(stderr, "passed %s\n", __func__);
 }
 
+/* mostly runs of zeros and spaces with some random bytes, like a wide row
+ * with a lot of null or short fields */
+static void sparse_record(uint8_t *buf, size_t sz)
+{
+    size_t i = 0;
+    while (i < sz) {
+        size_t len = 1 + rand() % 64;
+        if (len > sz - i)
+            len = sz - i;
+        switch (rand() % 4) {
+        case 0: memset(buf + i, 0x00, len); break;
+        case 1: memset(buf + i, 0x20, len); break;
+        case 2: memcpy(buf + i, p3, len < sizeof(p3) ? len : sizeof(p3)); break;
+        default:
+            for (size_t j = 0; j < len; ++j)
+                buf[i + j] = rand();
+        }
+        i += len;
+    }
+}
+
+static void test_kernels()
+{
+    const char *name = comdb2rle_init();
+    uint8_t a[300], b[300];
+    srand(1);
+    for (int i = 0; i < 100000; ++i) {
+        size_t n = rand() % sizeof(a);
+        memset(a, 0xdb, n);
+        memcpy(b, a, n);
+        if (n && rand() % 4)
+            b[rand() % n] ^= 1 << (rand() % 8);
+        assert(mismatch(a, b, n) == mismatch_scalar(a, b, n));
+        assert(mismatch_rev(a, b, n) == mismatch_rev_scalar(a, b, n));
+#ifdef __x86_64__
+        assert(mismatch_sse2(a, b, n) == mismatch_scalar(a, b, n));
+        assert(mismatch_rev_sse2(a, b, n) == mismatch_rev_scalar(a, b, n));
+#endif
+    }
+
+    /* compressed output must not depend on the kernels */
+    mismatch_t fwd = mismatch, rev = mismatch_rev;
+    uint8_t in[4096], out[2][8192];
+    uint16_t hints[sizeof(in) + 1];
+    for (int i = 0; i < 2000; ++i) {
+        size_t n = 1 + rand() % sizeof(in);
+        sparse_record(in, n);
+        size_t nhints = 0, left = n;
+        while (left) {
+            hints[nhints] = 1 + rand() % 16;
+            if (hints[nhints] > left)
+                hints[nhints] = left;
+            left -= hints[nhints++];
+        }
+        hints[nhints] = 0;
+        Comdb2RLE c[2], h[2];
+        for (int k = 0; k < 2; ++k) {
+            mismatch = k ? fwd : mismatch_scalar;
+            mismatch_rev = k ? rev : mismatch_rev_scalar;
+            c[k] = (Comdb2RLE){.in = in, .insz = n, .out = out[k], .outsz = sizeof(out[k])};
+            assert(compressComdb2RLE(&c[k]) == 0);
+        }
+        assert(c[0].outsz == c[1].outsz);
+        assert(memcmp(out[0], out[1], c[0].outsz) == 0);
+        for (int k = 0; k < 2; ++k) {
+            mismatch = k ? fwd : mismatch_scalar;
+            mismatch_rev = k ? rev : mismatch_rev_scalar;
+            h[k] = (Comdb2RLE){.in = in, .insz = n, .out = out[k], .outsz = sizeof(out[k])};
+            assert(compressComdb2RLE_hints(&h[k], hints) == 0);
+        }
+        assert(h[0].outsz == h[1].outsz);
+        assert(memcmp(out[0], out[1], h[0].outsz) == 0);
+
+        uint8_t dec[sizeof(in)];
+        assert(mydecode(out[1], h[1].outsz, dec, sizeof(dec)) == 0);
+        assert(memcmp(in, dec, n) == 0);
+    }
+    mismatch = fwd;
+    mismatch_rev = rev;
+    fprintf(stderr, "passed %s (%s)\n", __func__, name);
+}
+
 int main(int argc, char *argv[])
 {
     test_varint();
@@ -341,6 +423,7 @@ int main(int argc, char *argv[])
     test_encode_repeat();
     test_encode_well_known();
     test_decode();
+    test_kernels();
 
     fprintf(stderr, "PASSED ALL TESTS\n");
     return EXIT_SUCCESS;
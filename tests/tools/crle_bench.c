@@ -0,0 +1,139 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* Times CRLE compress/decompress of wide, sparse records with the portable
+ * and the cpu-selected run-detection kernels.
+ *
+ * usage: crle_bench [record-size] [records] [passes] */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#undef NDEBUG
+#include <assert.h>
+#include <comdb2rle.c> //need access to static funcs
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* fixed-width fields, most of them null or zero, the rest random */
+static void make_record(uint8_t *buf, size_t sz)
+{
+    size_t i = 0;
+    while (i < sz) {
+        // mix of numeric fields and wide character fields
+        size_t len = rand() % 4 ? 5 + (rand() % 4) * 4 : 32 + rand() % 224;
+        if (len > sz - i)
+            len = sz - i;
+        int kind = rand() % 10;
+        if (kind < 5)
+            memcpy(buf + i, p0, len < sizeof(p0) ? len : sizeof(p0));
+        else if (kind < 7)
+            memcpy(buf + i, p3, len < sizeof(p3) ? len : sizeof(p3));
+        else if (kind < 8)
+            memset(buf + i, 0x00, len);
+        else
+            for (size_t j = 0; j < len; ++j)
+                buf[i + j] = rand();
+        if (len > sizeof(p0) && kind < 7)
+            memset(buf + i + sizeof(p0), 0x00, len - sizeof(p0));
+        i += len;
+    }
+}
+
+static void run(const char *name, uint8_t *in, size_t recsz, int nrecs,
+                int passes, uint8_t *cmp, size_t *cmpsz, uint8_t *out)
+{
+    size_t total = (size_t)recsz * nrecs * passes;
+    size_t outsz = 0;
+
+    double start = now();
+    for (int p = 0; p < passes; ++p) {
+        for (int i = 0; i < nrecs; ++i) {
+            Comdb2RLE c = {.in = in + i * recsz, .insz = recsz,
+                           .out = cmp + i * recsz * 2, .outsz = recsz * 2};
+            assert(compressComdb2RLE(&c) == 0);
+            cmpsz[i] = c.outsz;
+        }
+    }
+    double comp = now() - start;
+    for (int i = 0; i < nrecs; ++i)
+        outsz += cmpsz[i];
+
+    start = now();
+    for (int p = 0; p < passes; ++p) {
+        for (int i = 0; i < nrecs; ++i) {
+            Comdb2RLE d = {.in = cmp + i * recsz * 2, .insz = cmpsz[i],
+                           .out = out + i * recsz, .outsz = recsz};
+            assert(decompressComdb2RLE(&d) == 0);
+            assert(d.outsz == recsz);
+        }
+    }
+    double decomp = now() - start;
+    assert(memcmp(in, out, recsz * nrecs) == 0);
+
+    printf("%-8s ratio %5.2f  compress %8.1f MB/s  decompress %8.1f MB/s\n",
+           name, (double)recsz * nrecs / outsz, total / comp / 1e6,
+           total / decomp / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t recsz = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+    int nrecs = argc > 2 ? atoi(argv[2]) : 1000;
+    int passes = argc > 3 ? atoi(argv[3]) : 20;
+
+    uint8_t *in = malloc(recsz * nrecs);
+    uint8_t *cmp[2] = {malloc(recsz * nrecs * 2), malloc(recsz * nrecs * 2)};
+    size_t *cmpsz[2] = {malloc(sizeof(size_t) * nrecs),
+                        malloc(sizeof(size_t) * nrecs)};
+    uint8_t *out = malloc(recsz * nrecs);
+    assert(in && cmp[0] && cmp[1] && cmpsz[0] && cmpsz[1] && out);
+
+    srand(1);
+    for (int i = 0; i < nrecs; ++i)
+        make_record(in + i * recsz, recsz);
+
+    printf("%d records of %zu bytes, %d passes\n", nrecs, recsz, passes);
+
+    mismatch = mismatch_scalar;
+    mismatch_rev = mismatch_rev_scalar;
+    run("scalar", in, recsz, nrecs, passes, cmp[0], cmpsz[0], out);
+
+    const char *name = comdb2rle_init();
+    run(name, in, recsz, nrecs, passes, cmp[1], cmpsz[1], out);
+
+    /* the kernels must not change the encoding */
+    for (int i = 0; i < nrecs; ++i) {
+        assert(cmpsz[0][i] == cmpsz[1][i]);
+        assert(memcmp(cmp[0] + i * recsz * 2, cmp[1] + i * recsz * 2,
+                      cmpsz[0][i]) == 0);
+    }
+
+    free(in);
+    free(cmp[0]);
+    free(cmp[1]);
+    free(cmpsz[0]);
+    free(cmpsz[1]);
+    free(out);
+    return EXIT_SUCCESS;
+}
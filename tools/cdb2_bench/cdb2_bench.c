@@ -0,0 +1,728 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * cdb2_bench: repeatable microbenchmarks for the storage hot paths.
+ *
+ * Most benchmarks run against a private berkdb environment or temp tables
+ * created under the directory given with -d, so no running database is
+ * needed and the numbers are comparable across builds.  The table cursor
+ * benches (cursor_next, cursor_find) need the database given with -s, and
+ * are skipped without it.  Each run prints one JSON object per line on
+ * stdout:
+ *
+ *   {"bench":"cursor_next","run":0,"ops":100000,"usec":51234,...}
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bdb_api.h>
+#include <bdb_int.h>
+#include <cdb2api.h>
+#include <comdb2rle.h>
+#include <crc32c.h>
+#include <epochlib.h>
+#include <locks_wrap.h>
+
+extern int comdb2ma_init(size_t init_sz, size_t max_cap);
+extern pthread_key_t comdb2_open_key;
+extern int gbl_temptable_pool_capacity;
+
+#define BENCH_DATALEN 64
+#define BENCH_RECLEN 256
+
+struct bench_opts {
+    const char *dir;
+    const char *dbname; /* for the benches that need a database */
+    const char *tier;
+    int nops;
+    int nthreads;
+    int nlockobjs;
+    int repeats;
+};
+
+struct bench_result {
+    long long ops;
+    int64_t usec;
+    int has_latency; /* per-op latency, only for benches that track it */
+    int64_t p50_usec;
+    int64_t p99_usec;
+};
+
+typedef int (*bench_fn)(const struct bench_opts *, struct bench_result *);
+
+struct bench_env {
+    DB_ENV *dbenv;
+    DB *dbp;
+};
+
+static const char *progname = "cdb2_bench";
+
+/* Visit 0..n-1 in a scattered but repeatable order. */
+static inline uint64_t bench_key(int i, int n)
+{
+    return ((uint64_t)i * 2654435761ULL) % (uint64_t)n;
+}
+
+static inline void bench_putkey(uint8_t *buf, uint64_t k)
+{
+    for (int i = 7; i >= 0; i--) {
+        buf[i] = k & 0xff;
+        k >>= 8;
+    }
+}
+
+static int bench_env_open(const struct bench_opts *o, struct bench_env *e,
+                          u_int32_t flags, int is_tmp)
+{
+    int ret;
+
+    memset(e, 0, sizeof(*e));
+    if ((ret = db_env_create(&e->dbenv, 0)) != 0) {
+        fprintf(stderr, "%s: db_env_create: %s\n", progname,
+                db_strerror(ret));
+        return ret;
+    }
+    e->dbenv->set_errfile(e->dbenv, stderr);
+    e->dbenv->set_errpfx(e->dbenv, progname);
+    if (is_tmp && (ret = e->dbenv->set_is_tmp_tbl(e->dbenv, 1)) != 0) {
+        e->dbenv->err(e->dbenv, ret, "set_is_tmp_tbl");
+        goto err;
+    }
+    if ((ret = e->dbenv->set_cachesize(e->dbenv, 0, 64 * 1024 * 1024, 1)) !=
+        0) {
+        e->dbenv->err(e->dbenv, ret, "set_cachesize");
+        goto err;
+    }
+    if ((ret = e->dbenv->open(e->dbenv, o->dir,
+                              DB_CREATE | DB_PRIVATE | DB_THREAD | flags,
+                              0666)) != 0) {
+        e->dbenv->err(e->dbenv, ret, "open %s", o->dir);
+        goto err;
+    }
+    return 0;
+
+err:
+    e->dbenv->close(e->dbenv, 0);
+    e->dbenv = NULL;
+    return ret;
+}
+
+static void bench_env_close(struct bench_env *e)
+{
+    if (e->dbp)
+        e->dbp->close(e->dbp, 0);
+    if (e->dbenv)
+        e->dbenv->close(e->dbenv, 0);
+    memset(e, 0, sizeof(*e));
+}
+
+/* Open (and with fill, populate) the btree used by the cursor benches. */
+static int bench_btree_open(const struct bench_opts *o, struct bench_env *e,
+                            int fill, struct bench_result *r)
+{
+    uint8_t kbuf[8], dbuf[BENCH_DATALEN];
+    DBT key = {0}, data = {0};
+    int ret;
+
+    if ((ret = bench_env_open(o, e, DB_INIT_MPOOL, 0)) != 0)
+        return ret;
+    if ((ret = db_create(&e->dbp, e->dbenv, 0)) != 0) {
+        e->dbenv->err(e->dbenv, ret, "db_create");
+        return ret;
+    }
+    if ((ret = e->dbp->open(e->dbp, NULL, "bench.db", NULL, DB_BTREE,
+                            DB_CREATE | DB_TRUNCATE | DB_THREAD, 0666)) != 0) {
+        e->dbenv->err(e->dbenv, ret, "open bench.db");
+        return ret;
+    }
+    if (!fill)
+        return 0;
+
+    memset(dbuf, 'x', sizeof(dbuf));
+    key.data = kbuf;
+    key.size = sizeof(kbuf);
+    data.data = dbuf;
+    data.size = sizeof(dbuf);
+
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < o->nops; i++) {
+        bench_putkey(kbuf, bench_key(i, o->nops));
+        if ((ret = e->dbp->put(e->dbp, NULL, &key, &data, 0)) != 0) {
+            e->dbenv->err(e->dbenv, ret, "put");
+            return ret;
+        }
+    }
+    if (r) {
+        r->ops = o->nops;
+        r->usec = comdb2_time_epochus() - start;
+    }
+    return 0;
+}
+
+static int bench_btree_insert(const struct bench_opts *o,
+                              struct bench_result *r)
+{
+    struct bench_env e;
+    int ret = bench_btree_open(o, &e, 1, r);
+    bench_env_close(&e);
+    return ret;
+}
+
+/* The table benches go through a running database, so sql table cursors
+ * (bdb/cursor.c, including its batched scans) are what gets timed.  Each
+ * run recreates and fills BENCH_TABLE; the fill is not timed. */
+#define BENCH_TABLE "cdb2_bench"
+#define BENCH_FILL_CHUNK 10000
+
+static int bench_sql_run(cdb2_hndl_tp *hndl, const char *sql, long long *nrows)
+{
+    int rc;
+
+    if ((rc = cdb2_run_statement(hndl, sql)) != CDB2_OK) {
+        fprintf(stderr, "%s: %s: %s\n", progname, sql, cdb2_errstr(hndl));
+        return rc;
+    }
+    while ((rc = cdb2_next_record(hndl)) == CDB2_OK) {
+        if (nrows)
+            (*nrows)++;
+    }
+    if (rc != CDB2_OK_DONE) {
+        fprintf(stderr, "%s: %s: %s\n", progname, sql, cdb2_errstr(hndl));
+        return rc;
+    }
+    return 0;
+}
+
+static int bench_sql_open(const struct bench_opts *o, cdb2_hndl_tp **hndl)
+{
+    char sql[256];
+    int rc;
+
+    if ((rc = cdb2_open(hndl, o->dbname, o->tier, 0)) != CDB2_OK) {
+        fprintf(stderr, "%s: cdb2_open %s %s: %s\n", progname, o->dbname,
+                o->tier, cdb2_errstr(*hndl));
+        return rc;
+    }
+    if ((rc = bench_sql_run(*hndl, "DROP TABLE IF EXISTS " BENCH_TABLE,
+                            NULL)) != 0 ||
+        (rc = bench_sql_run(*hndl,
+                            "CREATE TABLE " BENCH_TABLE
+                            " (k INT PRIMARY KEY, d BLOB)",
+                            NULL)) != 0)
+        return rc;
+
+    for (int lo = 0; lo < o->nops; lo += BENCH_FILL_CHUNK) {
+        int hi = lo + BENCH_FILL_CHUNK - 1;
+        if (hi >= o->nops)
+            hi = o->nops - 1;
+        snprintf(sql, sizeof(sql),
+                 "INSERT INTO " BENCH_TABLE " SELECT value, randomblob(%d) "
+                 "FROM generate_series(%d, %d)",
+                 BENCH_DATALEN, lo, hi);
+        if ((rc = bench_sql_run(*hndl, sql, NULL)) != 0)
+            return rc;
+    }
+    return 0;
+}
+
+static void bench_sql_close(cdb2_hndl_tp *hndl)
+{
+    if (hndl == NULL)
+        return;
+    bench_sql_run(hndl, "DROP TABLE IF EXISTS " BENCH_TABLE, NULL);
+    cdb2_close(hndl);
+}
+
+static int bench_cursor_next(const struct bench_opts *o,
+                             struct bench_result *r)
+{
+    cdb2_hndl_tp *hndl = NULL;
+    int ret;
+
+    if ((ret = bench_sql_open(o, &hndl)) != 0)
+        goto done;
+
+    int64_t start = comdb2_time_epochus();
+    ret = bench_sql_run(hndl, "SELECT k, d FROM " BENCH_TABLE, &r->ops);
+    r->usec = comdb2_time_epochus() - start;
+
+done:
+    bench_sql_close(hndl);
+    return ret;
+}
+
+static int bench_cursor_find(const struct bench_opts *o,
+                             struct bench_result *r)
+{
+    cdb2_hndl_tp *hndl = NULL;
+    long long nrows = 0;
+    int64_t k;
+    int ret;
+
+    if ((ret = bench_sql_open(o, &hndl)) != 0)
+        goto done;
+    if ((ret = cdb2_bind_param(hndl, "k", CDB2_INTEGER, &k, sizeof(k))) != 0) {
+        fprintf(stderr, "%s: cdb2_bind_param: %s\n", progname,
+                cdb2_errstr(hndl));
+        goto done;
+    }
+
+    /* Probe in a different order than the keys were inserted. */
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < o->nops; i++) {
+        k = (int64_t)bench_key(o->nops - 1 - i, o->nops);
+        if ((ret = bench_sql_run(hndl,
+                                 "SELECT d FROM " BENCH_TABLE " WHERE k = @k",
+                                 &nrows)) != 0)
+            goto done;
+        r->ops++;
+    }
+    r->usec = comdb2_time_epochus() - start;
+
+    if (nrows != o->nops) {
+        fprintf(stderr, "%s: found %lld of %d keys\n", progname, nrows,
+                o->nops);
+        ret = -1;
+    }
+
+done:
+    if (hndl)
+        cdb2_clearbindings(hndl);
+    bench_sql_close(hndl);
+    return ret;
+}
+
+/* Just enough of a parent bdb handle for the temp table code: attributes,
+ * a scratch directory and the list the closed tables are cached on.  The
+ * temp table pool is off in this process, so no sql thread state is
+ * needed. */
+static bdb_state_type *bench_temp_state_open(const struct bench_opts *o)
+{
+    bdb_state_type *s;
+
+    if ((s = calloc(1, sizeof(bdb_state_type))) == NULL)
+        return NULL;
+    Pthread_mutex_init(&s->temp_list_lock, NULL);
+    s->attr = bdb_attr_create();
+    s->tmpdir = strdup(o->dir);
+    s->temp_stats = calloc(1, sizeof(DB_MPOOL_STAT));
+    if (s->attr == NULL || s->tmpdir == NULL || s->temp_stats == NULL) {
+        free(s->attr);
+        free(s->tmpdir);
+        free(s->temp_stats);
+        Pthread_mutex_destroy(&s->temp_list_lock);
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+static void bench_temp_state_close(bdb_state_type *s)
+{
+    bdb_temp_table_clear_list(s);
+    Pthread_mutex_destroy(&s->temp_list_lock);
+    free(s->attr);
+    free(s->tmpdir);
+    free(s->temp_stats);
+    free(s);
+}
+
+/* Insert in scattered order, then read everything back in key order.  A
+ * temparray holds the rows in its arena and sorts them on the first read;
+ * a temp table keeps a berkdb btree. */
+static int bench_temp_sort(const struct bench_opts *o, struct bench_result *r,
+                           int array)
+{
+    bdb_state_type *s;
+    struct temp_table *tbl = NULL;
+    struct temp_cursor *cur = NULL;
+    uint8_t kbuf[8], dbuf[BENCH_DATALEN];
+    int bdberr = 0, rc;
+
+    gbl_temptable_pool_capacity = 0;
+    if ((s = bench_temp_state_open(o)) == NULL)
+        return ENOMEM;
+
+    tbl = array ? bdb_temp_array_create(s, &bdberr)
+                : bdb_temp_table_create(s, &bdberr);
+    if (tbl == NULL) {
+        fprintf(stderr, "%s: temp table create bdberr %d\n", progname, bdberr);
+        rc = -1;
+        goto done;
+    }
+    if ((cur = bdb_temp_table_cursor(s, tbl, NULL, &bdberr)) == NULL) {
+        fprintf(stderr, "%s: temp table cursor bdberr %d\n", progname, bdberr);
+        rc = -1;
+        goto done;
+    }
+
+    memset(dbuf, 'x', sizeof(dbuf));
+
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < o->nops; i++) {
+        bench_putkey(kbuf, bench_key(i, o->nops));
+        if ((rc = bdb_temp_table_insert(s, cur, kbuf, sizeof(kbuf), dbuf,
+                                        sizeof(dbuf), &bdberr)) < 0) {
+            fprintf(stderr, "%s: temp table insert rc %d bdberr %d\n",
+                    progname, rc, bdberr);
+            goto done;
+        }
+    }
+    for (rc = bdb_temp_table_first(s, cur, &bdberr); rc == IX_FND;
+         rc = bdb_temp_table_next(s, cur, &bdberr))
+        r->ops++;
+    r->usec = comdb2_time_epochus() - start;
+
+    if (rc == IX_EMPTY || rc == IX_PASTEOF)
+        rc = 0;
+    else
+        fprintf(stderr, "%s: temp table read rc %d bdberr %d\n", progname, rc,
+                bdberr);
+
+done:
+    if (tbl)
+        bdb_temp_table_close(s, tbl, &bdberr);
+    bench_temp_state_close(s);
+    return rc;
+}
+
+static int bench_temptable_sort(const struct bench_opts *o,
+                                struct bench_result *r)
+{
+    return bench_temp_sort(o, r, 0);
+}
+
+static int bench_temparray_sort(const struct bench_opts *o,
+                                struct bench_result *r)
+{
+    return bench_temp_sort(o, r, 1);
+}
+
+/* Something shaped like an ondisk row: field headers, small integers,
+ * zero-padded strings and a trailing run of nulls. */
+static void bench_fill_record(uint8_t *rec, int i)
+{
+    memset(rec, 0, BENCH_RECLEN);
+    for (int off = 0; off < BENCH_RECLEN / 2; off += 16) {
+        rec[off] = 0x08;
+        bench_putkey(rec + off + 1, (uint64_t)(i + off));
+        memcpy(rec + off + 9, "abc", 3);
+    }
+}
+
+static int bench_rle_compress(const struct bench_opts *o,
+                              struct bench_result *r)
+{
+    uint8_t in[BENCH_RECLEN], out[BENCH_RECLEN * 2];
+
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < o->nops; i++) {
+        Comdb2RLE c = {.in = in, .insz = sizeof(in), .out = out,
+                       .outsz = sizeof(out)};
+        bench_fill_record(in, i);
+        if (compressComdb2RLE(&c) != 0) {
+            fprintf(stderr, "%s: compressComdb2RLE failed\n", progname);
+            return -1;
+        }
+        r->ops++;
+    }
+    r->usec = comdb2_time_epochus() - start;
+    return 0;
+}
+
+static int bench_rle_decompress(const struct bench_opts *o,
+                                struct bench_result *r)
+{
+    uint8_t in[BENCH_RECLEN], packed[BENCH_RECLEN * 2], out[BENCH_RECLEN];
+    Comdb2RLE c = {.in = in, .insz = sizeof(in), .out = packed,
+                   .outsz = sizeof(packed)};
+
+    bench_fill_record(in, 0);
+    if (compressComdb2RLE(&c) != 0) {
+        fprintf(stderr, "%s: compressComdb2RLE failed\n", progname);
+        return -1;
+    }
+    size_t packedsz = c.outsz;
+
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < o->nops; i++) {
+        Comdb2RLE d = {.in = packed, .insz = packedsz, .out = out,
+                       .outsz = sizeof(out)};
+        if (decompressComdb2RLE(&d) != 0 || d.outsz != sizeof(in)) {
+            fprintf(stderr, "%s: decompressComdb2RLE failed\n", progname);
+            return -1;
+        }
+        r->ops++;
+    }
+    r->usec = comdb2_time_epochus() - start;
+    return 0;
+}
+
+static int cmp_int64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Durable log write latency: every record is put with DB_FLUSH. */
+static int bench_log_put(const struct bench_opts *o, struct bench_result *r)
+{
+    struct bench_env e;
+    DB_LSN lsn;
+    DBT rec = {0};
+    uint8_t buf[BENCH_RECLEN];
+    int64_t *lat;
+    int ret;
+
+    if ((lat = malloc(sizeof(int64_t) * o->nops)) == NULL)
+        return ENOMEM;
+    if ((ret = bench_env_open(o, &e, DB_INIT_MPOOL | DB_INIT_LOG, 0)) != 0)
+        goto done;
+
+    memset(buf, 'l', sizeof(buf));
+    rec.data = buf;
+    rec.size = sizeof(buf);
+
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < o->nops; i++) {
+        int64_t t = comdb2_time_epochus();
+        if ((ret = e.dbenv->log_put(e.dbenv, &lsn, &rec, DB_FLUSH)) != 0) {
+            e.dbenv->err(e.dbenv, ret, "log_put");
+            goto done;
+        }
+        lat[i] = comdb2_time_epochus() - t;
+        r->ops++;
+    }
+    r->usec = comdb2_time_epochus() - start;
+
+    qsort(lat, r->ops, sizeof(int64_t), cmp_int64);
+    r->has_latency = 1;
+    r->p50_usec = lat[r->ops / 2];
+    r->p99_usec = lat[(r->ops * 99) / 100];
+
+done:
+    free(lat);
+    bench_env_close(&e);
+    return ret;
+}
+
+struct lock_thd_arg {
+    DB_ENV *dbenv;
+    int nops;
+    int nobjs;
+    int id;
+    int ret;
+};
+
+static void *bench_lock_thd(void *p)
+{
+    struct lock_thd_arg *a = p;
+    DB_LOCK lock;
+    DBT obj = {0};
+    u_int32_t locker;
+    uint32_t objid;
+
+    if ((a->ret = a->dbenv->lock_id(a->dbenv, &locker)) != 0)
+        return NULL;
+
+    obj.data = &objid;
+    obj.size = sizeof(objid);
+    for (int i = 0; i < a->nops; i++) {
+        objid = (uint32_t)bench_key(i + a->id, a->nobjs);
+        if ((a->ret = a->dbenv->lock_get(a->dbenv, locker, 0, &obj,
+                                         DB_LOCK_WRITE, &lock)) != 0)
+            break;
+        if ((a->ret = a->dbenv->lock_put(a->dbenv, &lock)) != 0)
+            break;
+    }
+    a->dbenv->lock_id_free(a->dbenv, locker);
+    return NULL;
+}
+
+/* Lock manager contention: threads take and drop write locks on a small
+ * set of objects. */
+static int bench_lock_get(const struct bench_opts *o, struct bench_result *r)
+{
+    struct bench_env e;
+    pthread_t *tids = NULL;
+    struct lock_thd_arg *args = NULL;
+    int ret;
+
+    if ((ret = bench_env_open(o, &e, DB_INIT_MPOOL | DB_INIT_LOCK, 0)) != 0)
+        goto done;
+
+    tids = calloc(o->nthreads, sizeof(pthread_t));
+    args = calloc(o->nthreads, sizeof(struct lock_thd_arg));
+    if (!tids || !args) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < o->nthreads; i++) {
+        args[i].dbenv = e.dbenv;
+        args[i].nops = o->nops;
+        args[i].nobjs = o->nlockobjs;
+        args[i].id = i;
+        Pthread_create(&tids[i], NULL, bench_lock_thd, &args[i]);
+    }
+    for (int i = 0; i < o->nthreads; i++) {
+        Pthread_join(tids[i], NULL);
+        if (args[i].ret && !ret) {
+            e.dbenv->err(e.dbenv, args[i].ret, "lock thread %d", i);
+            ret = args[i].ret;
+        }
+    }
+    r->usec = comdb2_time_epochus() - start;
+    r->ops = (long long)o->nops * o->nthreads;
+
+done:
+    free(tids);
+    free(args);
+    bench_env_close(&e);
+    return ret;
+}
+
+static struct {
+    const char *name;
+    bench_fn fn;
+    int needs_db;
+} benches[] = {
+    {"btree_insert", bench_btree_insert, 0},
+    {"cursor_next", bench_cursor_next, 1},
+    {"cursor_find", bench_cursor_find, 1},
+    {"temptable_sort", bench_temptable_sort, 0},
+    {"temparray_sort", bench_temparray_sort, 0},
+    {"rle_compress", bench_rle_compress, 0},
+    {"rle_decompress", bench_rle_decompress, 0},
+    {"log_put", bench_log_put, 0},
+    {"lock_get", bench_lock_get, 0},
+};
+
+#define NBENCHES (sizeof(benches) / sizeof(benches[0]))
+
+static void bench_print(const char *name, int run, const struct bench_opts *o,
+                        const struct bench_result *r)
+{
+    double secs = r->usec / 1000000.0;
+    printf("{\"bench\":\"%s\",\"run\":%d,\"ops\":%lld,\"usec\":%" PRId64
+           ",\"ops_per_sec\":%.0f,\"usec_per_op\":%.3f,\"threads\":%d",
+           name, run, r->ops, r->usec, secs > 0 ? r->ops / secs : 0.0,
+           r->ops ? (double)r->usec / r->ops : 0.0,
+           strcmp(name, "lock_get") == 0 ? o->nthreads : 1);
+    if (r->has_latency)
+        printf(",\"p50_usec\":%" PRId64 ",\"p99_usec\":%" PRId64, r->p50_usec,
+               r->p99_usec);
+    printf("}\n");
+    fflush(stdout);
+}
+
+static int usage(void)
+{
+    fprintf(stderr,
+            "usage: %s -d dir [-s dbname [-c tier] [-C config]] [-n ops] "
+            "[-t threads] [-o lockobjs] [-r repeats] [-b bench[,bench...]] "
+            "[-l]\n",
+            progname);
+    return EXIT_FAILURE;
+}
+
+static int bench_selected(const char *list, const char *name)
+{
+    if (list == NULL)
+        return 1;
+    size_t len = strlen(name);
+    for (const char *p = list; (p = strstr(p, name)) != NULL; p += len) {
+        if ((p == list || p[-1] == ',') && (p[len] == '\0' || p[len] == ','))
+            return 1;
+    }
+    return 0;
+}
+
+int tool_cdb2_bench_main(int argc, char *argv[])
+{
+    struct bench_opts o = {.dir = NULL,
+                           .dbname = NULL,
+                           .tier = "default",
+                           .nops = 100000,
+                           .nthreads = 4,
+                           .nlockobjs = 16,
+                           .repeats = 1};
+    const char *list = NULL;
+    int ch, failed = 0;
+
+    crc32c_init(0);
+    comdb2ma_init(0, 0);
+    Pthread_key_create(&comdb2_open_key, NULL);
+
+    while ((ch = getopt(argc, argv, "b:C:c:d:ln:o:r:s:t:")) != EOF) {
+        switch (ch) {
+        case 'b': list = optarg; break;
+        case 'C': cdb2_set_comdb2db_config(optarg); break;
+        case 'c': o.tier = optarg; break;
+        case 'd': o.dir = optarg; break;
+        case 'l':
+            for (int i = 0; i < NBENCHES; i++)
+                printf("%s\n", benches[i].name);
+            return EXIT_SUCCESS;
+        case 'n': o.nops = atoi(optarg); break;
+        case 'o': o.nlockobjs = atoi(optarg); break;
+        case 'r': o.repeats = atoi(optarg); break;
+        case 's': o.dbname = optarg; break;
+        case 't': o.nthreads = atoi(optarg); break;
+        default: return usage();
+        }
+    }
+    if (o.dir == NULL || o.nops <= 0 || o.nthreads <= 0 ||
+        o.nlockobjs <= 0 || o.repeats <= 0)
+        return usage();
+
+    if (mkdir(o.dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "%s: mkdir %s: %s\n", progname, o.dir,
+                strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < NBENCHES; i++) {
+        if (!bench_selected(list, benches[i].name))
+            continue;
+        if (benches[i].needs_db && o.dbname == NULL) {
+            fprintf(stderr, "%s: skipping %s, it needs a database (-s)\n",
+                    progname, benches[i].name);
+            continue;
+        }
+        for (int run = 0; run < o.repeats; run++) {
+            struct bench_result r = {0};
+            if (benches[i].fn(&o, &r) != 0) {
+                fprintf(stderr, "%s: %s failed\n", progname, benches[i].name);
+                failed = 1;
+                break;
+            }
+            bench_print(benches[i].name, run, &o, &r);
+        }
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
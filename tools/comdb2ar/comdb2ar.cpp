@@ -7,6 +7,7 @@
 #include "comdb2ar.h"
 #include "util.h"
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <string>
@@ -35,6 +36,7 @@ const char *help_text[] = {
 "  Database mydb is serialised into tape archive format on to stdout.",
 "  -s   serialise support files only (lrl, csc2 etc, no data or log files)",
 "  -L   do not disable log file deletion (dangerous)",
+"  -j N read data files with N parallel threads",
 "",
 "To deserialise a db: comdb2ar.tsk [opts] x [/bb/bin /bb/data/mydb] < input",
 "To deserialise a db incrementally:",
@@ -102,6 +104,7 @@ int main(int argc, char *argv[])
     bool run_with_done_file = false;
     bool force_mode = false;
     unsigned percent_full = 95;
+    unsigned nthreads = 1;
     bool legacy_mode = false;
     bool do_direct_io = true;
     bool incr_create = false;
@@ -127,7 +130,7 @@ int main(int argc, char *argv[])
     ss << root << "/bin/comdb2";
     std::string comdb2_task(ss.str());
 
-    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:")) != EOF) {
+    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:j:rRSkKfODE:T:")) != EOF) {
         switch(c) {
             case 'O':
                 legacy_mode = true;
@@ -165,6 +168,10 @@ int main(int argc, char *argv[])
                 percent_full = std::atoi(optarg);
                 break;
 
+            case 'j':
+                nthreads = std::max(1, std::atoi(optarg));
+                break;
+
             case 'L':
                 disable_log_deletion = false;
                 break;
@@ -307,7 +314,8 @@ int main(int argc, char *argv[])
                 incr_create,
                 incr_gen,
                 copy_physical,
-                incr_path
+                incr_path,
+                nthreads
             );
         } catch(std::exception& e) {
             std::cerr << e.what() << std::endl;
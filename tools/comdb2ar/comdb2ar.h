@@ -110,13 +110,16 @@ void serialise_database(
   bool incr_create,
   bool incr_gen,
   bool copy_physical,
-  const std::string& incr_path
+  const std::string& incr_path,
+  unsigned nthreads
 );
 // Serialise a database into tape archive format and write it to stdout.
 // If support_only is true then only support files (lrl and schema) will
 // be serialised.  If disable_log_deletion and the database is running then
 // it will be advised to hold log file deletion until the backup is complete
 // (highly recommended!)
+// If nthreads is greater than one, data files are read and checksummed that
+// many at a time while the archive is still written in order.
 // If legacy_mode is enabled, old file format are not removed after restore
 
 
@@ -235,6 +235,65 @@ bool compare_checksum(
     return ret;
 }
 
+// Use the pages the database reports written since the last increment
+// instead of comparing every page.  Same contract as compare_checksum.
+bool tracked_pages(
+    FileInfo &file,
+    const std::string& incr_path,
+    const std::vector<uint32_t>& written,
+    std::vector<uint32_t>& pages,
+    ssize_t *data_size,
+    std::set<std::string>& incr_files
+) {
+    std::string filename = file.get_filename();
+    std::string incr_file_name = incr_path + "/" + filename + ".incr";
+
+    std::set<std::string>::iterator it = incr_files.find(filename + ".incr");
+    if(it != incr_files.end()){
+        incr_files.erase(it);
+    }
+
+    struct stat new_st;
+    if(stat(file.get_filepath().c_str(), &new_st) == -1) {
+        std::ostringstream ss;
+        ss << "cannot stat file: " << std::strerror(errno);
+        throw SerialiseError(filename, ss.str());
+    }
+    file.set_filesize(new_st.st_size);
+
+    struct stat sb;
+    if(stat(incr_file_name.c_str(), &sb) != 0) {
+        std::clog << "New File: " << filename << std::endl;
+        *data_size = new_st.st_size;
+        return true;
+    }
+
+    size_t pagesize = file.get_pagesize();
+    if(pagesize == 0) {
+        pagesize = 4096;
+    }
+
+    // The .incr file has an entry for each page of the previous increment.
+    // Anything past that is new to the backup, whether or not the database
+    // reported writing it (extents can be written outside the buffer pool).
+    uint32_t old_pages = sb.st_size / 12;
+    uint32_t new_pages = new_st.st_size / pagesize;
+
+    // Pages past the end were written before the file was truncated
+    for(size_t ii = 0; ii < written.size(); ++ii) {
+        if(written[ii] >= old_pages || written[ii] >= new_pages)
+            break;
+        pages.push_back(written[ii]);
+        *data_size += pagesize;
+    }
+    for(uint32_t pgno = old_pages; pgno < new_pages; ++pgno) {
+        pages.push_back(pgno);
+        *data_size += pagesize;
+    }
+
+    return !pages.empty();
+}
+
 ssize_t serialise_incr_file(
     const FileInfo& file,
     std::vector<uint32_t> pages,
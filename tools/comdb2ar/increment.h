@@ -29,6 +29,17 @@ bool compare_checksum(
 // Compare a file's checksum and LSN with it's diff file to determine whether pages
 // have been changed
 
+bool tracked_pages(
+    FileInfo &file,
+    const std::string& incr_path,
+    const std::vector<uint32_t>& written,
+    std::vector<uint32_t>& pages,
+    ssize_t *data_size,
+    std::set<std::string>& incr_files
+);
+// Like compare_checksum, but take the changed pages from the list of pages
+// the database wrote since the last backup instead of reading every page
+
 void write_incr_manifest_entry(
     std::ostream& os,
     const FileInfo& file,
@@ -45,7 +45,8 @@ void LogHolder_impl::reset(const std::string& dbname, const std::string& request
     }
 }
 
-LogHolder::LogHolder(const std::string& dbname) : impl(new LogHolder_impl(dbname, "logdelete3\n"))
+LogHolder::LogHolder(const std::string& dbname)
+    : impl(new LogHolder_impl(dbname, "logdelete3\n")), m_pgtrack(false)
 {
     
     m_version = 3;
@@ -98,3 +99,58 @@ std::string LogHolder::recovery_options()
     else
         return "";
 }
+
+bool LogHolder::pgtrack_rotate(unsigned long long& epoch,
+                               unsigned long long& acked)
+{
+    if(!impl->mp_appsock.get() || m_version < 3)
+        return false;
+
+    // Older databases ignore the request, so a timeout just means no
+    try {
+        impl->mp_appsock->request("pgtrack_rotate\n");
+        std::istringstream rsp(impl->mp_appsock->read_response());
+        std::string tok;
+        m_pgtrack = (rsp >> tok >> epoch >> acked) && tok == "pgtrack";
+    } catch(Error& e) {
+        std::clog << "Changed page tracking unavailable: " << e.what()
+                  << std::endl;
+        m_pgtrack = false;
+    }
+    return m_pgtrack;
+}
+
+bool LogHolder::pgtrack_pages(const std::string& filename,
+                              std::vector<uint32_t>& pages)
+{
+    if(!m_pgtrack)
+        return false;
+
+    pages.clear();
+    impl->mp_appsock->request("pgtrack_pages " + filename + "\n");
+    while(true) {
+        std::string line(impl->mp_appsock->read_response());
+        if(line == ".")
+            return true;
+        if(line == "unknown")
+            return false;
+
+        std::istringstream rsp(line);
+        uint32_t first, count;
+        if(!(rsp >> first >> count))
+            throw Error("Log holder appsock: bad page list for " + filename);
+        for(uint32_t ii = 0; ii < count; ++ii)
+            pages.push_back(first + ii);
+    }
+}
+
+bool LogHolder::pgtrack_ack(unsigned long long epoch)
+{
+    if(!m_pgtrack)
+        return false;
+
+    std::ostringstream request;
+    request << "pgtrack_ack " << epoch << "\n";
+    impl->mp_appsock->request(request.str());
+    return impl->mp_appsock->read_response() == "ok";
+}
@@ -19,6 +19,9 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+
+#include <stdint.h>
 
 struct LogHolder_impl;
 
@@ -28,6 +31,7 @@ class LogHolder {
 
     std::unique_ptr<LogHolder_impl> impl;
     int m_version;
+    bool m_pgtrack;
 
 public:
 
@@ -52,6 +56,20 @@ public:
 
     std::string recovery_options();
 
+    bool pgtrack_rotate(unsigned long long& epoch, unsigned long long& acked);
+    // Start a changed-page tracking epoch for this backup.  On success epoch
+    // is the new epoch and acked the one the database can list pages since
+    // (0 if none).  Returns false if the database doesn't track pages.
+
+    bool pgtrack_pages(const std::string& filename,
+                       std::vector<uint32_t>& pages);
+    // Get the pages of data file filename written since the acknowledged
+    // epoch.  Returns false if the database can't account for them.
+
+    bool pgtrack_ack(unsigned long long epoch);
+    // Tell the database the backup that started epoch is complete.  Returns
+    // true if epoch is now the acknowledged one.
+
     int version() { return m_version; };
 };
 
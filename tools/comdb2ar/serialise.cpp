@@ -24,6 +24,11 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include <errno.h>
 #include <fcntl.h>
@@ -120,17 +125,25 @@ static void serialise_string(const std::string& filename,
  * that defines this properly */
 void *memalign(size_t boundary, size_t size);
 
-static void serialise_file(FileInfo& file, volatile iomap *iomap=NULL, const std::string altpath="",
-                            const std::string incr_path="", bool incr_create = false)
-// Serialise a single file, in tape archive format, onto stdout.  The input
-// filename is expected to be an absolute path.  The name recorded in the
-// tape archive will be relative to dbdir.  Input files outside of dbdir
-// (usually the lrl) will be recorded in the archive as having come from
-// dbdir.
+static uint8_t *alloc_pagebuf(size_t bufsize)
+{
+    uint8_t *pagebuf = NULL;
+#if ! defined  ( _SUN_SOURCE ) && ! defined ( _HP_SOURCE )
+    if(posix_memalign((void**) &pagebuf, 512, bufsize))
+        throw Error("Failed to allocate output buffer");
+#else
+    pagebuf = (uint8_t*) memalign(512, bufsize);
+#endif
+    return pagebuf;
+}
+
+static int open_file(FileInfo& file, const std::string& altpath,
+                     struct stat& st)
+// Open a file to be serialised and stat it.  Returns -1 if the file has
+// gone missing and can be skipped, throws if it cannot be archived.
 {
     const std::string& filename = file.get_filename();
     int flags;
-    bool skip_iomap = false;
     std::ostringstream ss;
 
     // Ensure large file support
@@ -150,7 +163,7 @@ reopen:
     else {
         fd = open(file.get_filepath().c_str(), flags);
     }
-    RIIA_fd fd_guard(fd);
+    RIIA_fd fdalt_guard(fdalt);
 
     if(fd == -1) {
         /* If this is a log file, we can't ignore it - we need it to run recovery. */
@@ -169,14 +182,15 @@ reopen:
              * despite this file being unavailable. */
             std::clog << "Error opening file " << file.get_filepath()
                       <<", err: " << std::strerror(errno) << std::endl;
-            return;
+            return -1;
         }
         else
             throw SerialiseError(filename, ss.str());
     }
 
-    struct stat st, stalt;
+    struct stat stalt;
     if(fstat(fd, &st) == -1) {
+        close(fd);
         ss << "cannot stat file: " << std::strerror(errno);
         throw SerialiseError(filename, ss.str());
     }
@@ -190,11 +204,16 @@ reopen:
 
     // Ignore special files
     if(!S_ISREG(st.st_mode)) {
+        close(fd);
         throw SerialiseError(filename, "not a regular file");
     }
 
-    // Write the header
-    TarHeader head;
+    return fd;
+}
+
+static void write_header(const std::string& filename, const struct stat& st,
+                         TarHeader& head)
+{
     head.set_filename(filename);
     head.set_attrs(st);
     head.set_checksum();
@@ -205,154 +224,153 @@ reopen:
         ss << "error writing tar block header: " << std::strerror(errno);
         throw SerialiseError(filename, ss.str());
     }
+}
 
-    // Read the file a page at a time and copy to the output.
-    // Use a large buffer if possible
-    size_t pagesize = file.get_pagesize();
+static size_t file_bufsize(FileInfo& file, size_t& pagesize)
+// Read the file a page at a time.  Use a large buffer if possible.
+{
+    pagesize = file.get_pagesize();
     if(pagesize == 0) {
         pagesize = 4096;
     }
     size_t bufsize = pagesize;
-    int num_waits = 0;
-    int64_t filesize = 0;
 
     while((bufsize << 1) <= MAX_BUF_SIZE) {
         bufsize <<= 1;
     }
-#if 0
-    */
-    std::cerr<<"Computed bufsize="<<bufsize<<" for pagesize="<<pagesize<<" file="<<filename<<"\n";
-
-    std::vector<char> pagebuf(bufsize);
-#endif
-    uint8_t *pagebuf = NULL;
-    off_t bytesleft = st.st_size;
-    unsigned long long pageno = 0;
+    return bufsize;
+}
 
-#if ! defined  ( _SUN_SOURCE ) && ! defined ( _HP_SOURCE )
-        if(posix_memalign((void**) &pagebuf, 512, bufsize))
-            throw Error("Failed to allocate output buffer");
-#else
-        pagebuf = (uint8_t*) memalign(512, bufsize);
-#endif
+static void wait_for_trickle(volatile iomap *iomap, bool& skip_iomap,
+                             int& num_waits)
+// Back off while the database is flushing its cache
+{
+    int now;
 
-    std::string incrFilename = incr_path + "/" + filename + ".incr";
-    std::ofstream incrFile(incrFilename,
-            std::ofstream::binary |
-            std::ofstream::trunc);
+    while (!skip_iomap && iomap != NULL && iomap->memptrickle_time) {
+        now = time(NULL);
+        if ((now - iomap->memptrickle_time) > 5*60) {
+            std::clog << "long memptrickle (" << now - iomap->memptrickle_time << " seconds), continuing" << std::endl;
+            skip_iomap = true;
+            break;
+        }
+        num_waits++;
+        poll(0, 0, 100);
+    }
+}
 
-    while(bytesleft > 0) {
-        int now;
-        unsigned long long nbytes = bytesleft > bufsize ? bufsize : bytesleft;
+static ssize_t read_chunk(int fd, FileInfo& file, uint8_t *pagebuf,
+                          size_t pagesize, size_t nbytes, off_t bytesleft,
+                          std::ofstream& incrFile, bool incr_create)
+// Read up to nbytes of the file into pagebuf, verifying page checksums
+// (and rereading pages caught mid-write) if the file has them.
+{
+    const std::string& filename = file.get_filename();
 
-        while (!skip_iomap && iomap != NULL && iomap->memptrickle_time) {
-            now = time(NULL);
-            if ((now - iomap->memptrickle_time) > 5*60) {
-                std::clog << "long memptrickle (" << now - iomap->memptrickle_time << " seconds), continuing" << std::endl;
-                skip_iomap = true;
-                break;
-            }
-            num_waits++;
-            poll(0, 0, 100);
-        }
+    ssize_t bytesread = read(fd, &pagebuf[0], nbytes);
+    if(bytesread <= 0) {
+        std::ostringstream ss;
+        ss << "read error after " << bytesleft << " bytes, tried to read " << nbytes << " bytes "
+            << std::strerror(errno);
+        throw SerialiseError(filename, ss.str());
+    }
 
-        ssize_t bytesread = read(fd, &pagebuf[0], nbytes);
-        if(bytesread <= 0) {
+    if (file.get_checksums()) {
+        // Save current offset
+        const off_t offset = lseek(fd, 0, SEEK_CUR);
+        if (offset == (off_t) -1) {
             std::ostringstream ss;
-            ss << "read error after " << bytesleft << " bytes, tried to read " << nbytes << " bytes "
-                << std::strerror(errno);
+            ss << "serialise_file:lseek:initial: " << std::strerror(errno);
             throw SerialiseError(filename, ss.str());
         }
-        filesize += bytesread;
 
-        if (file.get_checksums()) {
-            // Save current offset
-            const off_t offset = lseek(fd, 0, SEEK_CUR);
-            if (offset == (off_t) -1) {
-                std::ostringstream ss;
-                ss << "serialise_file:lseek:initial: " << std::strerror(errno);
-                throw SerialiseError(filename, ss.str());
-            }
+        int retry = 5;
+        ssize_t n = 0;
 
-            int retry = 5;
-            ssize_t n = 0;
+        while (n < bytesread && retry) {
+            bool verify_bool = false;
+            PAGE * pagep = (PAGE *) (pagebuf + n);
+            uint32_t verify_cksum;
+            verify_checksum(pagebuf + n, pagesize, file.get_crypto(), file.get_swapped(), &verify_bool, &verify_cksum);
 
-            while (n < bytesread && retry) {
-                bool verify_bool = false;
-                PAGE * pagep = (PAGE *) (pagebuf + n);
-                uint32_t verify_cksum;
-                verify_checksum(pagebuf + n, pagesize, file.get_crypto(), file.get_swapped(), &verify_bool, &verify_cksum);
+            if(verify_bool){
+                // checksum verified
+                n += pagesize;
+                retry = 5;
 
-                if(verify_bool){
-                    // checksum verified
-                    n += pagesize;
-                    retry = 5;
 
+                // If we are in incremental mode, on initial backup creation we want to create the diff files
+                if(incr_create){
+                    incrFile.write((char *) &(LSN(pagep).file), 4);
+                    incrFile.write((char *) &(LSN(pagep).offset), 4);
+                    incrFile.write((char *) &verify_cksum, 4);
+                }
 
-                    // If we are in incremental mode, on initial backup creation we want to create the diff files
-                    if(incr_create){
-                        incrFile.write((char *) &(LSN(pagep).file), 4);
-                        incrFile.write((char *) &(LSN(pagep).offset), 4);
-                        incrFile.write((char *) &verify_cksum, 4);
-                    }
+                continue;
+            }
 
-                    continue;
-                }
+            // Partial page read. Read the page again to see if it passes
+            // checksum verification.
+            if (--retry == 0) {
+                //giving up on this page
+                std::ostringstream ss;
+                ss << "serialise_file:page failed checksum verification";
+                throw SerialiseError(filename, ss.str());
+            }
 
-                // Partial page read. Read the page again to see if it passes
-                // checksum verification.
-                if (--retry == 0) {
-                    //giving up on this page
-                    std::ostringstream ss;
-                    ss << "serialise_file:page failed checksum verification";
-                    throw SerialiseError(filename, ss.str());
-                }
+            // wait 500ms before reading page again
+            poll(0, 0, 500);
 
-                // wait 500ms before reading page again
-                poll(0, 0, 500);
+            // rewind and read the page again
+            off_t rewind = offset - (bytesread - n);
+            rewind = lseek(fd, rewind, SEEK_SET);
+            if (rewind == (off_t) -1) {
+                std::ostringstream ss;
+                ss << "serialise_file:lseek:rewind: " << std::strerror(errno);
+                throw SerialiseError(filename, ss.str());
+            }
 
-                // rewind and read the page again
-                off_t rewind = offset - (bytesread - n);
-                rewind = lseek(fd, rewind, SEEK_SET);
-                if (rewind == (off_t) -1) {
+            ssize_t nread, totalread = 0;
+            while (totalread < pagesize) {
+                nread = read(fd, &pagebuf[0] + n + totalread,
+                             pagesize - totalread);
+                if (nread <= 0) {
                     std::ostringstream ss;
-                    ss << "serialise_file:lseek:rewind: " << std::strerror(errno);
+                    ss << "serialise_file:read: " << std::strerror(errno);
                     throw SerialiseError(filename, ss.str());
                 }
-
-                ssize_t nread, totalread = 0;
-                while (totalread < pagesize) {
-                    nread = read(fd, &pagebuf[0] + n + totalread,
-                                 pagesize - totalread);
-                    if (nread <= 0) {
-                        std::ostringstream ss;
-                        ss << "serialise_file:read: " << std::strerror(errno);
-                        throw SerialiseError(filename, ss.str());
-                    }
-                    totalread += nread;
-                }
-            }
-
-            // Restore to original offset
-            if (offset != lseek(fd, offset, SEEK_SET)) {
-                std::ostringstream ss;
-                ss << "serialise_file:lseek:reset: " << std::strerror(errno);
-                throw SerialiseError(filename, ss.str());
+                totalread += nread;
             }
         }
 
-        ssize_t byteswritten = writeall(1, &pagebuf[0], bytesread);
-        if(byteswritten != bytesread) {
+        // Restore to original offset
+        if (offset != lseek(fd, offset, SEEK_SET)) {
             std::ostringstream ss;
-            ss << "write error after " << bytesleft << "bytes: "
-                << std::strerror(errno);
+            ss << "serialise_file:lseek:reset: " << std::strerror(errno);
             throw SerialiseError(filename, ss.str());
         }
+    }
 
-        bytesleft -= bytesread;
+    return bytesread;
+}
+
+static void write_chunk(const std::string& filename, const uint8_t *buf,
+                        ssize_t nbytes, off_t bytesleft)
+{
+    ssize_t byteswritten = writeall(1, &buf[0], nbytes);
+    if(byteswritten != nbytes) {
+        std::ostringstream ss;
+        ss << "write error after " << bytesleft << "bytes: "
+            << std::strerror(errno);
+        throw SerialiseError(filename, ss.str());
     }
+}
 
-    file.set_filesize(filesize);
+static void finish_file(FileInfo& file, const struct stat& st,
+                        TarHeader& head, size_t pagesize, off_t bytesleft,
+                        int num_waits)
+{
+    const std::string& filename = file.get_filename();
 
     if (num_waits)
         std::clog <<  "paused " << num_waits << " times because db is busy writing." << std::endl;
@@ -383,8 +401,304 @@ reopen:
 
 
     std::clog << std::endl;
-    if (pagebuf)
-        free(pagebuf);
+}
+
+static void serialise_file(FileInfo& file, volatile iomap *iomap=NULL, const std::string altpath="",
+                            const std::string incr_path="", bool incr_create = false)
+// Serialise a single file, in tape archive format, onto stdout.  The input
+// filename is expected to be an absolute path.  The name recorded in the
+// tape archive will be relative to dbdir.  Input files outside of dbdir
+// (usually the lrl) will be recorded in the archive as having come from
+// dbdir.
+{
+    const std::string& filename = file.get_filename();
+    bool skip_iomap = false;
+
+    struct stat st;
+    int fd = open_file(file, altpath, st);
+    if (fd == -1)
+        return;
+    RIIA_fd fd_guard(fd);
+
+    // Write the header
+    TarHeader head;
+    write_header(filename, st, head);
+
+    size_t pagesize;
+    size_t bufsize = file_bufsize(file, pagesize);
+    int num_waits = 0;
+    int64_t filesize = 0;
+
+    uint8_t *pagebuf = alloc_pagebuf(bufsize);
+    RIIA_malloc free_guard(pagebuf);
+    off_t bytesleft = st.st_size;
+
+    std::string incrFilename = incr_path + "/" + filename + ".incr";
+    std::ofstream incrFile(incrFilename,
+            std::ofstream::binary |
+            std::ofstream::trunc);
+
+    while(bytesleft > 0) {
+        unsigned long long nbytes = bytesleft > bufsize ? bufsize : bytesleft;
+
+        wait_for_trickle(iomap, skip_iomap, num_waits);
+
+        ssize_t bytesread = read_chunk(fd, file, pagebuf, pagesize, nbytes,
+                                       bytesleft, incrFile, incr_create);
+        filesize += bytesread;
+
+        write_chunk(filename, pagebuf, bytesread, bytesleft);
+
+        bytesleft -= bytesread;
+    }
+
+    file.set_filesize(filesize);
+
+    finish_file(file, st, head, pagesize, bytesleft, num_waits);
+}
+
+class ParallelReader {
+// Reads data files ahead of the archive writer on a pool of threads.  Each
+// thread opens, reads and checksum verifies one file at a time and queues
+// its chunks; the caller still writes every file whole and in order, so the
+// archive is identical to a serial one and deserialises the same way.
+
+    struct Chunk {
+        uint8_t *buf;
+        ssize_t len;
+    };
+
+    struct Slot {
+        FileInfo *file;
+        bool opened;   // st and pagesize are valid (or missing/err is set)
+        bool missing;  // file went away, skip it
+        bool eof;      // no more chunks will be queued
+        std::exception_ptr err;
+        struct stat st;
+        size_t pagesize;
+        int num_waits;
+        int64_t filesize;
+        std::deque<Chunk> chunks;
+
+        Slot() : file(NULL), opened(false), missing(false), eof(false),
+                 pagesize(0), num_waits(0), filesize(0) {}
+    };
+
+    // Chunks queued per file before its reader waits for the writer
+    static const size_t MAX_QUEUED = 4;
+
+    std::vector<Slot> m_slots;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mtx;
+    std::condition_variable m_cond;
+    size_t m_next_read;   // next file to hand to a reader
+    size_t m_next_write;  // next file the writer will take
+    size_t m_nthreads;
+    bool m_stop;
+    volatile iomap *m_iomap;
+    const std::string m_incr_path;
+    bool m_incr_create;
+
+    void read_file(Slot& slot);
+    void reader();
+
+public:
+    ParallelReader(std::list<FileInfo>& files, unsigned nthreads,
+                   volatile iomap *iomap, const std::string& incr_path,
+                   bool incr_create);
+    // Start nthreads readers over files, which must outlive this object.
+
+    ~ParallelReader();
+    // Stop the readers and discard anything they have queued.
+
+    void serialise_next(FileInfo& file);
+    // Write the next file, which must be the next one in the list given to
+    // the constructor, onto stdout in tape archive format.  Rethrows any
+    // error the reader hit on that file.
+};
+
+ParallelReader::ParallelReader(std::list<FileInfo>& files, unsigned nthreads,
+                               volatile iomap *iomap,
+                               const std::string& incr_path, bool incr_create)
+    : m_slots(files.size()), m_next_read(0), m_next_write(0),
+      m_nthreads(nthreads), m_stop(false), m_iomap(iomap),
+      m_incr_path(incr_path), m_incr_create(incr_create)
+{
+    size_t ii = 0;
+    for (std::list<FileInfo>::iterator it = files.begin(); it != files.end();
+         ++it) {
+        m_slots[ii++].file = &*it;
+    }
+    for (unsigned ii = 0; ii < nthreads; ++ii) {
+        m_threads.push_back(std::thread(&ParallelReader::reader, this));
+    }
+}
+
+ParallelReader::~ParallelReader()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mtx);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (size_t ii = 0; ii < m_threads.size(); ++ii) {
+        m_threads[ii].join();
+    }
+    for (size_t ii = 0; ii < m_slots.size(); ++ii) {
+        for (size_t jj = 0; jj < m_slots[ii].chunks.size(); ++jj) {
+            free(m_slots[ii].chunks[jj].buf);
+        }
+    }
+}
+
+void ParallelReader::reader()
+{
+    std::unique_lock<std::mutex> lk(m_mtx);
+    while (true) {
+        // Stay at most one file per thread ahead of the writer
+        m_cond.wait(lk, [this] {
+            return m_stop || m_next_read >= m_slots.size() ||
+                   m_next_read < m_next_write + m_nthreads;
+        });
+        if (m_stop || m_next_read >= m_slots.size()) {
+            return;
+        }
+        Slot& slot = m_slots[m_next_read++];
+        lk.unlock();
+        read_file(slot);
+        lk.lock();
+    }
+}
+
+void ParallelReader::read_file(Slot& slot)
+{
+    FileInfo& file = *slot.file;
+    bool skip_iomap = false;
+    int num_waits = 0;
+
+    try {
+        struct stat st;
+        int fd = open_file(file, "", st);
+        if (fd == -1) {
+            std::lock_guard<std::mutex> lk(m_mtx);
+            slot.opened = slot.missing = slot.eof = true;
+            m_cond.notify_all();
+            return;
+        }
+        RIIA_fd fd_guard(fd);
+
+        size_t pagesize;
+        size_t bufsize = file_bufsize(file, pagesize);
+        {
+            std::lock_guard<std::mutex> lk(m_mtx);
+            slot.st = st;
+            slot.pagesize = pagesize;
+            slot.opened = true;
+        }
+        m_cond.notify_all();
+
+        std::string incrFilename =
+            m_incr_path + "/" + file.get_filename() + ".incr";
+        std::ofstream incrFile(incrFilename,
+                std::ofstream::binary |
+                std::ofstream::trunc);
+
+        off_t bytesleft = st.st_size;
+        while (bytesleft > 0) {
+            size_t nbytes = bytesleft > bufsize ? bufsize : bytesleft;
+
+            wait_for_trickle(m_iomap, skip_iomap, num_waits);
+
+            uint8_t *buf = alloc_pagebuf(bufsize);
+            ssize_t bytesread;
+            try {
+                bytesread = read_chunk(fd, file, buf, pagesize, nbytes,
+                                       bytesleft, incrFile, m_incr_create);
+            } catch (...) {
+                free(buf);
+                throw;
+            }
+            bytesleft -= bytesread;
+
+            std::unique_lock<std::mutex> lk(m_mtx);
+            m_cond.wait(lk, [this, &slot] {
+                return m_stop || slot.chunks.size() < MAX_QUEUED;
+            });
+            if (m_stop) {
+                free(buf);
+                return;
+            }
+            Chunk chunk = {buf, bytesread};
+            slot.chunks.push_back(chunk);
+            slot.filesize += bytesread;
+            lk.unlock();
+            m_cond.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lk(m_mtx);
+        slot.num_waits = num_waits;
+        slot.eof = true;
+        m_cond.notify_all();
+    } catch (...) {
+        std::lock_guard<std::mutex> lk(m_mtx);
+        slot.err = std::current_exception();
+        slot.opened = slot.eof = true;
+        m_cond.notify_all();
+    }
+}
+
+void ParallelReader::serialise_next(FileInfo& file)
+{
+    Slot& slot = m_slots[m_next_write];
+    const std::string& filename = file.get_filename();
+    TarHeader head;
+    bool header = false;
+    off_t bytesleft = 0;
+
+    assert(slot.file == &file);
+
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_cond.wait(lk, [&slot] { return slot.opened; });
+    if (!slot.missing && !slot.err) {
+        lk.unlock();
+        write_header(filename, slot.st, head);
+        header = true;
+        bytesleft = slot.st.st_size;
+        lk.lock();
+    }
+
+    // Drain whatever the reader queued; a failed read ends the stream early
+    while (header) {
+        m_cond.wait(lk, [&slot] { return !slot.chunks.empty() || slot.eof; });
+        if (slot.chunks.empty()) {
+            break;
+        }
+        Chunk chunk = slot.chunks.front();
+        slot.chunks.pop_front();
+        lk.unlock();
+        m_cond.notify_all();
+
+        RIIA_malloc free_guard(chunk.buf);
+        write_chunk(filename, chunk.buf, chunk.len, bytesleft);
+        bytesleft -= chunk.len;
+        lk.lock();
+    }
+
+    std::exception_ptr err = slot.err;
+    int num_waits = slot.num_waits;
+    ++m_next_write;
+    lk.unlock();
+    m_cond.notify_all();
+
+    if (err) {
+        std::rethrow_exception(err);
+    }
+    if (slot.missing) {
+        return;
+    }
+
+    file.set_filesize(slot.filesize);
+    finish_file(file, slot.st, head, slot.pagesize, bytesleft, num_waits);
 }
 
 std::string replace_dbname(const std::string& replaceWith, const std::string& dbname, 
@@ -763,13 +1077,16 @@ void serialise_database(
   bool incr_create,
   bool incr_gen,
   bool copy_physical,
-  const std::string& incr_path
+  const std::string& incr_path,
+  unsigned nthreads
 )
 // Serialise a database into tape archive format and write it to stdout.
 // If support_only is true then only support files (lrl and schema) will
 // be serialised.  If disable_log_deletion and the database is running then
 // it will be advised to hold log file deletion until the backup is complete
 // (highly recommended!)
+// If nthreads is greater than one, data files are read and checksummed that
+// many at a time while the archive is still written in order.
 {
     std::string dbname;
     std::string dbdir;
@@ -986,6 +1303,14 @@ void serialise_database(
         log_holder = std::unique_ptr<LogHolder>(new LogHolder(dbname));
     }
 
+    // For incremental backups start a changed-page tracking epoch before
+    // reading any data, so that whatever is written from now on is left for
+    // the next increment.
+    unsigned long long pgtrack_epoch = 0, pgtrack_acked = 0;
+    bool pgtrack = (incr_create || incr_gen) && log_holder.get() &&
+        log_holder->pgtrack_rotate(pgtrack_epoch, pgtrack_acked);
+    std::string pgtrack_filename = incr_path + "/pgtrack.epoch";
+
 
     // Based on what we read from the lrl, it's time to create the definitive
     // set of files to back up.  For data files we record the file names and
@@ -1199,6 +1524,17 @@ void serialise_database(
         manifest << "# Manifest for serialisation of increment produced on "
             << getDTString() << std::endl;
 
+        // The database's list of written pages is only complete if it was
+        // last acknowledged by the previous backup in this chain
+        bool use_pgtrack = false;
+        if(pgtrack && pgtrack_acked != 0) {
+            std::ifstream pgtrack_file(pgtrack_filename);
+            unsigned long long prev_epoch = 0;
+            use_pgtrack = (pgtrack_file >> prev_epoch) &&
+                prev_epoch == pgtrack_acked;
+        }
+        std::clog << "Changed page tracking "
+            << (use_pgtrack ? "in use" : "not in use") << std::endl;
 
         for(std::list<FileInfo>::iterator
                 it = data_files.begin();
@@ -1208,8 +1544,19 @@ void serialise_database(
             std::vector<uint32_t> pages_list;
             ssize_t data_size = 0;
 
-            // Diff the page checksums for each file to find what has been changed
-            if(compare_checksum(*it, incr_path, pages_list, &data_size, incr_files)) {
+            // Ask the database which pages it wrote, or failing that diff the
+            // page checksums for each file to find what has been changed
+            std::vector<uint32_t> written;
+            bool changed;
+            if(use_pgtrack &&
+                    log_holder->pgtrack_pages(it->get_filename(), written)) {
+                changed = tracked_pages(*it, incr_path, written, pages_list,
+                        &data_size, incr_files);
+            } else {
+                changed = compare_checksum(*it, incr_path, pages_list,
+                        &data_size, incr_files);
+            }
+            if(changed) {
                 // If pages list is empty but compare_checksum returned true, it's a new file
                 if(pages_list.empty()){
                     new_files.push_back(*it);
@@ -1343,6 +1690,12 @@ void serialise_database(
         // Now do data files
         if(!support_files_only) {
 
+            std::unique_ptr<ParallelReader> reader;
+            if (nthreads > 1) {
+                reader.reset(new ParallelReader(data_files, nthreads, iom,
+                                                incr_path, incr_create));
+            }
+
             long long log_number(lowest_log);
             for(std::list<FileInfo>::iterator
                     it = data_files.begin();
@@ -1358,8 +1711,13 @@ void serialise_database(
                     log_holder->release_log(log_number - 1);
                 }
 
-                serialise_file(*it, iom, "", incr_path, incr_create);
+                if (reader) {
+                    reader->serialise_next(*it);
+                } else {
+                    serialise_file(*it, iom, "", incr_path, incr_create);
+                }
             }
+            reader.reset();
 
             // Serialise all remaining log files, including incomplete ones
             serialise_log_files(dbtxndir, dbdir, log_number, false);
@@ -1475,6 +1833,14 @@ void serialise_database(
         std::ofstream sha_file(sha_filename, std::ofstream::trunc);
 
         sha_file.write(sha.c_str(), 40);
+
+        // Record the epoch the next increment can take written pages since
+        if(pgtrack && log_holder->pgtrack_ack(pgtrack_epoch)) {
+            std::ofstream pgtrack_file(pgtrack_filename, std::ofstream::trunc);
+            pgtrack_file << pgtrack_epoch << std::endl;
+        } else {
+            unlink(pgtrack_filename.c_str());
+        }
     }
 
     // Release the database for log file deletion.
@@ -0,0 +1,100 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* HyperLogLog (Flajolet et al.) with the linear-counting correction for
+   small cardinalities.  One byte per register. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "hll.h"
+#include "mem_util.h"
+#include "mem_override.h"
+
+#define HLL_MIN_PRECISION 4
+#define HLL_MAX_PRECISION 18
+
+struct hll {
+    int p;
+    uint32_t m;
+    uint8_t reg[];
+};
+
+struct hll *hll_new(int precision)
+{
+    if (precision < HLL_MIN_PRECISION)
+        precision = HLL_MIN_PRECISION;
+    if (precision > HLL_MAX_PRECISION)
+        precision = HLL_MAX_PRECISION;
+    uint32_t m = 1U << precision;
+    struct hll *h = calloc(1, sizeof(struct hll) + m);
+    if (h == NULL)
+        return NULL;
+    h->p = precision;
+    h->m = m;
+    return h;
+}
+
+void hll_add(struct hll *h, uint64_t hash)
+{
+    uint32_t idx = hash >> (64 - h->p);
+    /* rank of the first set bit in the remaining 64-p bits; the sentinel
+       bit keeps it bounded when they are all zero */
+    uint64_t w = (hash << h->p) | (1ULL << (h->p - 1));
+    uint8_t rank = __builtin_clzll(w) + 1;
+    if (rank > h->reg[idx])
+        h->reg[idx] = rank;
+}
+
+uint64_t hll_count(const struct hll *h)
+{
+    double m = h->m;
+    double alpha;
+    switch (h->m) {
+    case 16: alpha = 0.673; break;
+    case 32: alpha = 0.697; break;
+    case 64: alpha = 0.709; break;
+    default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+    }
+
+    double sum = 0;
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < h->m; ++i) {
+        sum += ldexp(1.0, -h->reg[i]);
+        if (h->reg[i] == 0)
+            ++zeros;
+    }
+    double est = alpha * m * m / sum;
+    if (est <= 2.5 * m && zeros)
+        est = m * log(m / zeros);
+    return (uint64_t)(est + 0.5);
+}
+
+void hll_merge(struct hll *dst, const struct hll *src)
+{
+    if (dst->p != src->p)
+        return;
+    for (uint32_t i = 0; i < dst->m; ++i) {
+        if (src->reg[i] > dst->reg[i])
+            dst->reg[i] = src->reg[i];
+    }
+}
+
+void hll_free(struct hll *h)
+{
+    free(h);
+}
@@ -497,6 +497,23 @@ int SBUF2_FUNC(sbuf2fread)(char *ptr, int size, int nitems, SBUF2 *sb)
     return sbuf2fread_int(ptr, size, nitems, sb, NULL);
 }
 
+int SBUF2_FUNC(sbuf2pending)(SBUF2 *sb)
+{
+    int n;
+
+    if (sb == NULL)
+        return 0;
+    n = sb->rhd - sb->rtl;
+#if SBUF2_UNGETC
+    n += sb->ungetc_buf_len;
+#endif
+#if WITH_SSL
+    if (sb->ssl != NULL)
+        n += SSL_pending(sb->ssl);
+#endif
+    return n;
+}
+
 /* returns num items read || <0 for error*/
 int SBUF2_FUNC(sbuf2fread_timeout)(char *ptr, int size, int nitems, SBUF2 *sb,
                                    int *was_timeout)
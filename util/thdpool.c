@@ -52,6 +52,7 @@
 #endif
 
 int gbl_random_thdpool_work_timeout = 0;
+int gbl_thdpool_affinity_scan = 0;
 
 extern int gbl_throttle_sql_overload_dump_sec;
 extern int thdpool_alarm_on_queing(int len);
@@ -77,6 +78,9 @@ struct thd {
 
     int on_freelist;
 
+    /* Per thread data, for the pool's affinity function. */
+    void *thddata;
+
     LINKC_T(struct thd) thdlist_linkv;
     LINKC_T(struct thd) freelist_linkv;
 };
@@ -103,6 +107,8 @@ struct thdpool {
     thdpool_thdinit_fn init_fn;
     thdpool_thddelt_fn delt_fn;
     thdpool_thddque_fn dque_fn;
+    thdpool_affinity_key_fn affinity_key_fn;
+    thdpool_affinity_fn affinity_fn;
 
     unsigned minnthd;   /* desired number of threads */
     unsigned maxnthd;   /* max threads - queue after this point */
@@ -126,6 +132,7 @@ struct thdpool {
     unsigned num_creates;
     unsigned num_exits;
     unsigned num_failed_dispatches;
+    unsigned num_affinity;
 
     /* Keep a histogram of how many times we had n threads busy */
     unsigned *busy_hist;
@@ -444,6 +451,9 @@ void thdpool_print_stats(FILE *fh, struct thdpool *pool)
         logmsgf(LOGMSG_USER, fh, "  Num work items completed  : %u\n", pool->num_completed);
         logmsgf(LOGMSG_USER, fh, "  Num failed dispatches     : %u\n",
                 pool->num_failed_dispatches);
+        if (pool->affinity_fn)
+            logmsgf(LOGMSG_USER, fh, "  Num affinity dispatches   : %u\n",
+                    pool->num_affinity);
         logmsgf(LOGMSG_USER, fh, "  Desired num threads       : %u\n", pool->minnthd);
         logmsgf(LOGMSG_USER, fh, "  Maximum num threads       : %u\n", pool->maxnthd);
         logmsgf(LOGMSG_USER, fh, "  Num active threads        : %u\n", pool->nactthd);
@@ -707,6 +717,7 @@ static void *thdpool_thd(void *voidarg)
     init_fn = pool->init_fn;
     if (init_fn)
         init_fn(pool, thddata);
+    thd->thddata = thddata;
     thread_memcreate(pool->mem_sz);
     struct workitem work = {0};
 
@@ -877,6 +888,27 @@ thread_exit:
     return NULL;
 }
 
+/* Find an idle thread, among the most recently idle ones, which the pool's
+ * affinity function prefers for work with this key, and take it off the
+ * free list.  Called with the pool lock held. */
+static struct thd *get_affine_thd_ll(struct thdpool *pool, unsigned key)
+{
+    struct thd *thd;
+    int n = 0;
+    LISTC_FOR_EACH(&pool->freelist, thd, freelist_linkv)
+    {
+        if (n++ >= gbl_thdpool_affinity_scan)
+            break;
+        if (thd->thddata && pool->affinity_fn(pool, key, thd->thddata)) {
+            listc_rfl(&pool->freelist, thd);
+            if (n > 1)
+                pool->num_affinity++;
+            return thd;
+        }
+    }
+    return NULL;
+}
+
 int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
                     int queue_override, struct string_ref *ref_persistent_info,
                     uint32_t flags)
@@ -892,6 +924,12 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
 
     time_t crt_dump;
 
+    /* Work out what the affinity function matches on before taking the
+     * lock; under it, only the key is compared. */
+    unsigned affinity_key = 0;
+    if (pool->affinity_fn && work && gbl_thdpool_affinity_scan > 0)
+        affinity_key = pool->affinity_key_fn(pool, work);
+
     LOCK(&pool->mutex)
     {
         struct thd *thd;
@@ -937,7 +975,11 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
      * until the lock is released, which gives us a window to assign the
      * work item to the new thread. */
     again:
-        thd = listc_rtl(&pool->freelist);
+        thd = NULL;
+        if (affinity_key && listc_size(&pool->freelist) > 1)
+            thd = get_affine_thd_ll(pool, affinity_key);
+        if (thd == NULL)
+            thd = listc_rtl(&pool->freelist);
         if (thd) {
             assert(thd->on_freelist);
             thd->on_freelist = 0;
@@ -1297,3 +1339,11 @@ void thdpool_set_queued_callback(struct thdpool *pool, void(*callback)(void*))
 {
     pool->queued_callback = callback;
 }
+
+void thdpool_set_affinity_fn(struct thdpool *pool,
+                             thdpool_affinity_key_fn affinity_key_fn,
+                             thdpool_affinity_fn affinity_fn)
+{
+    pool->affinity_key_fn = affinity_key_fn;
+    pool->affinity_fn = affinity_fn;
+}